@@ -108,7 +108,24 @@ void DataCollector::collectData(double currentTime, double stepTimeMs)
             const auto& rings = pCentro->getRingComplexes();
             // Centrosome cell position
             float3 centroCell = pCortex->normalizedToCell(pCentro->getNormalizedPosition());
-            for (const auto& r : rings) {
+            // Rays from the centrosome towards every MT tip are coherent; trace them as one batch
+            std::vector<RayQuery> tipRays(rings.size());
+            std::vector<float> tipDistances(rings.size());
+            for (size_t i = 0; i < rings.size(); ++i) {
+                float3 dirToTip = (centroCell + rings[i]->getTipPosition()) - centroCell;
+                float distToTip = sqrtf(dirToTip.x * dirToTip.x + dirToTip.y * dirToTip.y + dirToTip.z * dirToTip.z);
+                if (distToTip > 0.0f) {
+                    dirToTip = float3(dirToTip.x / distToTip, dirToTip.y / distToTip, dirToTip.z / distToTip);
+                }
+                tipRays[i].m_vPos = centroCell;
+                tipRays[i].m_vDir = normalize(dirToTip);
+                tipDistances[i] = distToTip;
+            }
+            std::vector<RayHit> tipHits;
+            pCortex->findClosestIntersections(tipRays, tipHits);
+
+            for (size_t i = 0; i < rings.size(); ++i) {
+                const auto& r = rings[i];
                 const float length = r->getMTLengthMicroM();
                 const float3 tipCell = centroCell + r->getTipPosition();
                 // Convert tip to normalized for sampling
@@ -119,14 +136,8 @@ void DataCollector::collectData(double currentTime, double stepTimeMs)
                 double tubDimer = std::min(tubAlpha, tubBeta);
                 double air1     = m_medium.getMoleculeConcentration(Molecule(StringDict::ID::AIR_1, ChemicalType::PROTEIN, cellPtr->getSpecies()), tipNorm);
                 // Distance to cortex along the ray from centrosome to tip
-                float3 dirToTip = tipCell - centroCell;
-                float distToTip = sqrtf(dirToTip.x * dirToTip.x + dirToTip.y * dirToTip.y + dirToTip.z * dirToTip.z);
-                if (distToTip > 0.0f) {
-                    dirToTip = float3(dirToTip.x / distToTip, dirToTip.y / distToTip, dirToTip.z / distToTip);
-                }
-                Cortex::CortexRay ray(centroCell, dirToTip);
-                bool hit = pCortex->findClosestIntersection(ray);
-                float maxLen = hit ? ray.getDistance() : 0.0f;
+                const float distToTip = tipDistances[i];
+                float maxLen = tipHits[i].isHit() ? tipHits[i].m_fDist : 0.0f;
                 bool contact = (maxLen > 0.0f) && (distToTip >= maxLen - 1e-4f);
                 double distToCortex = (maxLen > 0.0f) ? std::max(0.0, static_cast<double>(maxLen - distToTip)) : 0.0;
                 // Recompute effective vGrow and probabilities to log (mirror Y_TuRC constants)
@@ -8,6 +8,7 @@
 #include "geometry/mesh/TriangleMesh.h"
 #include "geometry/BVH/BVH.h"
 #include "geometry/BVH/ITraceableObject.h"
+#include "geometry/vectors/vectorBatch.h"
 #include <algorithm>
 #include <cmath>
 #include <random>
@@ -24,7 +25,7 @@ Cortex::Cortex(std::weak_ptr<Cell> pCell, double fThickness)
     double fVolumeMicroM = pOwnedCell->getInternalMedium().getVolumeMicroM();
     double fRadiusMicroM = std::cbrt(fVolumeMicroM * 3.0 / (4.0 * PI));
     m_pCortexMesh = TriangleMesh::createSphere(fRadiusMicroM, 2);
-    m_pCortexBVH = BVHCache::instance().getOrCreate(m_pCortexMesh);
+    reorderMeshSpatially();
 
     // Validate mapping consistency between normalizedToCell and cellToNormalized
     static std::mt19937 rng(std::random_device{}());
@@ -49,6 +50,11 @@ Cortex::Cortex(std::weak_ptr<Cell> pCell, double fThickness)
     m_bindableMolecules.emplace_back(StringDict::ID::PAR_1_CORTEX, ChemicalType::PROTEIN, species);
     m_bindableMolecules.emplace_back(StringDict::ID::PAR_2_CORTEX, ChemicalType::PROTEIN, species);
     m_bindableMolecules.emplace_back(StringDict::ID::PAR_3_CORTEX, ChemicalType::PROTEIN, species);
+
+    // PAR complexes diffuse laterally within the membrane; the binding sites themselves do not
+    m_membraneDiffusingMolecules.emplace_back(StringDict::ID::PAR_1_CORTEX, ChemicalType::PROTEIN, species);
+    m_membraneDiffusingMolecules.emplace_back(StringDict::ID::PAR_2_CORTEX, ChemicalType::PROTEIN, species);
+    m_membraneDiffusingMolecules.emplace_back(StringDict::ID::PAR_3_CORTEX, ChemicalType::PROTEIN, species);
 }
 
 void Cortex::update(double fDtSec, Cell& cell)
@@ -56,6 +62,12 @@ void Cortex::update(double fDtSec, Cell& cell)
     // Pull molecules from grid to binding sites prior to shape update
     pullBindingSiteMoleculesFromMedium();
 
+    // Lateral diffusion along the membrane while molecules sit in the binding sites
+    if (m_pCortexMesh)
+    {
+        m_surfaceDiffusion.updateDiffusion(*m_pCortexMesh, m_pBindingSites, m_membraneDiffusingMolecules, fDtSec);
+    }
+
     // Push molecules back into the grid at updated positions after shape update
     transferBindingSiteMoleculesToMedium();
 
@@ -176,13 +188,14 @@ void Cortex::transferBindingSiteMoleculesToMedium()
 
     Medium& medium = pCell->getInternalMedium();
 
+    // Update normalized [-1,1] positions on cortex from triangle + barycentric
+    updateBindingSiteNormalizedPositions();
+
     const uint32_t triangleCount = pMesh->getTriangleCount();
     for (auto& site : m_pBindingSites) {
         if (site.m_triangleIndex >= triangleCount)
             continue;
 
-        // Update normalized [-1,1] position on cortex from triangle + barycentric
-        site.setNormalized(baryToNormalized(site.m_triangleIndex, site.getBarycentric()));
         const float3 pos = site.getNormalized();
 
         // Transfer each molecule population to the medium at this position and zero source immediately
@@ -217,23 +230,17 @@ void Cortex::pullBindingSiteMoleculesFromMedium()
 
 
 
-float3 Cortex::normalizedToCell(const float3& normalizedPos)
+bool Cortex::normalizedToRay(const float3& normalizedPos, const box3& bbox, float3& outDir, float& outFraction) const
 {
-    assert(m_pCortexBVH && "Cortex BVH must be initialized before normalizedToCell");
-
-    // Get bounding box center (for ray origin)
-    const box3 bbox = m_pCortexBVH->getBox();
-    const float3 center = bbox.center();
-
     // Early-out for near-origin input
     float nLen = length(normalizedPos);
     if (nLen < 1e-6f)
-        return center;
+        return false;
 
     // Decompose normalized input into (unit direction, scalar s in [0,1])
     // s encodes the fraction to the cortex along the ray; use L-infinity norm to remain inside cube
     float s = std::max(std::max(std::abs(normalizedPos.x), std::abs(normalizedPos.y)), std::abs(normalizedPos.z));
-    s = std::min(1.0f, std::max(0.0f, s));
+    outFraction = std::min(1.0f, std::max(0.0f, s));
     float3 dirInf = normalizedPos / nLen; // unit direction in normalized space (L2)
 
     // Convert normalized-space direction to world-space ray direction by applying half-extents, then renormalizing
@@ -241,8 +248,23 @@ float3 Cortex::normalizedToCell(const float3& normalizedPos)
     float3 dirWorldPre = float3(dirInf.x * half.x, dirInf.y * half.y, dirInf.z * half.z);
     float preLen = length(dirWorldPre);
     if (preLen < 1e-6f)
+        return false;
+    outDir = dirWorldPre / preLen;
+    return true;
+}
+
+float3 Cortex::normalizedToCell(const float3& normalizedPos)
+{
+    assert(m_pCortexBVH && "Cortex BVH must be initialized before normalizedToCell");
+
+    // Get bounding box center (for ray origin)
+    const box3 bbox = m_pCortexBVH->getBox();
+    const float3 center = bbox.center();
+
+    float3 dirWorldUnit;
+    float s;
+    if (!normalizedToRay(normalizedPos, bbox, dirWorldUnit, s))
         return center;
-    float3 dirWorldUnit = dirWorldPre / preLen;
 
     // Distance to cortex along this direction
     CortexRay ray(center, dirWorldUnit);
@@ -254,6 +276,43 @@ float3 Cortex::normalizedToCell(const float3& normalizedPos)
     return center + dirWorldUnit * (distCortex * s);
 }
 
+void Cortex::normalizedToCell(const std::vector<float3>& normalizedPositions, std::vector<float3>& cellPositions)
+{
+    normalizedToCell(normalizedPositions, cellPositions, getLevelCount() - 1);
+}
+
+void Cortex::normalizedToCell(const std::vector<float3>& normalizedPositions, std::vector<float3>& cellPositions, uint32_t uLevel)
+{
+    assert(m_pCortexBVH && "Cortex BVH must be initialized before normalizedToCell");
+
+    const box3 bbox = m_pCortexBVH->getBox();
+    const float3 center = bbox.center();
+
+    // Degenerate inputs get an empty range so they never hit and map to the center below
+    std::vector<RayQuery> rays(normalizedPositions.size());
+    std::vector<float> fractions(normalizedPositions.size(), 0.0f);
+    for (size_t i = 0; i < normalizedPositions.size(); ++i)
+    {
+        RayQuery& ray = rays[i];
+        ray.m_vPos = center;
+        ray.m_vDir = float3(1, 0, 0);
+        if (normalizedToRay(normalizedPositions[i], bbox, ray.m_vDir, fractions[i]))
+            ray.m_vDir = normalize(ray.m_vDir);  // as in CortexRay
+        else
+            ray.m_fMax = -1.0f;
+    }
+
+    std::vector<RayHit> hits;
+    getLevelBVH(uLevel)->getBVH().traceBatch(rays, hits);
+
+    cellPositions.resize(normalizedPositions.size());
+    for (size_t i = 0; i < normalizedPositions.size(); ++i)
+    {
+        const float distCortex = hits[i].isHit() ? hits[i].m_fDist : 0.0f;
+        cellPositions[i] = (distCortex > 0.0f) ? center + rays[i].m_vDir * (distCortex * fractions[i]) : center;
+    }
+}
+
 
 float3 Cortex::cellToNormalized(const float3& cellPos, bool isOnCortex) const
 {
@@ -277,7 +336,11 @@ float3 Cortex::cellToNormalized(const float3& cellPos, bool isOnCortex) const
 
     // Fraction along the ray to the cortex (clamped)
     float s = std::min(1.0f, std::max(0.0f, len / distCortex));
+    return rayToNormalized(dirWorldUnit, s, bbox);
+}
 
+float3 Cortex::rayToNormalized(const float3& dirWorldUnit, float s, const box3& bbox) const
+{
     // Undo anisotropic scaling to recover normalized-space direction, then L-infinity normalize
     const float3 half = (bbox.m_maxs - bbox.m_mins) * 0.5f;
     const float eps = 1e-8f;
@@ -313,6 +376,63 @@ float3 Cortex::baryToNormalized(uint32_t triangleIndex, const float3& barycentri
     return cellToNormalized(cellPos, isOnCortex);
 }
 
+void Cortex::updateBindingSiteNormalizedPositions()
+{
+    // Same mapping as baryToNormalized() for every site, with the offsets from the cortex center
+    // gathered in SoA form so their lengths are computed four at a time
+    const box3 bbox = m_pCortexBVH->getBox();
+    const float3 center = bbox.center();
+    const Vertices& vertices = *m_pCortexMesh->getVertices();
+    const uint32_t triangleCount = m_pCortexMesh->getTriangleCount();
+    const size_t nSites = m_pBindingSites.size();
+
+    if (m_siteOffsetX.size() < nSites)
+    {
+        m_siteOffsetX.resize(nSites);
+        m_siteOffsetY.resize(nSites);
+        m_siteOffsetZ.resize(nSites);
+        m_siteOffsetLength.resize(nSites);
+    }
+    float* offsetX = m_siteOffsetX.data();
+    float* offsetY = m_siteOffsetY.data();
+    float* offsetZ = m_siteOffsetZ.data();
+    float* offsetLength = m_siteOffsetLength.data();
+    for (size_t i = 0; i < nSites; ++i)
+    {
+        const CortexMolecules& site = m_pBindingSites[i];
+        if (site.m_triangleIndex >= triangleCount)
+        {
+            offsetX[i] = offsetY[i] = offsetZ[i] = 0.0f;
+            continue;
+        }
+        const uint3 tri = m_pCortexMesh->getTriangleVertices(site.m_triangleIndex);
+        const float3& barycentric = site.getBarycentric();
+        const float3 cellPos = vertices.getVertexPosition(tri.x) * barycentric.x + vertices.getVertexPosition(tri.y) * barycentric.y
+                             + vertices.getVertexPosition(tri.z) * barycentric.z;
+        const float3 v = cellPos - center;
+        offsetX[i] = v.x;
+        offsetY[i] = v.y;
+        offsetZ[i] = v.z;
+    }
+    batchLength(offsetX, offsetY, offsetZ, offsetLength, nSites);
+
+    for (size_t i = 0; i < nSites; ++i)
+    {
+        CortexMolecules& site = m_pBindingSites[i];
+        if (site.m_triangleIndex >= triangleCount)
+            continue;
+        // On the cortex the distance to the surface is the offset length itself
+        const float len = offsetLength[i];
+        if (len < 1e-6f)
+        {
+            site.setNormalized(float3(0, 0, 0));
+            continue;
+        }
+        const float3 dirWorldUnit = float3(offsetX[i], offsetY[i], offsetZ[i]) / len;
+        site.setNormalized(rayToNormalized(dirWorldUnit, 1.0f, bbox));
+    }
+}
+
 bool Cortex::findClosestIntersection(CortexRay& ray) const
 {
     assert(m_pCortexBVH && "Cortex BVH must be initialized before findClosestIntersection");
@@ -323,6 +443,55 @@ bool Cortex::findClosestIntersection(CortexRay& ray) const
     return ray.hasHit;
 }
 
+void Cortex::findClosestIntersections(const std::vector<RayQuery>& rays, std::vector<RayHit>& hits) const
+{
+    assert(m_pCortexBVH && "Cortex BVH must be initialized before findClosestIntersections");
+    m_pCortexBVH->getBVH().traceBatch(rays, hits);
+}
+
+float Cortex::computeSignedDistance(const float3& cellPos) const
+{
+    assert(m_pCortexBVH && "Cortex BVH must be initialized before computeSignedDistance");
+    return m_pCortexBVH->computeSignedDistance(cellPos);
+}
+
+float Cortex::computeSignedDistance(const float3& cellPos, uint32_t uLevel) const
+{
+    return getLevelBVH(uLevel)->computeSignedDistance(cellPos);
+}
+
+uint32_t Cortex::getLevelCount() const
+{
+    return m_pCortexMesh ? m_pCortexMesh->getLevelCount() : 1;
+}
+
+uint32_t Cortex::selectLevel(float fMaxError) const
+{
+    const uint32_t finestLevel = getLevelCount() - 1;
+    for (uint32_t uLevel = 0; uLevel < finestLevel; ++uLevel)
+    {
+        if (m_pCortexMesh->getLevelError(uLevel) <= fMaxError)
+            return uLevel;
+    }
+    return finestLevel;
+}
+
+std::shared_ptr<BVHMesh> Cortex::getLevelBVH(uint32_t uLevel) const
+{
+    assert(m_pCortexBVH && "Cortex BVH must be initialized before getLevelBVH");
+    if (uLevel + 1 >= getLevelCount())
+        return m_pCortexBVH;
+    // Coarse levels are restricted from the current cortex shape; the cache refits their BVH when it moved
+    return BVHCache::instance().getOrCreate(m_pCortexMesh->getLevel(uLevel));
+}
+
+const SignedDistanceField& Cortex::getSignedDistanceField() const
+{
+    assert(m_pCortexBVH && "Cortex BVH must be initialized before getSignedDistanceField");
+    m_signedDistanceField.update(*m_pCortexBVH);
+    return m_signedDistanceField;
+}
+
 // Cortex::CortexRay definitions
 Cortex::CortexRay::CortexRay(const float3& origin, const float3& direction)
 {
@@ -339,6 +508,8 @@ void Cortex::CortexRay::notifyIntersection(float fDist, const ITraceableObject*,
         triangleIndex = uSubObj;
         hasHit = true;
         worldHitPoint = m_vPos + m_vDir * fDist;
+        // Only the closest hit matters: shrink the active range so farther nodes are culled
+        m_fMax = fDist;
     }
 }
 
@@ -354,3 +525,30 @@ std::shared_ptr<TriangleMesh> Cortex::getTriangleMesh() const
     return m_pCortexMesh;
 }
 
+TriangleMesh::Reordering Cortex::reorderMeshSpatially()
+{
+    TriangleMesh::Reordering reordering = m_pCortexMesh->reorderSpatially();
+    for (CortexMolecules& site : m_pBindingSites)
+    {
+        site.remapTriangle(reordering.m_newTriangleIndex);
+    }
+    m_pCortexBVH = BVHCache::instance().getOrCreate(m_pCortexMesh);
+    return reordering;
+}
+
+MeshRemesher::Changes Cortex::remesh(const MeshRemesher& remesher)
+{
+    MeshRemesher::Changes changes = remesher.remesh(*m_pCortexMesh);
+    if (changes.isEmpty())
+        return changes;
+
+    for (CortexMolecules& site : m_pBindingSites)
+    {
+        changes.relocate(site, *m_pCortexMesh);
+    }
+    // The topology changed, so the cache rebuilds the BVH instead of refitting it
+    m_pCortexBVH = BVHCache::instance().getOrCreate(m_pCortexMesh);
+    updateBindingSiteNormalizedPositions();
+    return changes;
+}
+
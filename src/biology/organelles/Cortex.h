@@ -8,6 +8,10 @@
 #include "Medium.h"
 #include "CortexMolecules.h"
 #include "Organelle.h"
+#include "SurfaceDiffusion.h"
+#include "geometry/geomHelpers/SignedDistanceField.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include "geometry/mesh/MeshRemesher.h"
 #include "geometry/vectors/vector.h"
 #include "geometry/BVH/ITraceableObject.h"
 
@@ -27,6 +31,12 @@ private:
     std::shared_ptr<class TriangleMesh> m_pCortexMesh;
     std::vector<CortexMolecules> m_pBindingSites;
     std::vector<Molecule> m_bindableMolecules;
+    std::vector<Molecule> m_membraneDiffusingMolecules; // subset of bindable molecules that move laterally
+    SurfaceDiffusion m_surfaceDiffusion;
+    mutable SignedDistanceField m_signedDistanceField; // brought up to date on access
+    // Scratch of updateBindingSiteNormalizedPositions(): offsets of the sites from the cortex center
+    // and their lengths, grown with the site count and reused between calls
+    std::vector<float> m_siteOffsetX, m_siteOffsetY, m_siteOffsetZ, m_siteOffsetLength;
 
 public:
     /**
@@ -53,6 +63,15 @@ public:
     // Access underlying cortex surface mesh
     std::shared_ptr<class TriangleMesh> getTriangleMesh() const;
 
+    // Sort the cortex mesh along a space-filling curve for memory locality and remap binding sites.
+    // Done by the constructor, before a PhysicsMesh is attached; returns the permutation so owners
+    // of other per-vertex data can follow it.
+    TriangleMesh::Reordering reorderMeshSpatially();
+
+    // Run one round of adaptive remeshing on the cortex mesh and move binding sites onto the new
+    // triangles. Returns the change list so owners of other mesh data (e.g. PhysicsMesh) can follow it.
+    MeshRemesher::Changes remesh(const MeshRemesher& remesher);
+
     /**
      * Initialize binding sites in the cell's internal medium.
      * This creates binding sites throughout the medium
@@ -72,9 +91,30 @@ public:
     // Map normalized coordinates [-1,1] to cell coordinates (µm, cortex-centered) via ray cast
     float3 normalizedToCell(const float3& normalizedPos);
 
+    // Batched normalizedToCell: all rays start at the cortex center and are traced as packets.
+    // Neighbouring inputs should be spatially close to keep packets coherent.
+    void normalizedToCell(const std::vector<float3>& normalizedPositions, std::vector<float3>& cellPositions);
+
     // Map cell coordinates (µm, cortex-centered) to normalized coordinates [-1,1]
     float3 cellToNormalized(const float3& cellPos, bool isOnCortex = false) const;
 
+    // Multiresolution cortex (see MeshHierarchy): level 0 is the coarsest surface and
+    // getLevelCount() - 1 the full-resolution one that physics and binding sites use. Consumers that
+    // tolerate a surface error pick a coarser level for cheaper queries.
+    uint32_t getLevelCount() const;
+    // Coarsest level whose surface stays within fMaxError (µm) of the full-resolution cortex
+    uint32_t selectLevel(float fMaxError) const;
+    std::shared_ptr<class BVHMesh> getLevelBVH(uint32_t uLevel) const;
+    // Batched normalizedToCell against the surface of a level; the normalized frame stays that of
+    // the full-resolution cortex
+    void normalizedToCell(const std::vector<float3>& normalizedPositions, std::vector<float3>& cellPositions, uint32_t uLevel);
+    // Signed distance to the surface of a level; differs from computeSignedDistance() by at most
+    // the level's approximation error
+    float computeSignedDistance(const float3& cellPos, uint32_t uLevel) const;
+
+    // Lateral membrane diffusion of bound molecules (e.g. to switch between explicit/implicit stepping)
+    SurfaceDiffusion& getSurfaceDiffusion() { return m_surfaceDiffusion; }
+
     // Expose BVH mesh for visualization
     std::shared_ptr<class BVHMesh> getBVHMesh() const { return m_pCortexBVH; }
 
@@ -98,9 +138,28 @@ public:
     // Find closest intersection with cortex surface along a ray
     bool findClosestIntersection(CortexRay& ray) const;
 
+    // Find closest intersections of many rays at once; hits[i] belongs to rays[i]
+    void findClosestIntersections(const std::vector<RayQuery>& rays, std::vector<RayHit>& hits) const;
+
+    // Signed distance (µm) from a cell position to the cortex surface, negative inside the cell
+    float computeSignedDistance(const float3& cellPos) const;
+
+    // Cached narrow-band signed distance field of the cortex (cell coordinates, µm) for cheap
+    // approximate queries; rebuilt only when the cortex has deformed beyond its tolerance
+    const SignedDistanceField& getSignedDistanceField() const;
+
 private:
+    // Ray direction (world, unit) and fraction of the cortex distance for a normalized position.
+    // Returns false for degenerate inputs that map to the cortex center.
+    bool normalizedToRay(const float3& normalizedPos, const box3& bbox, float3& outDir, float& outFraction) const;
+
+    // Normalized coordinates of the point at fraction s of the cortex distance along a unit world direction
+    float3 rayToNormalized(const float3& dirWorldUnit, float s, const box3& bbox) const;
+
     // Convert triangle index and barycentric coordinates to normalized [-1,1] coordinates
     float3 baryToNormalized(uint32_t triangleIndex, const float3& barycentric) const;
+    // baryToNormalized() for all binding sites, stored in the sites
+    void updateBindingSiteNormalizedPositions();
 
     // Pull molecules from grid cells at binding-site positions into binding sites
     void pullBindingSiteMoleculesFromMedium();
@@ -2,6 +2,7 @@
 #include "GridDiffusion.h"
 #include "Grid.h"
 #include <cassert>
+#include <algorithm>
 
 GridDiffusion::GridDiffusion()
 {
@@ -12,7 +13,8 @@ double GridDiffusion::computeDiffusionAmount(double moleculeCount, size_t numNei
     return moleculeCount * DIFFUSION_RATE * dt / numNeighbors;
 }
 
-void GridDiffusion::updateDiffusion(Grid& grid, double dt)
+void GridDiffusion::updateDiffusion(Grid& grid, double dt, const std::vector<uint8_t>* pSleeping,
+                                    std::vector<double>* pCellChanges)
 {
     // Structure to hold molecule identity and population reference for diffusion
     struct DiffusionEntry {
@@ -26,11 +28,25 @@ void GridDiffusion::updateDiffusion(Grid& grid, double dt)
     std::vector<DiffusionEntry> sourcePops;
     nSourcePopsPerCell.resize(grid.size(), 0);
     
+    // A sleeping cell whose neighbours all sleep has no populations to diffuse
+    if (pSleeping)
+    {
+        m_frozen.resize(grid.size());
+        for (uint32_t uCell = 0; uCell < grid.size(); ++uCell)
+        {
+            m_frozen[uCell] = (*pSleeping)[uCell];
+            for (uint32_t uNeighbor : grid.getNeighborIndices(uCell))
+                m_frozen[uCell] = m_frozen[uCell] && (*pSleeping)[uNeighbor];
+        }
+    }
+
     for (uint32_t uPass = 0; uPass < 2; ++uPass)
     {
         uint32_t nTotalSourcePops = 0;
         for (uint32_t uSourceCell = 0; uSourceCell < grid.size(); ++uSourceCell)
         {
+            if (pSleeping && m_frozen[uSourceCell])
+                continue;
             auto& cellMolecules = grid[uSourceCell].m_molecules;
             for (auto itMolecule = cellMolecules.begin(); itMolecule != cellMolecules.end(); )
             {
@@ -67,6 +83,14 @@ void GridDiffusion::updateDiffusion(Grid& grid, double dt)
         }
     }
 
+    if (pCellChanges)
+    {
+        m_startNumbers.resize(sourcePops.size());
+        for (size_t uPop = 0; uPop < sourcePops.size(); ++uPop)
+            m_startNumbers[uPop] = sourcePops[uPop].population->m_fNumber;
+        m_createdPops.clear();
+    }
+
     // Execute three passes: first pass allocates memory for diffusion amounts, second
     // pass calculation diffusion amount per destination population, and the third pass
     // deposits the diffused amount
@@ -108,7 +132,12 @@ void GridDiffusion::updateDiffusion(Grid& grid, double dt)
                         // Apply diffusion to each neighbor
                         for (uint32_t uN = 0; uN < vecNeighbors.size(); ++uN)
                         {
+                            if (pSleeping && (*pSleeping)[uSourceCell] && (*pSleeping)[vecNeighbors[uN]])
+                                continue;
                             auto& destPop = grid[vecNeighbors[uN]].getOrCreateMolPop(*sourceEntry.molecule);
+                            // Empty populations were dropped above, so an empty one is new
+                            if (pCellChanges && destPop.m_fNumber == 0)
+                                m_createdPops.emplace_back(vecNeighbors[uN], &destPop);
                             sourceEntry.population->m_fNumber -= diffusionAmounts[uDiffusionIndex + uN];
                             destPop.m_fNumber += diffusionAmounts[uDiffusionIndex + uN];
                         }
@@ -125,4 +154,17 @@ void GridDiffusion::updateDiffusion(Grid& grid, double dt)
             diffusionAmounts.resize(uDiffusionIndex);
         }
     }
+
+    if (pCellChanges)
+    {
+        uint32_t uPopIndex = 0;
+        for (uint32_t uCell = 0; uCell < grid.size(); ++uCell)
+        {
+            double& fChange = (*pCellChanges)[uCell];
+            for (uint32_t uCellPop = 0; uCellPop < nSourcePopsPerCell[uCell]; ++uCellPop, ++uPopIndex)
+                fChange = std::max(fChange, GridCell::relativeChange(m_startNumbers[uPopIndex], sourcePops[uPopIndex].population->m_fNumber));
+        }
+        for (const auto& [uCell, pPopulation] : m_createdPops)
+            (*pCellChanges)[uCell] = std::max((*pCellChanges)[uCell], GridCell::relativeChange(0.0, pPopulation->m_fNumber));
+    }
 } 
\ No newline at end of file
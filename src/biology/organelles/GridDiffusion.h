@@ -9,12 +9,24 @@ class GridDiffusion
 public:
     GridDiffusion();
 
-    // Update diffusion for a specific molecule type
-    void updateDiffusion(Grid& grid, double dt);
+    // Update diffusion for a specific molecule type. Nothing diffuses between two cells that are
+    // both marked in pSleeping (if given, one entry per cell). If pCellChanges is given, every entry
+    // is raised to the largest GridCell::relativeChange() of a population of its cell.
+    void updateDiffusion(Grid& grid, double dt, const std::vector<uint8_t>* pSleeping = nullptr,
+                         std::vector<double>* pCellChanges = nullptr);
+
+    // Fraction of every free population that leaves its cell in one update of length dt
+    static double getOutflowFraction(double dt) { return DIFFUSION_RATE * dt; }
 
 private:
     static constexpr double DIFFUSION_RATE = 0.1; // Rate of movement between cells
 
     // Helper function to compute diffusion amount
     double computeDiffusionAmount(double moleculeCount, size_t numNeighbors, double dt) const;
+
+    // Per cell: sleeps with all its neighbours (kept between updates)
+    std::vector<uint8_t> m_frozen;
+    // Per source population: its number before the update; populations the update created
+    std::vector<double> m_startNumbers;
+    std::vector<std::pair<uint32_t, const Population*>> m_createdPops;
 }; 
\ No newline at end of file
@@ -10,13 +10,16 @@
 #include "chemistry/molecules/GridCell.h"
 // Use forward-declared Cortex; include header only where needed
 #include "Cortex.h"
+#include "geometry/geomHelpers/BVHMesh.h"
 
 // Global random number generator for consistent randomness
 static std::mt19937 g_rng(std::random_device{}());
 
 void Medium::addMolecule(const MPopulation& population, const float3& position)
 {
-    GridCell& gridCell = m_grid.findCell(position);
+    const uint32_t uCell = m_grid.positionToIndex(position);
+    wakeCell(uCell);
+    GridCell& gridCell = m_grid[uCell];
     Population& moleculePop = gridCell.getOrCreateMolPop(population.m_molecule);
 
     // it's the same molecule - so they're either both bound, or both unbound
@@ -51,9 +54,11 @@ void Medium::updateGridCellVolumes(Cortex& cortex)
         edges[i] = -1.0 + 2.0 * (static_cast<double>(i) / static_cast<double>(res));
     }
 
-    // Precompute world positions for each vertex (ix,iy,iz) with ix,iy,iz in [0..res]
+    // Precompute world positions for each vertex (ix,iy,iz) with ix,iy,iz in [0..res].
+    // Neighbouring grid vertices give nearly parallel rays, so they are mapped in one batched query.
     const uint32_t vertCount = vres * vres * vres;
-    std::vector<float3> worldVerts(vertCount);
+    std::vector<float3> normalizedVerts(vertCount);
+    std::vector<float3> worldVerts;
     auto vindex = [&](uint32_t ix, uint32_t iy, uint32_t iz) {
         return ix * vres * vres + iy * vres + iz;
     };
@@ -61,9 +66,15 @@ void Medium::updateGridCellVolumes(Cortex& cortex)
     for (uint32_t iy = 0; iy < vres; ++iy)
     for (uint32_t iz = 0; iz < vres; ++iz)
     {
-        float3 npos((float)edges[ix], (float)edges[iy], (float)edges[iz]);
-        worldVerts[vindex(ix,iy,iz)] = cortex.normalizedToCell(npos);
+        normalizedVerts[vindex(ix,iy,iz)] = float3((float)edges[ix], (float)edges[iy], (float)edges[iz]);
     }
+    // A surface offset changes the volume of a boundary cell by about offset / cell width, so a
+    // coarser cortex level is traced whenever its approximation error is small against a cell
+    const box3 cortexBox = cortex.getBVHMesh()->getBox();
+    const float3 cortexSize = cortexBox.diagonal();
+    const float fCellWidth = std::max(cortexSize.x, std::max(cortexSize.y, cortexSize.z)) / static_cast<float>(res);
+    const uint32_t uCortexLevel = cortex.selectLevel(static_cast<float>(CORTEX_LEVEL_ERROR_CELLS) * fCellWidth);
+    cortex.normalizedToCell(normalizedVerts, worldVerts, uCortexLevel);
 
     // Helper to compute volume of a tetrahedron
     auto tetVolume = [](const float3& a, const float3& b, const float3& c, const float3& d) {
@@ -102,7 +113,10 @@ void Medium::updateGridCellVolumes(Cortex& cortex)
             (x0 + x1) * 0.5f,
             (y0 + y1) * 0.5f,
             (z0 + z1) * 0.5f);
-        GridCell& gc = m_grid.findCell(centerNorm);
+        const uint32_t uCell = m_grid.positionToIndex(centerNorm);
+        GridCell& gc = m_grid[uCell];
+        if (std::abs(vol - gc.getVolumeMicroM3()) > m_fQuiescenceTolerance * gc.getVolumeMicroM3())
+            wakeCell(uCell);
         gc.setVolumeMicroM3(vol);
 
         totalGridVolume += vol;
@@ -164,6 +178,7 @@ void Medium::toBindingSites(std::vector<CortexMolecules>& bindingSites, const st
             // Remove from grid cell after distribution
             cellPop.m_fNumber = 0.0;
             gridCell.m_molecules.erase(it);
+            wakeCell(cellIndex);
         }
     }
 }
@@ -184,6 +199,9 @@ void Medium::updateMoleculeInteraction(double fDt)
     // First, apply direct protein interactions
     for (size_t uCell = 0; uCell < m_grid.size(); ++uCell)
     {
+        if (isCellSleeping(static_cast<uint32_t>(uCell)))
+            continue;
+
         // at first make a dry run to figure out who needs which resources
         m_resDistributor.notifyNewDryRun(m_grid[uCell]);
         for (size_t i = 0; i < vecInteractions.size(); ++i)
@@ -204,6 +222,9 @@ void Medium::updateMoleculeInteraction(double fDt)
         // Ensure ATP doesn't go below zero
         auto& atpPop = m_grid[uCell].getOrCreateMolPop(Molecule(StringDict::ID::ATP, ChemicalType::NUCLEOTIDE));
         atpPop.m_fNumber = std::max(0.0, atpPop.m_fNumber);
+
+        if (!m_sleeping.empty())
+            m_stepChanges[uCell] = std::max(m_stepChanges[uCell], m_resDistributor.getMaxRelativeChange(m_grid[uCell]));
     }
 }
 
@@ -211,34 +232,150 @@ void Medium::updateMoleculeInteraction(double fDt)
 
 void Medium::update(double fDt)
 {
-    m_diffusion.updateDiffusion(m_grid, fDt);
+    m_nLastRejectedSteps = 0;
+    if (m_fMaxChange <= 0)
+    {
+        m_fLastChangeFraction = updateStep(fDt);
+        m_nLastSteps = 1;
+        updateQuiescence();
+        return;
+    }
+
+    m_fLastChangeFraction = 0;
+    m_nLastSteps = 0;
+    double fRemaining = fDt;
+    while (fRemaining > 1e-12 * fDt)
+    {
+        const double fStepDt = m_stepController.proposeDt(fRemaining);
+        saveGrid();
+        const double fChange = updateStep(fStepDt);
+        // The change grows linearly with the step size
+        if (!m_stepController.update(fStepDt, fChange / m_fMaxChange, 0))
+        {
+            restoreGrid();
+            ++m_nLastRejectedSteps;
+            continue;
+        }
+        m_fLastChangeFraction = std::max(m_fLastChangeFraction, fChange);
+        ++m_nLastSteps;
+        updateQuiescence();
+        fRemaining -= fStepDt;
+    }
+}
+
+void Medium::saveGrid()
+{
+    m_savedPopulations.clear();
+    m_savedCellEnds.resize(m_grid.size());
+    for (size_t uCell = 0; uCell < m_grid.size(); ++uCell)
+    {
+        m_savedPopulations.insert(m_savedPopulations.end(), m_grid[uCell].m_molecules.begin(), m_grid[uCell].m_molecules.end());
+        m_savedCellEnds[uCell] = static_cast<uint32_t>(m_savedPopulations.size());
+    }
+}
+
+void Medium::restoreGrid()
+{
+    uint32_t uBegin = 0;
+    for (size_t uCell = 0; uCell < m_grid.size(); ++uCell)
+    {
+        auto& molecules = m_grid[uCell].m_molecules;
+        molecules.clear();
+        molecules.insert(m_savedPopulations.begin() + uBegin, m_savedPopulations.begin() + m_savedCellEnds[uCell]);
+        uBegin = m_savedCellEnds[uCell];
+    }
+}
+
+void Medium::setErrorControl(double fMaxChange, const StepSizeController::Settings& settings)
+{
+    m_fMaxChange = fMaxChange;
+    m_stepController.setSettings(settings);
+}
+
+void Medium::setQuiescence(double fTolerance, uint32_t nQuietSteps)
+{
+    m_fQuiescenceTolerance = fTolerance;
+    m_nQuiescenceSteps = std::max(1u, nQuietSteps);
+    m_sleeping.clear();
+    if (fTolerance <= 0)
+        return;
+    m_sleeping.assign(m_grid.size(), 0);
+    m_quietSteps.assign(m_grid.size(), 0);
+    m_stepChanges.assign(m_grid.size(), 0.0);
+}
+
+uint32_t Medium::getSleepingCellCount() const
+{
+    return static_cast<uint32_t>(std::count(m_sleeping.begin(), m_sleeping.end(), uint8_t(1)));
+}
+
+void Medium::wakeCell(uint32_t uCell)
+{
+    if (m_sleeping.empty())
+        return;
+    m_sleeping[uCell] = 0;
+    m_quietSteps[uCell] = 0;
+}
+
+void Medium::updateQuiescence()
+{
+    if (m_sleeping.empty())
+        return;
+    for (uint32_t uCell = 0; uCell < m_grid.size(); ++uCell)
+    {
+        if (m_stepChanges[uCell] > m_fQuiescenceTolerance)
+        {
+            wakeCell(uCell);
+            continue;
+        }
+        if (!m_sleeping[uCell] && ++m_quietSteps[uCell] >= m_nQuiescenceSteps)
+            m_sleeping[uCell] = 1;
+    }
+}
+
+double Medium::updateStep(double fDt)
+{
+    m_resDistributor.resetMaxDemandRatio();
+    const bool bQuiescence = !m_sleeping.empty();
+    if (bQuiescence)
+        std::fill(m_stepChanges.begin(), m_stepChanges.end(), 0.0);
+    m_diffusion.updateDiffusion(m_grid, fDt, bQuiescence ? &m_sleeping : nullptr, bQuiescence ? &m_stepChanges : nullptr);
     
     // Update tRNA charging in all grid cells
     for (size_t i = 0; i < m_grid.size(); ++i) {
-        m_grid[i].updateTRNAs(fDt);
+        if (isCellSleeping(static_cast<uint32_t>(i)))
+            continue;
+        const double fChange = m_grid[i].updateTRNAs(fDt);
+        if (bQuiescence)
+            m_stepChanges[i] = std::max(m_stepChanges[i], fChange);
     }
     
     // Interaction of proteins between each other
     updateMoleculeInteraction(fDt);
     
     // Translation is now handled by MoleculeInteraction system
+    return std::max(GridDiffusion::getOutflowFraction(fDt), m_resDistributor.getMaxDemandRatio());
 }
 
 
 void Medium::addATP(double fAmount, const float3& position)
 {
-    auto& gridCell = m_grid.findCell(position);
+    const uint32_t uCell = m_grid.positionToIndex(position);
+    wakeCell(uCell);
+    auto& gridCell = m_grid[uCell];
     auto& atpPop = gridCell.getOrCreateMolPop(Molecule(StringDict::ID::ATP, ChemicalType::NUCLEOTIDE));
     atpPop.m_fNumber = std::min<double>(atpPop.m_fNumber + fAmount, MAX_ATP_PER_CELL);
 }
 
 bool Medium::consumeATP(double fAmount, const float3& position)
 {
-    auto& gridCell = m_grid.findCell(position);
+    const uint32_t uCell = m_grid.positionToIndex(position);
+    auto& gridCell = m_grid[uCell];
     auto& atpPop = gridCell.getOrCreateMolPop(Molecule(StringDict::ID::ATP, ChemicalType::NUCLEOTIDE));
     if (atpPop.m_fNumber >= fAmount)
     {
         atpPop.m_fNumber -= fAmount;
+        wakeCell(uCell);
         return true;
     }
     return false;
@@ -14,6 +14,7 @@
 #include "Grid.h"
 #include "GridDiffusion.h"
 #include "chemistry/interactions/ResourceDistributor.h"
+#include "physics/StepSizeController.h"
 
 // Forward declaration to avoid circular include
 class Cortex;
@@ -28,6 +29,7 @@ private:
     static constexpr double ATP_DIFFUSION_RATE = 0.2;      // Rate of ATP diffusion between cells
     static constexpr int DIFFUSION_SAMPLES = 1000;         // Number of random samples per diffusion update
     static constexpr double DIFFUSION_SIGMA = 0.2;         // Standard deviation for diffusion distance (as fraction of medium size)
+    static constexpr double CORTEX_LEVEL_ERROR_CELLS = 0.05; // Cortex surface error accepted for grid volumes (fraction of a cell width)
 
 public:
     static constexpr double MAX_ATP_PER_CELL = 1e10;      // Maximum ATP per grid cell
@@ -60,10 +62,60 @@ public:
     // Main update function
     void update(double dt);
 
+    // Chemistry error control (fMaxChange > 0; 0 disables it): update(dt) covers dt with steps in
+    // which no population changes by more than the fraction fMaxChange. The change of a step is the
+    // larger of the diffusion outflow and the demand of the interactions on their scarcest input; a
+    // step that exceeds the limit is undone and retried smaller.
+    void setErrorControl(double fMaxChange, const StepSizeController::Settings& settings);
+    // Step size the chemistry would take next (0 without error control or before the first step)
+    double getSuggestedDt() const { return m_stepController.getDt(); }
+    // Largest change fraction of an accepted step of the last update(), and the steps it took
+    double getLastChangeFraction() const { return m_fLastChangeFraction; }
+    uint32_t getLastStepCount() const { return m_nLastSteps; }
+    uint32_t getLastRejectedStepCount() const { return m_nLastRejectedSteps; }
+
+    // Quiescence (fTolerance > 0; 0 disables it): a grid cell in which no population changed by more
+    // than the fraction fTolerance in each of nQuietSteps steps in a row falls asleep. Sleeping cells
+    // skip tRNA charging and interactions, and no diffusion is computed between two of them. A
+    // sleeping cell wakes when molecules are added to or taken from it, when its volume changes by
+    // more than fTolerance, or when diffusion from an awake neighbour changes it by more than that.
+    void setQuiescence(double fTolerance, uint32_t nQuietSteps);
+    uint32_t getSleepingCellCount() const;
+
 private:
     ResourceDistributor m_resDistributor;
 
+    // Error control
+    double m_fMaxChange = 0.0;
+    StepSizeController m_stepController;
+    // Populations of all grid cells before the current step, cell after cell (m_savedCellEnds[i] is
+    // where cell i ends). A flat copy neither allocates nor hashes once the buffers have grown; the
+    // cells are rebuilt from it only for the rare rejected step. Steps change nothing but populations.
+    std::vector<std::pair<Molecule, Population>> m_savedPopulations;
+    std::vector<uint32_t> m_savedCellEnds;
+    double m_fLastChangeFraction = 0.0;
+    uint32_t m_nLastSteps = 0;
+    uint32_t m_nLastRejectedSteps = 0;
+
+    // Quiescence, per grid cell. m_stepChanges: largest GridCell::relativeChange() of a population
+    // in the current step, raised by diffusion, tRNA charging and the interactions as they write.
+    double m_fQuiescenceTolerance = 0.0;
+    uint32_t m_nQuiescenceSteps = 10;
+    std::vector<uint8_t> m_sleeping;
+    std::vector<uint32_t> m_quietSteps;
+    std::vector<double> m_stepChanges;
+
+    void wakeCell(uint32_t uCell);
+    bool isCellSleeping(uint32_t uCell) const { return !m_sleeping.empty() && m_sleeping[uCell]; }
+    // After an accepted step: cells quiet for long enough fall asleep, changed ones wake
+    void updateQuiescence();
+
+    void saveGrid();
+    void restoreGrid();
+
     // Update functions
+    // One step of diffusion, tRNA charging and interactions; returns its change fraction
+    double updateStep(double dt);
     void updateMoleculeInteraction(double dt);
 };
 
@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "SurfaceDiffusion.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include "chemistry/molecules/simConstants.h"
+#include <algorithm>
+#include <cmath>
+
+SurfaceDiffusion::SurfaceDiffusion()
+{
+}
+
+void SurfaceDiffusion::updateDiffusion(const TriangleMesh& mesh, std::vector<CortexMolecules>& bindingSites,
+                                       const std::vector<Molecule>& diffusingMolecules, double dt)
+{
+    if (dt <= 0.0 || bindingSites.empty() || diffusingMolecules.empty())
+        return;
+
+    m_laplacian.updateForMesh(mesh);
+    const uint32_t nVertices = m_laplacian.getVertexCount();
+    const uint32_t nTriangles = mesh.getTriangleCount();
+    if (nVertices == 0)
+        return;
+    const std::vector<double>& areas = m_laplacian.getVertexAreas();
+
+    // Total barycentric weight of binding sites per vertex; used to split vertex amounts back into sites
+    m_siteWeight.assign(nVertices, 0.0);
+    for (const CortexMolecules& site : bindingSites)
+    {
+        if (site.m_triangleIndex >= nTriangles)
+            continue;
+        const uint3 tri = mesh.getTriangleVertices(site.m_triangleIndex);
+        const float3& bary = site.getBarycentric();
+        m_siteWeight[tri.x] += bary.x;
+        m_siteWeight[tri.y] += bary.y;
+        m_siteWeight[tri.z] += bary.z;
+    }
+
+    const double dtD = dt * MoleculeConstants::CORTEX_MEMBRANE_DIFFUSION_UM2_PER_S;
+    // Forward Euler with fewer substeps than the stability limit asks for would oscillate and go
+    // negative; a step that large (long dt or fine mesh) is taken with backward Euler instead
+    const uint32_t nExplicitSubsteps = (m_method == Method::EXPLICIT) ? computeExplicitSubsteps(dtD) : 0;
+    const bool bImplicit = (m_method == Method::IMPLICIT) || nExplicitSubsteps > MAX_EXPLICIT_SUBSTEPS;
+
+    for (const Molecule& mol : diffusingMolecules)
+    {
+        // Scatter site populations onto vertices
+        m_amount.assign(nVertices, 0.0);
+        double totalAmount = 0.0;
+        for (CortexMolecules& site : bindingSites)
+        {
+            if (site.m_triangleIndex >= nTriangles)
+                continue;
+            auto it = site.m_bsMolecules.find(mol);
+            if (it == site.m_bsMolecules.end() || it->second.m_fNumber <= 0.0)
+                continue;
+            const double a = it->second.m_fNumber;
+            const uint3 tri = mesh.getTriangleVertices(site.m_triangleIndex);
+            const float3& bary = site.getBarycentric();
+            m_amount[tri.x] += a * bary.x;
+            m_amount[tri.y] += a * bary.y;
+            m_amount[tri.z] += a * bary.z;
+            it->second.m_fNumber = 0.0;
+            totalAmount += a;
+        }
+        if (totalAmount <= 0.0)
+            continue;
+
+        m_concentration.resize(nVertices);
+        for (uint32_t i = 0; i < nVertices; ++i)
+        {
+            m_concentration[i] = (areas[i] > 0.0) ? m_amount[i] / areas[i] : 0.0;
+        }
+
+        if (bImplicit)
+            diffuseImplicit(dtD);
+        else
+            diffuseExplicit(dtD, nExplicitSubsteps);
+
+        for (uint32_t i = 0; i < nVertices; ++i)
+        {
+            if (areas[i] > 0.0)
+                m_amount[i] = std::max(0.0, m_concentration[i] * areas[i]);
+        }
+
+        // Amount that landed on vertices without any binding site cannot be gathered;
+        // rescale the gathered shares so the total number of molecules is conserved
+        double gatheredAmount = 0.0;
+        for (uint32_t i = 0; i < nVertices; ++i)
+        {
+            if (m_siteWeight[i] > 0.0)
+                gatheredAmount += m_amount[i];
+        }
+        if (gatheredAmount <= 0.0)
+            continue;
+        const double conservationScale = totalAmount / gatheredAmount;
+
+        // Gather vertex amounts back into binding sites
+        for (CortexMolecules& site : bindingSites)
+        {
+            if (site.m_triangleIndex >= nTriangles)
+                continue;
+            const uint3 tri = mesh.getTriangleVertices(site.m_triangleIndex);
+            const float3& bary = site.getBarycentric();
+            double share = 0.0;
+            if (m_siteWeight[tri.x] > 0.0) share += m_amount[tri.x] * bary.x / m_siteWeight[tri.x];
+            if (m_siteWeight[tri.y] > 0.0) share += m_amount[tri.y] * bary.y / m_siteWeight[tri.y];
+            if (m_siteWeight[tri.z] > 0.0) share += m_amount[tri.z] * bary.z / m_siteWeight[tri.z];
+            if (share <= 0.0)
+                continue;
+            Population& pop = site.m_bsMolecules[mol];
+            pop.m_fNumber += share * conservationScale;
+            pop.setBound(true); // molecules remain membrane-bound
+        }
+    }
+}
+
+uint32_t SurfaceDiffusion::computeExplicitSubsteps(double dtD) const
+{
+    const double maxStep = 0.9 * m_laplacian.computeMaxStableExplicitStep(1.0);
+    if (!(maxStep > 0.0))
+        return UINT32_MAX;
+    const double nSubsteps = std::ceil(dtD / maxStep);
+    return (nSubsteps < double(UINT32_MAX)) ? std::max(1u, static_cast<uint32_t>(nSubsteps)) : UINT32_MAX;
+}
+
+void SurfaceDiffusion::diffuseExplicit(double dtD, uint32_t nSubsteps)
+{
+    const SparseMatrix& L = m_laplacian.getStiffness();
+    const std::vector<double>& areas = m_laplacian.getVertexAreas();
+    const double h = dtD / nSubsteps;
+
+    for (uint32_t s = 0; s < nSubsteps; ++s)
+    {
+        L.multiply(m_concentration, m_work);
+        for (uint32_t i = 0; i < m_concentration.size(); ++i)
+        {
+            if (areas[i] > 0.0)
+                m_concentration[i] += h * m_work[i] / areas[i];
+        }
+    }
+}
+
+void SurfaceDiffusion::diffuseImplicit(double dtD)
+{
+    const std::vector<double>& areas = m_laplacian.getVertexAreas();
+
+    // (M - dt*D*L) c_new = M c_old; rebuild operator only when the mesh or dt*D changed
+    if (m_implicitBuildVersion != m_laplacian.getBuildVersion() || m_implicitDtD != dtD)
+    {
+        m_implicitOperator = m_laplacian.getStiffness();
+        m_implicitOperator.scale(-dtD);
+        m_implicitOperator.addToDiagonal(areas);
+        m_implicitBuildVersion = m_laplacian.getBuildVersion();
+        m_implicitDtD = dtD;
+    }
+
+    // Right-hand side is the per-vertex amount; the current field is the warm start
+    m_work.resize(areas.size());
+    for (uint32_t i = 0; i < areas.size(); ++i)
+    {
+        m_work[i] = m_concentration[i] * areas[i];
+    }
+    m_implicitOperator.solveConjugateGradient(m_work, m_concentration, MAX_CG_ITERATIONS, CG_TOLERANCE);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "CortexMolecules.h"
+#include "geometry/mesh/MeshLaplacian.h"
+#include "geometry/mesh/SparseMatrix.h"
+
+class TriangleMesh;
+
+// Lateral (2D) diffusion of membrane-bound molecules on the cortex surface mesh.
+// Binding-site populations are scattered onto mesh vertices as per-vertex concentrations,
+// diffused with the cotangent Laplacian and gathered back into the binding sites, so the
+// exchange with the 3D Medium keeps going through the binding sites.
+class SurfaceDiffusion
+{
+public:
+    enum class Method
+    {
+        EXPLICIT,   // forward Euler with automatic sub-stepping (SpMV only); steps that would need
+                    // more than MAX_EXPLICIT_SUBSTEPS substeps are taken implicitly instead
+        IMPLICIT    // backward Euler solved with preconditioned conjugate gradient
+    };
+
+    SurfaceDiffusion();
+
+    void setMethod(Method method) { m_method = method; }
+    Method getMethod() const { return m_method; }
+
+    // Diffuse the listed molecules between binding sites along the surface
+    void updateDiffusion(const TriangleMesh& mesh, std::vector<CortexMolecules>& bindingSites,
+                         const std::vector<Molecule>& diffusingMolecules, double dt);
+
+    // Per-vertex concentration (molecules/µm^2) of the last processed molecule field
+    const std::vector<double>& getVertexConcentrations() const { return m_concentration; }
+
+private:
+    static constexpr uint32_t MAX_EXPLICIT_SUBSTEPS = 1000;
+    static constexpr uint32_t MAX_CG_ITERATIONS = 200;
+    static constexpr double CG_TOLERANCE = 1e-8;
+
+    Method m_method = Method::EXPLICIT;
+    MeshLaplacian m_laplacian;
+
+    // Implicit operator (M - dt*D*L) cached for the last (laplacian build, dt*D) pair
+    SparseMatrix m_implicitOperator;
+    uint64_t m_implicitBuildVersion = UINT64_MAX;
+    double m_implicitDtD = -1.0;
+
+    // Per-vertex scratch (reused across calls)
+    std::vector<double> m_siteWeight;     // sum of barycentric weights of sites touching the vertex
+    std::vector<double> m_amount;         // molecules per vertex
+    std::vector<double> m_concentration;  // molecules per µm^2
+    std::vector<double> m_work;
+
+    // Forward Euler substeps that keep dtD within the positivity limit of the current mesh
+    uint32_t computeExplicitSubsteps(double dtD) const;
+    void diffuseExplicit(double dtD, uint32_t nSubsteps);
+    void diffuseImplicit(double dtD);
+};
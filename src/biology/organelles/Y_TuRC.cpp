@@ -105,6 +105,12 @@ void Y_TuRC::update(double dtSec, const float3& centrosomeCellPos, const std::sh
     {
         float growthThisStep = static_cast<float>(vGrow * dtSec);
         const float segmentLength = static_cast<float>(MoleculeConstants::MT_SEGMENT_LENGTH_MICROM);
+
+        // Polymerize along the tip segment, which follows the bending of the rod mechanics
+        float3 tipSegment = getTipPosition() - getVertexPosition(getVertexCount() - 2);
+        float tipSegmentLength = sqrtf(tipSegment.x * tipSegment.x + tipSegment.y * tipSegment.y + tipSegment.z * tipSegment.z);
+        if (tipSegmentLength > 1e-3f)
+            m_vTipDir = float3(tipSegment.x / tipSegmentLength, tipSegment.y / tipSegmentLength, tipSegment.z / tipSegmentLength);
         
         // Grow the last segment in the tip direction
         float3 currentTip = getTipPosition();
@@ -135,16 +141,26 @@ void Y_TuRC::update(double dtSec, const float3& centrosomeCellPos, const std::sh
         float segLen = sqrtf(segDir.x * segDir.x + segDir.y * segDir.y + segDir.z * segDir.z);
         
         m_mtContactCortex = false;
+        clearTipContact();
         if (segLen > 0.0f) {
             segDir = float3(segDir.x / segLen, segDir.y / segLen, segDir.z / segLen);
             
+            // Tips deep inside the cell cannot reach the cortex within one segment; the distance
+            // field answers that without tracing
+            const bool bFarFromCortex = pCortex->getSignedDistanceField().isInsideBy(segEnd, segLen);
             Cortex::CortexRay intersection(segStart, segDir);
-            if (pCortex->findClosestIntersection(intersection) && intersection.distance < segLen)
+            if (!bFarFromCortex && pCortex->findClosestIntersection(intersection) && intersection.distance < segLen)
             {
                 // Truncate MT at cortex contact
                 float3 contactPoint = segStart + segDir * intersection.distance - centrosomeCellPos;
                 setVertexPosition(lastIdx, contactPoint);
                 
+                // The tip now pushes against the cortex
+                MeshLocation contact;
+                contact.m_triangleIndex = intersection.triangleIndex;
+                contact.setBarycentric(pCortex->getTriangleMesh()->computeBary(intersection.triangleIndex, intersection.worldHitPoint));
+                setTipContact(contact, centrosomeCellPos);
+
                 // First contact - attempt cortical binding directly
                 m_mtContactCortex = true;
                 attemptCorticalBindingWithIntersection(intersection, pCortex, internalMedium, dtSec, rand01);
@@ -163,6 +179,8 @@ void Y_TuRC::update(double dtSec, const float3& centrosomeCellPos, const std::sh
     }
     else if (getState() == MTState::Shrinking)
     {
+        // A shrinking tip leaves the cortex
+        clearTipContact();
         float shrinkageThisStep = static_cast<float>(vShrink * dtSec);
         
         // Shrink the last segment
@@ -266,8 +284,9 @@ void Y_TuRC::update(double dtSec, const float3& centrosomeCellPos, const std::sh
 void Y_TuRC::bindToCortex(const MeshLocation& location, double dyneinConc)
 {
     setState(MTState::Bound);
-    // Store attachment location for physics force calculation
+    // Store attachment location for physics force calculation; the tip is now held there
     setAttachmentLocation(location);
+    clearTipContact();
     m_bindingStrength = dyneinConc;
     m_bindingTime = 0.0;
 }
@@ -276,6 +295,7 @@ void Y_TuRC::unbindFromCortex()
 {
     setState(MTState::Shrinking);  // Unbinding typically triggers catastrophe
     m_mtContactCortex = false;
+    clearTipContact();
     m_bindingStrength = 0.0;
     m_bindingTime = 0.0;
 }
@@ -2,6 +2,8 @@
 #include "biology/organelles/Cell.h"
 #include "biology/organelles/Cortex.h"
 #include "biology/simulation/PhysicsCore.h"
+#include "biology/organelles/Medium.h"
+#include <algorithm>
 
 CellSim::CellSim(std::shared_ptr<Cell> pCell)
     : m_pCell(pCell)
@@ -19,3 +21,34 @@ void CellSim::update(const TimeContext& time)
 
     m_pCell->update(time.m_deltaTSec);
 }
+
+void CellSim::setAdaptiveTimeStepping(const AdaptiveTimeStepping& settings)
+{
+    StepSizeController::Settings stepSettings;
+    stepSettings.m_fMinDt = settings.m_fMinDtSec;
+    stepSettings.m_fMaxDt = settings.m_fMaxDtSec;
+    m_pPhysicsCore->setErrorControl(settings.m_fPhysicsTolerance, stepSettings);
+    m_pCell->getInternalMedium().setErrorControl(settings.m_fMaxChemistryChange, stepSettings);
+}
+
+void CellSim::setQuiescence(const Quiescence& settings)
+{
+    m_pPhysicsCore->setSleeping(settings.m_fKineticEnergy, settings.m_nQuietSteps, settings.m_fWakeDistance);
+    m_pCell->getInternalMedium().setQuiescence(settings.m_fMaxChemistryChange, settings.m_nQuietSteps);
+}
+
+double CellSim::getSuggestedDt() const
+{
+    double fPhysicsDt = m_pPhysicsCore->getSuggestedDt();
+    double fChemistryDt = m_pCell->getInternalMedium().getSuggestedDt();
+    if (fPhysicsDt <= 0)
+        return fChemistryDt;
+    if (fChemistryDt <= 0)
+        return fPhysicsDt;
+    return std::min(fPhysicsDt, fChemistryDt);
+}
+
+uint32_t CellSim::getLastRejectedSubsteps() const
+{
+    return m_pPhysicsCore->getLastStepStats().m_nRejected + m_pCell->getInternalMedium().getLastRejectedStepCount();
+}
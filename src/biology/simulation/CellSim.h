@@ -20,8 +20,19 @@ public:
     
     // Simulation step method
     virtual void update(const TimeContext& time);
+
+    // Error control of the mechanics and of the internal medium chemistry
+    void setAdaptiveTimeStepping(const AdaptiveTimeStepping& settings);
+    // Sleeping of the mechanics and of the internal medium chemistry
+    void setQuiescence(const Quiescence& settings);
+    // Smallest step size mechanics and chemistry ask for (0 if neither has error control)
+    double getSuggestedDt() const;
+    // Substeps mechanics and chemistry undid and redid in the last update()
+    uint32_t getLastRejectedSubsteps() const;
     
     // Accessor for the underlying cell
     std::shared_ptr<Cell> getCell() const { return m_pCell; }
+    // Mechanics of the cell
+    PhysicsCore& getPhysicsCore() const { return *m_pPhysicsCore; }
 };
 
@@ -3,8 +3,96 @@
 
 void Organism::simulateStep(const TimeContext& time)
 {
+    detectContacts();
     for (uint32_t u = 0; u < m_pCellSims.size(); ++u)
     {
         m_pCellSims[u]->update(time);
     }
 }
+
+void Organism::setAdaptiveTimeStepping(const AdaptiveTimeStepping& settings)
+{
+    for (auto& pCellSim : m_pCellSims)
+    {
+        pCellSim->setAdaptiveTimeStepping(settings);
+    }
+}
+
+void Organism::setQuiescence(const Quiescence& settings)
+{
+    for (auto& pCellSim : m_pCellSims)
+    {
+        pCellSim->setQuiescence(settings);
+    }
+}
+
+uint32_t Organism::getSleepingMechanicsCount() const
+{
+    uint32_t nSleeping = 0;
+    for (auto& pCellSim : m_pCellSims)
+    {
+        nSleeping += pCellSim->getPhysicsCore().isSleeping() ? 1 : 0;
+    }
+    return nSleeping;
+}
+
+double Organism::getSuggestedDt() const
+{
+    double fDt = 0;
+    for (auto& pCellSim : m_pCellSims)
+    {
+        double fCellDt = pCellSim->getSuggestedDt();
+        if (fCellDt > 0 && (fDt == 0 || fCellDt < fDt))
+            fDt = fCellDt;
+    }
+    return fDt;
+}
+
+uint32_t Organism::getLastRejectedSubsteps() const
+{
+    uint32_t nRejected = 0;
+    for (auto& pCellSim : m_pCellSims)
+    {
+        nRejected += pCellSim->getLastRejectedSubsteps();
+    }
+    return nRejected;
+}
+
+void Organism::detectContacts()
+{
+    // Cells are registered again whenever the organism gained, lost or replaced some
+    bool bRegistered = m_collisionDetector.getBodyCount() == m_pCellSims.size();
+    for (uint32_t u = 0; bRegistered && u < m_pCellSims.size(); ++u)
+        bRegistered = m_collisionDetector.getBody(u) == m_pCellSims[u]->getPhysicsCore().getCortexBody();
+    if (!bRegistered)
+    {
+        m_collisionDetector.clearBodies();
+        for (auto& pCellSim : m_pCellSims)
+        {
+            PhysicsCore& physicsCore = pCellSim->getPhysicsCore();
+            m_collisionDetector.addBody(physicsCore.getCortexBody(), physicsCore.getContactConstraint());
+        }
+    }
+    // Cells woken by what drives them are awake before detection, so that they get all their
+    // contacts. Contacts can wake cells too: those are detected again with theirs.
+    for (uint32_t u = 0; u < m_pCellSims.size(); ++u)
+    {
+        PhysicsCore& physicsCore = m_pCellSims[u]->getPhysicsCore();
+        m_collisionDetector.setBodyOffset(u, physicsCore.getOrganismOffset());
+        m_collisionDetector.setBodySleeping(u, !physicsCore.updateWake());
+    }
+    m_collisionDetector.detect();
+
+    bool bWoken = false;
+    for (uint32_t u = 0; u < m_pCellSims.size(); ++u)
+    {
+        PhysicsCore& physicsCore = m_pCellSims[u]->getPhysicsCore();
+        if (physicsCore.isSleeping() && physicsCore.updateWake())
+        {
+            m_collisionDetector.setBodySleeping(u, false);
+            bWoken = true;
+        }
+    }
+    if (bWoken)
+        m_collisionDetector.detect();
+}
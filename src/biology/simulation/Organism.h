@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include "biology/simulation/TimeContext.h"
+#include "physics/CollisionDetector.h"
 
 class Organism
 {
@@ -12,9 +13,30 @@ protected:
 public:
     virtual void simulateStep(const TimeContext& time);
 
+    void setAdaptiveTimeStepping(const AdaptiveTimeStepping& settings);
+    // Smallest step size the cells ask for (0 if none has error control)
+    double getSuggestedDt() const;
+    uint32_t getLastRejectedSubsteps() const;
+
+    // Sleeping of mechanics and chemistry per cell; each cell's mechanics sleep as one island,
+    // woken by contacts of awake neighbours among other things
+    void setQuiescence(const Quiescence& settings);
+    // Cells whose mechanics sleep
+    uint32_t getSleepingMechanicsCount() const;
+
     const std::vector<std::shared_ptr<class CellSim>>& getCellSims() const
     {
         return m_pCellSims;
     }
+
+    // Contact of the cell cortices with each other and with the eggshell (if one is set), detected
+    // before every step at the cells' organism offsets (PhysicsCore::setOrganismOffset)
+    CollisionDetector& accessCollisionDetector() { return m_collisionDetector; }
+    const CollisionDetector& getCollisionDetector() const { return m_collisionDetector; }
+
+private:
+    CollisionDetector m_collisionDetector;
+
+    void detectContacts();
 };
 
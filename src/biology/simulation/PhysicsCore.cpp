@@ -5,8 +5,11 @@
 #include "physics/PhysicsMesh.h"
 #include "physics/PhysicsIntegrator.h"
 #include "physics/VolumeConstraint.h"
+#include "physics/ContactConstraint.h"
 #include "physics/DyneinPullingForce.h"
+#include "physics/MicrotubuleRods.h"
 #include "physics/PhysCentrosome.h"
+#include "physics/PhysMicrotubule.h"
 #include "chemistry/molecules/simConstants.h"
 #include "utils/log/ILog.h"
 #include "biology/organelles/Cell.h"
@@ -37,12 +40,17 @@ void PhysicsCore::initialize(std::shared_ptr<Cell> pCell)
     m_integrator.addForceGenerator(std::make_unique<EdgeDampingForce>(*m_pCortexAdapter, m_fDampingCoeff));
     m_integrator.addForceGenerator(
         std::make_unique<DyneinPullingForce>(*m_pCortexAdapter, m_centrosomes, MoleculeConstants::DYNEIN_PULLING_FORCE_PICONEWTONS));
+    // Microtubules bend as elastic rods and push the cortex where their tips touch it
+    m_integrator.addForceGenerator(std::make_unique<MicrotubuleRodForce>(*m_pCortexAdapter, m_centrosomes));
 
     // Pull volume from cell's internal medium
     double fVolume = m_pCell->getInternalMedium().getVolumeMicroM();
     // Register constraints with integrator
     m_pVolumeConstraint = std::make_shared<VolumeConstraintXPBD>(*m_pCortexAdapter, fVolume, 0.0);
     m_integrator.addConstraint(m_pVolumeConstraint);
+    // Contacts last, so that they hold against the other constraints of the iteration
+    m_pContactConstraint = std::make_shared<ContactConstraintXPBD>(*m_pCortexAdapter);
+    m_integrator.addConstraint(m_pContactConstraint);
 }
 
 void PhysicsCore::makeTimeStep(double fDtSec)
@@ -51,12 +59,127 @@ void PhysicsCore::makeTimeStep(double fDtSec)
     double fVolume = m_pCell->getInternalMedium().getVolumeMicroM();
     m_pVolumeConstraint->setTargetVolume(fVolume);
 
+    if (!updateWake())
+        return;
+
     // Execute complete physics pipeline
     m_integrator.step(fDtSec);
 
     // Push updated mesh back to cortex
     auto pCortex = std::dynamic_pointer_cast<Cortex>(m_pCell->getOrganelle(StringDict::ID::ORGANELLE_CORTEX));
     pCortex->setTriangleMesh(m_pCortexAdapter->m_pMesh);
+
+    if (m_nRemeshInterval > 0 && ++m_nStepsSinceRemesh >= m_nRemeshInterval)
+    {
+        m_nStepsSinceRemesh = 0;
+        remeshCortex();
+    }
+    updateSleep(fVolume);
+}
+
+void PhysicsCore::setSleeping(double fKineticEnergy, uint32_t nQuietSteps, double fWakeDistance)
+{
+    m_fSleepKineticEnergy = fKineticEnergy;
+    m_nSleepQuietSteps = std::max(1u, nQuietSteps);
+    m_fWakeDistance = fWakeDistance;
+    wake();
+}
+
+void PhysicsCore::wake()
+{
+    m_bSleeping = false;
+    m_nQuietSteps = 0;
+}
+
+bool PhysicsCore::updateWake()
+{
+    if (m_bSleeping && shouldWake(m_pCell->getInternalMedium().getVolumeMicroM()))
+        wake();
+    return !m_bSleeping;
+}
+
+void PhysicsCore::updateSleep(double fTargetVolume)
+{
+    if (m_fSleepKineticEnergy <= 0)
+        return;
+    if (m_integrator.computeKineticEnergy() >= m_fSleepKineticEnergy)
+    {
+        m_nQuietSteps = 0;
+        return;
+    }
+    if (++m_nQuietSteps < m_nSleepQuietSteps)
+        return;
+    // The residual motion is dropped, so that the mechanics wake up at rest
+    m_integrator.clearVelocities();
+    m_bSleeping = true;
+    m_sleepDrive = getDrive(fTargetVolume);
+}
+
+PhysicsCore::Drive PhysicsCore::getDrive(double fTargetVolume) const
+{
+    Drive drive;
+    drive.m_fTargetVolume = fTargetVolume;
+    drive.m_uMeshVersion = m_pCortexAdapter->m_pMesh->getVersion();
+    for (auto& pCentrosome : m_centrosomes)
+    {
+        for (auto& pMT : pCentrosome->getMicrotubules())
+        {
+            const bool bBound = pMT->getState() == PhysMicrotubule::MTState::Bound;
+            if (!bBound && !pMT->hasTipContact())
+                continue;
+            drive.m_nBoundMTs += bBound ? 1 : 0;
+            drive.m_nTipContacts += pMT->hasTipContact() ? 1 : 0;
+            drive.m_fDrivingMTLength += pMT->getMTLengthMicroM();
+        }
+    }
+    return drive;
+}
+
+bool PhysicsCore::shouldWake(double fTargetVolume) const
+{
+    const Drive drive = getDrive(fTargetVolume);
+    // A change dV of the target volume moves a roughly spherical cortex of radius r by
+    // dr = r / 3 * dV / V
+    const float3 vSize = m_pCortexAdapter->m_pMesh->getBox().diagonal();
+    const double fRadius = 0.5 * std::max(vSize.x, std::max(vSize.y, vSize.z));
+    if (std::abs(drive.m_fTargetVolume - m_sleepDrive.m_fTargetVolume) * fRadius / 3.0
+        > m_fWakeDistance * m_sleepDrive.m_fTargetVolume)
+        return true;
+    if (drive.m_uMeshVersion != m_sleepDrive.m_uMeshVersion ||
+        drive.m_nBoundMTs != m_sleepDrive.m_nBoundMTs ||
+        drive.m_nTipContacts != m_sleepDrive.m_nTipContacts ||
+        std::abs(drive.m_fDrivingMTLength - m_sleepDrive.m_fDrivingMTLength) > m_fWakeDistance)
+        return true;
+    // Contacts are detected anew before every step; they only push a sleeping cortex if a
+    // neighbour that is awake moved into it
+    return m_pContactConstraint->computeMaxPenetration() > m_fWakeDistance;
+}
+
+void PhysicsCore::setCortexRemeshing(uint32_t nStepInterval, const MeshRemesher::Settings& settings)
+{
+    m_nRemeshInterval = nStepInterval;
+    m_nStepsSinceRemesh = 0;
+    m_cortexRemesher.setSettings(settings);
+}
+
+void PhysicsCore::remeshCortex()
+{
+    auto pCortex = std::dynamic_pointer_cast<Cortex>(m_pCell->getOrganelle(StringDict::ID::ORGANELLE_CORTEX));
+    const MeshRemesher::Changes changes = pCortex->remesh(m_cortexRemesher);
+    if (changes.isEmpty())
+        return;
+
+    m_integrator.applyMeshChanges(*m_pCortexAdapter, changes);
+    for (auto& pCentrosome : m_centrosomes)
+    {
+        for (auto& pMT : pCentrosome->getMicrotubules())
+        {
+            if (pMT->getState() == PhysMicrotubule::MTState::Bound)
+                changes.relocate(pMT->getAttachmentLocation(), *m_pCortexAdapter->m_pMesh);
+            if (pMT->hasTipContact())
+                changes.relocate(pMT->getTipContact(), *m_pCortexAdapter->m_pMesh);
+        }
+    }
 }
 
 
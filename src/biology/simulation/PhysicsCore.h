@@ -7,8 +7,10 @@
 #include <memory>
 #include "geometry/vectors/vector.h"
 #include "geometry/mesh/TriangleMesh.h"
+#include "geometry/mesh/MeshRemesher.h"
 #include "physics/PhysicsIntegrator.h"
 #include "physics/VolumeConstraint.h"
+#include "physics/ContactConstraint.h"
 #include "physics/PhysicsMesh.h"
 
 class Cell;
@@ -27,7 +29,59 @@ public:
 
     void makeTimeStep(double fDtSec);
 
+    // Remesh the cortex every nStepInterval time steps (0 disables remeshing)
+    void setCortexRemeshing(uint32_t nStepInterval, const MeshRemesher::Settings& settings);
+
+    // Error-controlled mechanics (see PhysicsIntegrator::setErrorControl), tolerance in cortex mesh
+    // units; makeTimeStep() then covers its dt with as many steps as the error requires
+    void setErrorControl(double fTolerance, const StepSizeController::Settings& settings)
+    {
+        m_integrator.setErrorControl(fTolerance, settings);
+    }
+    // Step size the mechanics would take next (0 without error control or before the first step)
+    double getSuggestedDt() const { return m_integrator.getSuggestedDt(); }
+    const PhysicsIntegrator::StepStats& getLastStepStats() const { return m_integrator.getLastStepStats(); }
+
+    // Placement of the cell among the cells of its organism: cell coordinates plus this offset are
+    // the coordinates all cells (and the eggshell) share for contact
+    void setOrganismOffset(const float3& vOffset) { m_vOrganismOffset = vOffset; }
+    const float3& getOrganismOffset() const { return m_vOrganismOffset; }
+
+    // Sleeping (fKineticEnergy > 0; 0 disables it): after nQuietSteps steps in a row that end with
+    // the kinetic energy of cortex and centrosomes below fKineticEnergy the mechanics are brought to
+    // rest and makeTimeStep() skips them. They wake when something that drives them changes: the
+    // target volume, the cortex mesh (moved or remeshed by someone else), the microtubules bound to
+    // or touching the cortex, or a contact that pushes the cortex by more than fWakeDistance.
+    void setSleeping(double fKineticEnergy, uint32_t nQuietSteps, double fWakeDistance);
+    bool isSleeping() const { return m_bSleeping; }
+    void wake();
+    // Wake sleeping mechanics if something that drives them changed; makeTimeStep() checks too.
+    // Returns whether the mechanics are awake.
+    bool updateWake();
+
+    // Cortex body and the constraint its contacts with other cells and the eggshell go to
+    std::shared_ptr<PhysicsMesh> getCortexBody() const { return m_pCortexAdapter; }
+    std::shared_ptr<ContactConstraintXPBD> getContactConstraint() const { return m_pContactConstraint; }
+
 private:
+    // One remeshing round of the cortex; brings physics state and microtubule attachments along
+    void remeshCortex();
+
+    // What the mechanics are driven by besides their own state, compared against the record taken
+    // when they fell asleep. Bound and touching microtubules push and pull the cortex; their length
+    // changes those forces.
+    struct Drive
+    {
+        double m_fTargetVolume = 0.0;
+        uint64_t m_uMeshVersion = 0;
+        uint32_t m_nBoundMTs = 0;
+        uint32_t m_nTipContacts = 0;
+        double m_fDrivingMTLength = 0.0;
+    };
+    Drive getDrive(double fTargetVolume) const;
+    bool shouldWake(double fTargetVolume) const;
+    void updateSleep(double fTargetVolume);
+
     // Reference to the cell (for accessing cortex mesh and medium volume)
     std::shared_ptr<Cell> m_pCell;
 
@@ -45,6 +99,23 @@ private:
 
     // Volume constraint for dynamic volume updates
     std::shared_ptr<VolumeConstraintXPBD> m_pVolumeConstraint;
+
+    // Contacts with other cells and the eggshell, filled by the organism before every step
+    std::shared_ptr<ContactConstraintXPBD> m_pContactConstraint;
+    float3 m_vOrganismOffset = float3(0, 0, 0);
+
+    // Sleeping
+    double m_fSleepKineticEnergy = 0.0;
+    uint32_t m_nSleepQuietSteps = 10;
+    double m_fWakeDistance = 1e-3;
+    uint32_t m_nQuietSteps = 0;
+    bool m_bSleeping = false;
+    Drive m_sleepDrive;
+
+    // Adaptive cortex remeshing
+    MeshRemesher m_cortexRemesher;
+    uint32_t m_nRemeshInterval = 0;
+    uint32_t m_nStepsSinceRemesh = 0;
 };
 
 
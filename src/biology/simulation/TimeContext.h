@@ -1,9 +1,39 @@
 #pragma once
 
+#include <cstdint>
+
 struct TimeContext
 {
     double m_curTSec = 0.0;
     double m_deltaTSec = 0.0;
+    // Steps taken so far, and the mechanics and chemistry substeps that error control undid and redid
+    uint64_t m_nSteps = 0;
+    uint64_t m_nRejectedSubsteps = 0;
 };
 
+// Adaptive time stepping of World::simulateStep()
+struct AdaptiveTimeStepping
+{
+    double m_fMinDtSec = 1e-4;
+    double m_fMaxDtSec = 10.0;
+    // Step doubling error bound of cortex and centrosome positions (0: fixed mechanics steps)
+    double m_fPhysicsTolerance = 1e-3;
+    // Largest fraction of a molecule population that may change in one chemistry step
+    // (0: fixed chemistry steps)
+    double m_fMaxChemistryChange = 0.1;
+};
 
+// Sleeping of the mechanics and chemistry that came to rest (Organism::setQuiescence()); both
+// wake again when something changes what drives them
+struct Quiescence
+{
+    // The mechanics of a cell sleep after m_nQuietSteps steps in a row ending with the kinetic energy
+    // of cortex and centrosomes below m_fKineticEnergy (0: never)
+    double m_fKineticEnergy = 1e-6;
+    // ... and wake when a change would move the cortex by more than m_fWakeDistance
+    double m_fWakeDistance = 1e-3;
+    // A grid cell of a medium sleeps after m_nQuietSteps steps in a row in which none of its
+    // populations changed by more than the fraction m_fMaxChemistryChange (0: never)
+    double m_fMaxChemistryChange = 1e-6;
+    uint32_t m_nQuietSteps = 10;
+};
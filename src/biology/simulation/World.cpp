@@ -1,5 +1,6 @@
 #include "World.h"
 #include "biology/simulation/Organism.h"
+#include <algorithm>
 
 World::World(std::shared_ptr<Organism> pOrganism)
 {
@@ -7,8 +8,40 @@ World::World(std::shared_ptr<Organism> pOrganism)
 }
 
 void World::simulateStep(double dt)
+{
+    if (!m_bAdaptive)
+    {
+        advance(dt);
+        return;
+    }
+
+    double fRemaining = dt;
+    while (fRemaining > 1e-12 * dt)
+    {
+        double fSuggested = m_pOrganism->getSuggestedDt();
+        if (fSuggested <= 0)
+            fSuggested = m_adaptive.m_fMaxDtSec;
+        double fStepDt = std::clamp(fSuggested, m_adaptive.m_fMinDtSec, m_adaptive.m_fMaxDtSec);
+        // Stretch the step over a leftover that would be much shorter than the step itself
+        if (fRemaining < 1.25 * fStepDt)
+            fStepDt = fRemaining;
+        advance(fStepDt);
+        fRemaining -= fStepDt;
+    }
+}
+
+void World::advance(double dt)
 {
     m_timeContext.m_deltaTSec = dt;
     m_timeContext.m_curTSec += dt;
+    ++m_timeContext.m_nSteps;
     m_pOrganism->simulateStep(m_timeContext);
+    m_timeContext.m_nRejectedSubsteps += m_pOrganism->getLastRejectedSubsteps();
+}
+
+void World::setAdaptiveTimeStepping(const AdaptiveTimeStepping& settings)
+{
+    m_bAdaptive = true;
+    m_adaptive = settings;
+    m_pOrganism->setAdaptiveTimeStepping(settings);
 }
\ No newline at end of file
@@ -8,10 +8,21 @@ class World
     std::shared_ptr<class Medium> m_pMedium;
     std::shared_ptr<class Organism> m_pOrganism;
     TimeContext m_timeContext;
+    bool m_bAdaptive = false;
+    AdaptiveTimeStepping m_adaptive;
+
+    // One organism step of dt
+    void advance(double dt);
 
 public:
     World(std::shared_ptr<Organism> pOrganism);
     void simulateStep(double dt);
+
+    // With adaptive time stepping simulateStep(dt) advances by dt in steps as long as the mechanics
+    // and chemistry of all cells currently allow (within [min, max]); inside a step each of them
+    // covers it with its own error-controlled substeps, undoing and redoing those that fail.
+    // Quiescent phases thus run with few large steps and TimeContext reports the steps taken.
+    void setAdaptiveTimeStepping(const AdaptiveTimeStepping& settings);
     
     double getCurrentTime() const { return m_timeContext.m_curTSec; }
     const TimeContext& getTimeContext() const { return m_timeContext; }
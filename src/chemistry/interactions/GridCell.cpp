@@ -43,8 +43,9 @@ void GridCell::updateMRNAs(double dt)
     }
 }
 
-void GridCell::updateTRNAs(double dt)
+double GridCell::updateTRNAs(double dt)
 {
+    double fMaxChange = 0.0;
     // Handle tRNA charging - convert uncharged tRNAs to charged tRNAs based on charging rate
     // Instead of iterating through all molecules, just check the known uncharged tRNA IDs
     const auto& unchargedTRNAIds = TRNA::getUnchargedTRNAIds();
@@ -69,6 +70,8 @@ void GridCell::updateTRNAs(double dt)
                     
                     // Transfer molecules from uncharged to charged
                     Population& chargedPop = getOrCreateMolPop(chargedTRNA);
+                    fMaxChange = std::max(fMaxChange, relativeChange(chargedPop.m_fNumber, chargedPop.m_fNumber + chargedAmount));
+                    fMaxChange = std::max(fMaxChange, relativeChange(it->second.m_fNumber, it->second.m_fNumber - chargedAmount));
                     chargedPop.m_fNumber += chargedAmount;
                     it->second.m_fNumber -= chargedAmount;
                     
@@ -80,6 +83,7 @@ void GridCell::updateTRNAs(double dt)
             }
         }
     }
+    return fMaxChange;
 }
 
 bool GridCell::hasMRNAs() const
@@ -3,6 +3,7 @@
 #include "MoleculeInteraction.h"
 #include <cassert>
 #include <algorithm>
+#include <limits>
 
 ResourceDistributor::ResourceDistributor()
 {
@@ -93,6 +94,28 @@ void ResourceDistributor::notifyNewRealRun()
 {
     assert(m_curRealRunId < m_curDryRunId);
     m_curRealRunId = m_curDryRunId;
+
+    for (const auto& [molecule, resource] : m_resources)
+    {
+        if (resource.m_dryRunId != m_curDryRunId || resource.m_fRequested <= 0)
+            continue;
+        double fRatio = resource.m_fAvailable > 0 ? resource.m_fRequested / resource.m_fAvailable
+                                                  : std::numeric_limits<double>::infinity();
+        m_fMaxDemandRatio = std::max(m_fMaxDemandRatio, fRatio);
+    }
+}
+
+double ResourceDistributor::getMaxRelativeChange(const GridCell& cell) const
+{
+    // The dry run recorded every population of the cell as available before the interactions ran
+    double fMaxChange = 0.0;
+    for (const auto& [molecule, population] : cell.m_molecules)
+    {
+        auto it = m_resources.find(molecule);
+        const double fBefore = (it != m_resources.end() && it->second.m_dryRunId == m_curDryRunId) ? it->second.m_fAvailable : 0.0;
+        fMaxChange = std::max(fMaxChange, GridCell::relativeChange(fBefore, population.m_fNumber));
+    }
+    return fMaxChange;
 }
 
 void ResourceDistributor::updateAvailableResources(const GridCell &cell)
@@ -103,6 +126,8 @@ void ResourceDistributor::updateAvailableResources(const GridCell &cell)
         // Update the available amount for this molecule
         auto& resource = m_resources[molecule];
         resource.m_fAvailable = population.m_fNumber;
+        // Requests are per dry run, like the available amount they are weighed against
+        resource.m_fRequested = 0;
         resource.m_dryRunId = m_curDryRunId;
     }
 }
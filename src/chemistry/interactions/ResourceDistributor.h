@@ -31,10 +31,20 @@ public:
 
     bool isDryRun() const { return m_curDryRunId > m_curRealRunId; }
 
+    // Largest ratio of requested to available amount of a resource over the dry runs since the last
+    // reset. Above 1 the interactions wanted more than there was and got scaled down.
+    double getMaxDemandRatio() const { return m_fMaxDemandRatio; }
+    void resetMaxDemandRatio() { m_fMaxDemandRatio = 0; }
+
+    // Largest GridCell::relativeChange() of a population of cell since the last dry run on it
+    // (populations the interactions created count as grown from 0)
+    double getMaxRelativeChange(const class GridCell& cell) const;
+
 private:
     void updateAvailableResources(const GridCell& cell);
 
     uint64_t m_curDryRunId = 0, m_curRealRunId = 0;
+    double m_fMaxDemandRatio = 0;
 
     struct ResourceData
     {
@@ -4,6 +4,8 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <algorithm>
+#include <cmath>
 #include "chemistry/molecules/Molecule.h"
 
 // A single cell in the 3D grid representing the simulation space
@@ -12,6 +14,14 @@ class GridCell
 public:
     // Minimum possible resource level (to check with assertions)
     static constexpr double MIN_RESOURCE_LEVEL = 0.0;
+    // Populations smaller than this change relative to it (see relativeChange())
+    static constexpr double MIN_CHANGE_POPULATION = 1.0;
+
+    // Relative change of a population that went from fBefore to fAfter molecules
+    static double relativeChange(double fBefore, double fAfter)
+    {
+        return std::abs(fAfter - fBefore) / std::max(fBefore, MIN_CHANGE_POPULATION);
+    }
 
     std::unordered_map<Molecule, Population> m_molecules;
     
@@ -28,7 +38,9 @@ public:
     void updateMRNAs(double dt);  // Handle mRNA degradation and cleanup
     
     // tRNA management  
-    void updateTRNAs(double dt);  // Handle tRNA charging transitions (uncharged -> charged)
+    // Handle tRNA charging transitions (uncharged -> charged); returns the largest relativeChange()
+    // of a population
+    double updateTRNAs(double dt);
 
     // Volume accessors
     inline double getVolumeMicroM3() const { return m_volumeMicroM3; }
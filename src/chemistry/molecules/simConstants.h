@@ -46,6 +46,9 @@ namespace MoleculeConstants
     
     // Dynein pulling force (physics)
     constexpr double DYNEIN_PULLING_FORCE_PICONEWTONS = 5.0;  // pN (picoNewtons per bound microtubule)
+
+    // Lateral diffusion of cortex-bound complexes within the membrane (SurfaceDiffusion)
+    constexpr double CORTEX_MEMBRANE_DIFFUSION_UM2_PER_S = 0.2;  // µm^2/s (PAR proteins: ~0.15-0.3)
 }
 
 
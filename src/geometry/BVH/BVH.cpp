@@ -1,6 +1,101 @@
 #include "BVH.h"
+#include "geometry/vectors/simd4.h"
+#include <cassert>
 #include <algorithm>
-#include "geometry/vectors/intersections.h"
+#include <bit>
+#include <future>
+#include <thread>
+#include <limits>
+#include <numeric>
+
+namespace {
+    const uint32_t MAX_LEAF_OBJECTS = 4;
+    const int MAX_DEPTH = 48;
+    const int MAX_TRAVERSAL_STACK = 64;  // must exceed MAX_DEPTH: traversal pushes at most one node per level
+    const uint32_t SAH_BIN_COUNT = 12;
+    const float SAH_TRAVERSAL_COST = 1.0f;
+    const float SAH_INTERSECTION_COST = 1.0f;
+
+    inline float halfSurfaceArea(const box3& b)
+    {
+        if (b.isempty())
+            return 0.0f;
+        const float3 d = b.m_maxs - b.m_mins;
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    // Reciprocal ray direction; near-zero components map to a large finite value so
+    // slab distances stay finite (no inf * 0 = NaN when the origin lies on a slab plane)
+    inline float3 computeInvDir(const float3& dir)
+    {
+        const float BIG = 1e30f;
+        float3 inv;
+        for (int i = 0; i < 3; ++i)
+        {
+            inv[i] = (std::abs(dir[i]) > std::numeric_limits<float>::epsilon())
+                ? 1.0f / dir[i] : (dir[i] >= 0.0f ? BIG : -BIG);
+        }
+        return inv;
+    }
+
+    // Slab test against the active ray range [tMin, tMax]; outputs the entry distance
+    inline bool intersectSlabs(const box3& b, const float3& org, const float3& invDir,
+                               float tMin, float tMax, float& outNear)
+    {
+        const float tx1 = (b.m_mins.x - org.x) * invDir.x, tx2 = (b.m_maxs.x - org.x) * invDir.x;
+        const float ty1 = (b.m_mins.y - org.y) * invDir.y, ty2 = (b.m_maxs.y - org.y) * invDir.y;
+        const float tz1 = (b.m_mins.z - org.z) * invDir.z, tz2 = (b.m_maxs.z - org.z) * invDir.z;
+        const float tNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::min(tz1, tz2));
+        const float tFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::max(tz1, tz2));
+        // Box behind the ray origin is rejected regardless of the active range
+        if (tFar < 0.0f)
+            return false;
+        outNear = std::max(tNear, tMin);
+        return outNear <= std::min(tFar, tMax);
+    }
+
+    // Squared distance from a point to a box (0 inside)
+    inline float boxDistanceSq(const box3& b, const float3& p)
+    {
+        float distSq = 0.0f;
+        for (int i = 0; i < 3; ++i)
+        {
+            const float d = std::max(std::max(b.m_mins[i] - p[i], p[i] - b.m_maxs[i]), 0.0f);
+            distSq += d * d;
+        }
+        return distSq;
+    }
+
+    // Packet lanes loaded into SIMD registers once per traversal
+    struct PacketRays
+    {
+        simd4f m_orgX, m_orgY, m_orgZ;
+        simd4f m_invDirX, m_invDirY, m_invDirZ;
+        simd4f m_tMin;
+
+        explicit PacketRays(const RayPacket& packet)
+            : m_orgX(simd4f::load(packet.m_posX)), m_orgY(simd4f::load(packet.m_posY)), m_orgZ(simd4f::load(packet.m_posZ))
+            , m_invDirX(simd4f::load(packet.m_invDirX)), m_invDirY(simd4f::load(packet.m_invDirY)), m_invDirZ(simd4f::load(packet.m_invDirZ))
+            , m_tMin(simd4f::load(packet.m_fMin))
+        {
+        }
+    };
+
+    // intersectSlabs for all packet lanes; returns the mask of lanes whose active range overlaps the box
+    inline uint32_t intersectSlabsPacket(const box3& b, const PacketRays& rays, simd4f tMax, simd4f& outNear)
+    {
+        const simd4f tx1 = (simd4f::broadcast(b.m_mins.x) - rays.m_orgX) * rays.m_invDirX;
+        const simd4f tx2 = (simd4f::broadcast(b.m_maxs.x) - rays.m_orgX) * rays.m_invDirX;
+        const simd4f ty1 = (simd4f::broadcast(b.m_mins.y) - rays.m_orgY) * rays.m_invDirY;
+        const simd4f ty2 = (simd4f::broadcast(b.m_maxs.y) - rays.m_orgY) * rays.m_invDirY;
+        const simd4f tz1 = (simd4f::broadcast(b.m_mins.z) - rays.m_orgZ) * rays.m_invDirZ;
+        const simd4f tz2 = (simd4f::broadcast(b.m_maxs.z) - rays.m_orgZ) * rays.m_invDirZ;
+        const simd4f tNear = max(max(min(tx1, tx2), min(ty1, ty2)), min(tz1, tz2));
+        const simd4f tFar = min(min(max(tx1, tx2), max(ty1, ty2)), max(tz1, tz2));
+        outNear = max(tNear, rays.m_tMin);
+        return static_cast<uint32_t>(movemask((tFar >= simd4f::zero()) & (outNear <= min(tFar, tMax))));
+    }
+}
 
 BVH::BVH()
 {
@@ -13,10 +108,27 @@ std::vector<std::shared_ptr<ITraceableObject>>& BVH::accessObjects()
     return m_pObjects;
 }
 
+void BVH::replaceObject(const ITraceableObject* pOld, std::shared_ptr<ITraceableObject> pNew)
+{
+    assert(pNew && pNew->m_nSubObjects == pOld->m_nSubObjects);
+    for (auto& pObject : m_pObjects)
+    {
+        if (pObject.get() == pOld)
+            pObject = pNew;
+    }
+    for (SubObj& subObj : m_subObjects)
+    {
+        if (subObj.pObj == pOld)
+            subObj.pObj = pNew.get();
+    }
+    if (m_pSingleObject == pOld)
+        m_pSingleObject = pNew.get();
+}
+
 box3 BVH::getBox() const
 {
-    assert(m_pRoot != nullptr);
-    return m_pRoot->m_boundingBox;
+    assert(!m_nodes.empty());
+    return m_nodes[0].m_boundingBox;
 }
 
 box3 BVH::getSubObjectBox(uint32_t uSubObj) const
@@ -28,22 +140,358 @@ box3 BVH::getSubObjectBox(uint32_t uSubObj) const
 
 void BVH::trace(IRay& ray, uint32_t uSubObj) const
 {
-    assert(m_pRoot != nullptr && uSubObj == 0);
-    // Use hierarchical traversal
-    traceNode(ray, m_pRoot.get());
+    assert(!m_nodes.empty() && uSubObj == 0);
+
+    const float3 org = ray.m_vPos;
+    const float3 invDir = computeInvDir(ray.m_vDir);
+
+    struct StackEntry
+    {
+        uint32_t m_uNode;
+        float m_fNear;
+    };
+    StackEntry stack[MAX_TRAVERSAL_STACK];
+    int stackSize = 0;
+
+    float fNear;
+    if (!intersectSlabs(m_nodes[0].m_boundingBox, org, invDir, ray.m_fMin, ray.m_fMax, fNear))
+        return;
+
+    uint32_t uCur = 0;
+    for (;;)
+    {
+        const Node& node = m_nodes[uCur];
+        if (node.isLeaf())
+        {
+            if (m_pSingleObject)
+            {
+                m_pSingleObject->traceLeaf(ray, &m_leafSubObjects[node.m_uOffset], node.m_nSubObjects);
+            }
+            else
+            {
+                const uint32_t uEnd = node.m_uOffset + node.m_nSubObjects;
+                for (uint32_t i = node.m_uOffset; i < uEnd; ++i)
+                {
+                    // Cached sub-object box first; m_fMax may shrink as intersections are reported
+                    if (intersectSlabs(m_subObjectBoxes[i], org, invDir, ray.m_fMin, ray.m_fMax, fNear))
+                    {
+                        const SubObj& subObj = m_subObjects[i];
+                        subObj.pObj->trace(ray, subObj.m_uSubObj);
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Visit the nearer child first and defer the farther one
+            uint32_t uLeft = uCur + 1, uRight = node.m_uOffset;
+            float fLeft, fRight;
+            const bool hitLeft = intersectSlabs(m_nodes[uLeft].m_boundingBox, org, invDir, ray.m_fMin, ray.m_fMax, fLeft);
+            const bool hitRight = intersectSlabs(m_nodes[uRight].m_boundingBox, org, invDir, ray.m_fMin, ray.m_fMax, fRight);
+            if (hitLeft && hitRight)
+            {
+                if (fRight < fLeft)
+                {
+                    std::swap(uLeft, uRight);
+                    std::swap(fLeft, fRight);
+                }
+                assert(stackSize < MAX_TRAVERSAL_STACK);
+                stack[stackSize++] = { uRight, fRight };
+                uCur = uLeft;
+                continue;
+            }
+            if (hitLeft || hitRight)
+            {
+                uCur = hitLeft ? uLeft : uRight;
+                continue;
+            }
+        }
+
+        // Pop deferred nodes, skipping those that start beyond the (possibly shrunk) ray range
+        for (;;)
+        {
+            if (stackSize == 0)
+                return;
+            const StackEntry& entry = stack[--stackSize];
+            if (entry.m_fNear <= ray.m_fMax)
+            {
+                uCur = entry.m_uNode;
+                break;
+            }
+        }
+    }
 }
 
-void BVH::rebuildHierarchy()
+void BVH::tracePacket(RayPacket& packet, uint32_t uSubObj, uint32_t uLaneMask) const
 {
-    if (m_pObjects.empty())
+    assert(!m_nodes.empty() && uSubObj == 0);
+
+    const PacketRays rays(packet);
+
+    // Deferred nodes keep the entry distance of every lane so they can be culled once hits shrink m_fMax
+    struct StackEntry
     {
-        m_pRoot = nullptr;
+        simd4f m_near;
+        uint32_t m_uNode;
+        uint32_t m_uLaneMask;
+    };
+    StackEntry stack[MAX_TRAVERSAL_STACK];
+    int stackSize = 0;
+
+    simd4f near;
+    uint32_t uMask = uLaneMask & intersectSlabsPacket(m_nodes[0].m_boundingBox, rays, simd4f::load(packet.m_fMax), near);
+    if (uMask == 0)
         return;
+
+    uint32_t uCur = 0;
+    for (;;)
+    {
+        const Node& node = m_nodes[uCur];
+        if (node.isLeaf())
+        {
+            const uint32_t uEnd = node.m_uOffset + node.m_nSubObjects;
+            for (uint32_t i = node.m_uOffset; i < uEnd; ++i)
+            {
+                const uint32_t uHitMask = uMask & intersectSlabsPacket(m_subObjectBoxes[i], rays, simd4f::load(packet.m_fMax), near);
+                if (uHitMask != 0)
+                {
+                    const SubObj& subObj = m_subObjects[i];
+                    subObj.pObj->tracePacket(packet, subObj.m_uSubObj, uHitMask);
+                }
+            }
+        }
+        else
+        {
+            uint32_t uLeft = uCur + 1, uRight = node.m_uOffset;
+            const simd4f tMax = simd4f::load(packet.m_fMax);
+            simd4f nearLeft, nearRight;
+            uint32_t uLeftMask = uMask & intersectSlabsPacket(m_nodes[uLeft].m_boundingBox, rays, tMax, nearLeft);
+            uint32_t uRightMask = uMask & intersectSlabsPacket(m_nodes[uRight].m_boundingBox, rays, tMax, nearRight);
+            if (uLeftMask != 0 && uRightMask != 0)
+            {
+                // Visit first the child that is nearer for most of the lanes hitting both
+                const uint32_t uBoth = uLeftMask & uRightMask;
+                const uint32_t uRightNearer = uBoth & static_cast<uint32_t>(movemask(nearRight < nearLeft));
+                if (std::popcount(uRightNearer) * 2 > std::popcount(uBoth))
+                {
+                    std::swap(uLeft, uRight);
+                    std::swap(uLeftMask, uRightMask);
+                    std::swap(nearLeft, nearRight);
+                }
+                assert(stackSize < MAX_TRAVERSAL_STACK);
+                stack[stackSize++] = { nearRight, uRight, uRightMask };
+                uCur = uLeft;
+                uMask = uLeftMask;
+                continue;
+            }
+            if (uLeftMask != 0 || uRightMask != 0)
+            {
+                uCur = (uLeftMask != 0) ? uLeft : uRight;
+                uMask = uLeftMask | uRightMask;
+                continue;
+            }
+        }
+
+        // Pop deferred nodes, dropping lanes whose closest hit is already nearer than the node
+        for (;;)
+        {
+            if (stackSize == 0)
+                return;
+            const StackEntry& entry = stack[--stackSize];
+            uMask = entry.m_uLaneMask & static_cast<uint32_t>(movemask(entry.m_near <= simd4f::load(packet.m_fMax)));
+            if (uMask != 0)
+            {
+                uCur = entry.m_uNode;
+                break;
+            }
+        }
     }
+}
+
+void BVH::findClosestPoint(IPointQuery& query, uint32_t uSubObj) const
+{
+    assert(!m_nodes.empty() && uSubObj == 0);
+
+    struct StackEntry
+    {
+        uint32_t m_uNode;
+        float m_fDistSq;
+    };
+    StackEntry stack[MAX_TRAVERSAL_STACK];
+    int stackSize = 0;
+
+    if (boxDistanceSq(m_nodes[0].m_boundingBox, query.m_vPos) > query.m_fMaxDistSq)
+        return;
+
+    uint32_t uCur = 0;
+    for (;;)
+    {
+        const Node& node = m_nodes[uCur];
+        if (node.isLeaf())
+        {
+            const uint32_t uEnd = node.m_uOffset + node.m_nSubObjects;
+            for (uint32_t i = node.m_uOffset; i < uEnd; ++i)
+            {
+                if (boxDistanceSq(m_subObjectBoxes[i], query.m_vPos) <= query.m_fMaxDistSq)
+                {
+                    const SubObj& subObj = m_subObjects[i];
+                    subObj.pObj->findClosestPoint(query, subObj.m_uSubObj);
+                }
+            }
+        }
+        else
+        {
+            uint32_t uLeft = uCur + 1, uRight = node.m_uOffset;
+            float fLeft = boxDistanceSq(m_nodes[uLeft].m_boundingBox, query.m_vPos);
+            float fRight = boxDistanceSq(m_nodes[uRight].m_boundingBox, query.m_vPos);
+            const bool hitLeft = fLeft <= query.m_fMaxDistSq;
+            const bool hitRight = fRight <= query.m_fMaxDistSq;
+            if (hitLeft && hitRight)
+            {
+                if (fRight < fLeft)
+                {
+                    std::swap(uLeft, uRight);
+                    std::swap(fLeft, fRight);
+                }
+                assert(stackSize < MAX_TRAVERSAL_STACK);
+                stack[stackSize++] = { uRight, fRight };
+                uCur = uLeft;
+                continue;
+            }
+            if (hitLeft || hitRight)
+            {
+                uCur = hitLeft ? uLeft : uRight;
+                continue;
+            }
+        }
+
+        // Pop deferred nodes that can still contain something closer
+        for (;;)
+        {
+            if (stackSize == 0)
+                return;
+            const StackEntry& entry = stack[--stackSize];
+            if (entry.m_fDistSq <= query.m_fMaxDistSq)
+            {
+                uCur = entry.m_uNode;
+                break;
+            }
+        }
+    }
+}
+
+void BVH::findOverlaps(const BVH& other, const float3& vOtherOffset, float fMargin, std::vector<SubObjectPair>& pairs) const
+{
+    pairs.clear();
+    if (m_nodes.empty() || other.m_nodes.empty())
+        return;
+
+    // Every split pushes one pair and goes on with the other, and each split descends one level of
+    // one of the trees
+    struct StackEntry
+    {
+        uint32_t m_uNode;
+        uint32_t m_uOtherNode;
+    };
+    StackEntry stack[2 * MAX_TRAVERSAL_STACK];
+    int stackSize = 0;
+
+    // Growing the boxes of this tree by twice the margin is the same test as growing both by it
+    const float fGrowth = 2.0f * fMargin;
+    auto overlaps = [&](const box3& box, const box3& otherBox)
+    {
+        return box.grow(fGrowth).intersects(otherBox.translate(vOtherOffset));
+    };
+
+    uint32_t uCur = 0, uOtherCur = 0;
+    if (!overlaps(m_nodes[0].m_boundingBox, other.m_nodes[0].m_boundingBox))
+        return;
+    for (;;)
+    {
+        const Node& node = m_nodes[uCur];
+        const Node& otherNode = other.m_nodes[uOtherCur];
+        if (node.isLeaf() && otherNode.isLeaf())
+        {
+            for (uint32_t i = node.m_uOffset; i < node.m_uOffset + node.m_nSubObjects; ++i)
+            {
+                for (uint32_t j = otherNode.m_uOffset; j < otherNode.m_uOffset + otherNode.m_nSubObjects; ++j)
+                {
+                    if (overlaps(m_subObjectBoxes[i], other.m_subObjectBoxes[j]))
+                    {
+                        pairs.push_back({ m_subObjects[i].pObj, m_subObjects[i].m_uSubObj,
+                                          other.m_subObjects[j].pObj, other.m_subObjects[j].m_uSubObj });
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Split the inner node with the larger box (the only inner one if the other is a leaf)
+            const bool bSplitThis = !node.isLeaf()
+                && (otherNode.isLeaf() || halfSurfaceArea(node.m_boundingBox) >= halfSurfaceArea(otherNode.m_boundingBox));
+            StackEntry children[2];
+            if (bSplitThis)
+            {
+                children[0] = { uCur + 1, uOtherCur };
+                children[1] = { node.m_uOffset, uOtherCur };
+            }
+            else
+            {
+                children[0] = { uCur, uOtherCur + 1 };
+                children[1] = { uCur, otherNode.m_uOffset };
+            }
+            const bool hit0 = overlaps(m_nodes[children[0].m_uNode].m_boundingBox, other.m_nodes[children[0].m_uOtherNode].m_boundingBox);
+            const bool hit1 = overlaps(m_nodes[children[1].m_uNode].m_boundingBox, other.m_nodes[children[1].m_uOtherNode].m_boundingBox);
+            if (hit0 && hit1)
+            {
+                assert(stackSize < 2 * MAX_TRAVERSAL_STACK);
+                stack[stackSize++] = children[1];
+            }
+            if (hit0 || hit1)
+            {
+                const StackEntry& next = hit0 ? children[0] : children[1];
+                uCur = next.m_uNode;
+                uOtherCur = next.m_uOtherNode;
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
+            return;
+        const StackEntry& entry = stack[--stackSize];
+        uCur = entry.m_uNode;
+        uOtherCur = entry.m_uOtherNode;
+    }
+}
+
+void BVH::traceBatch(const std::vector<RayQuery>& rays, std::vector<RayHit>& hits) const
+{
+    hits.assign(rays.size(), RayHit());
+    if (m_nodes.empty())
+        return;
+
+    RayPacket packet;
+    for (size_t uFirst = 0; uFirst < rays.size(); uFirst += RayPacket::WIDTH)
+    {
+        const uint32_t nRays = static_cast<uint32_t>(std::min<size_t>(RayPacket::WIDTH, rays.size() - uFirst));
+        packet.load(&rays[uFirst], nRays);
+        tracePacket(packet, 0, packet.m_uLaneMask);
+        for (uint32_t uLane = 0; uLane < nRays; ++uLane)
+        {
+            hits[uFirst + uLane] = packet.getHit(uLane);
+        }
+    }
+}
+
+void BVH::rebuildHierarchy()
+{
+    m_nodes.clear();
+    m_subObjects.clear();
+    m_subObjectBoxes.clear();
+    m_pSingleObject = nullptr;
+    m_leafSubObjects.clear();
+    m_fBuildSAHCost = 0.0f;
 
-    // Expand all objects into their sub-objects
-    std::vector<SubObj> subObjects;
-    
     // Calculate total number of sub-objects to reserve space
     size_t totalSubObjects = 0;
     for (auto pObject : m_pObjects)
@@ -53,8 +501,16 @@ void BVH::rebuildHierarchy()
             totalSubObjects += pObject->m_nSubObjects;
         }
     }
+    if (totalSubObjects == 0)
+        return;
+
+    // Expand all objects into their sub-objects; sub-object boxes are queried once here
+    std::vector<SubObj> subObjects;
+    std::vector<box3> subObjectBoxes;
     subObjects.reserve(totalSubObjects);
-    
+    subObjectBoxes.reserve(totalSubObjects);
+    m_buildCentroids.clear();
+    m_buildCentroids.reserve(totalSubObjects);
     for (auto pObject : m_pObjects)
     {
         if (pObject != nullptr && pObject->m_nSubObjects > 0)
@@ -65,134 +521,264 @@ void BVH::rebuildHierarchy()
                 subObj.pObj = pObject.get();
                 subObj.m_uSubObj = i;
                 subObjects.push_back(subObj);
+                subObjectBoxes.push_back(pObject->getSubObjectBox(i));
+                m_buildCentroids.push_back(subObjectBoxes.back().center());
             }
         }
     }
 
-    if (subObjects.empty())
+    const uint32_t n = static_cast<uint32_t>(subObjects.size());
+    m_buildOrder.resize(n);
+    std::iota(m_buildOrder.begin(), m_buildOrder.end(), 0u);
+
+    // Assign boxes in original order so buildNode can look them up through m_buildOrder
+    m_subObjectBoxes = std::move(subObjectBoxes);
+    m_nodes.reserve(2 * static_cast<size_t>(n));
+
+    // Fork tasks only near the root: enough levels to give every hardware thread a subtree
+    int parallelDepth = 0;
+    if (m_nParallelBuildThreshold > 0 && n >= m_nParallelBuildThreshold)
+    {
+        const uint32_t nThreads = std::max(1u, std::thread::hardware_concurrency());
+        parallelDepth = std::bit_width(nThreads - 1) + 1;
+    }
+    buildNode(m_nodes, 0, n, 0, parallelDepth);
+
+    // Reorder sub-objects and their boxes so that every leaf references a contiguous range
+    std::vector<box3> orderedBoxes(n);
+    m_subObjects.resize(n);
+    for (uint32_t i = 0; i < n; ++i)
     {
-        m_pRoot = nullptr;
-        return;
+        m_subObjects[i] = subObjects[m_buildOrder[i]];
+        orderedBoxes[i] = m_subObjectBoxes[m_buildOrder[i]];
     }
+    m_subObjectBoxes = std::move(orderedBoxes);
 
-    // Build the tree recursively
-    m_pRoot = buildNode(subObjects, 0);
-}
-
-bool BVH::rayIntersectsBox(const IRay& ray, const box3& box) const
-{
-    float tNear, tFar;
-    if (!intersectRayAABB<float, 3>(ray.m_vPos, ray.m_vDir, box, tNear, tFar))
-        return false;
-    // Check if intersection interval overlaps the ray's active range
-    return tFar >= ray.m_fMin && tNear <= ray.m_fMax;
-}
-
-std::unique_ptr<BVH::Node> BVH::buildNode(std::vector<SubObj>& subObjects, int depth)
-{
-    auto node = std::make_unique<Node>();
-    
-    // Calculate bounding box for this node
-    node->m_boundingBox = calculateBoundingBox(subObjects);
-    
-    // Leaf node criteria: few objects or max depth reached
-    const int MAX_LEAF_OBJECTS = 4;
-    const int MAX_DEPTH = 20;
-    
-    if (subObjects.size() <= MAX_LEAF_OBJECTS || depth >= MAX_DEPTH)
-    {
-        // Create leaf node
-        node->m_pSubObjects = subObjects;
-        return node;
-    }
-    
-    // Split objects along longest axis
-    int axis = getLongestAxis(node->m_boundingBox);
-    
-    // Sort sub-objects by their center position along the split axis
-    std::sort(subObjects.begin(), subObjects.end(), [axis](const SubObj& a, const SubObj& b) {
-        box3 boxA = a.pObj->getSubObjectBox(a.m_uSubObj);
-        box3 boxB = b.pObj->getSubObjectBox(b.m_uSubObj);
-        float3 centerA = (boxA.m_mins + boxA.m_maxs) * 0.5f;
-        float3 centerB = (boxB.m_mins + boxB.m_maxs) * 0.5f;
-        return centerA[axis] < centerB[axis];
-    });
-    
-    // Split at median
-    size_t mid = subObjects.size() / 2;
-    std::vector<SubObj> leftObjects(subObjects.begin(), subObjects.begin() + mid);
-    std::vector<SubObj> rightObjects(subObjects.begin() + mid, subObjects.end());
-    
-    // Recursively build child nodes
-    node->m_pLeft = buildNode(leftObjects, depth + 1);
-    node->m_pRight = buildNode(rightObjects, depth + 1);
-    
-    return node;
-}
-
-void BVH::traceNode(IRay& ray, const Node* node) const
-{
-    if (node == nullptr)
-        return;
-        
-    // Check if ray intersects this node's bounding box
-    if (!rayIntersectsBox(ray, node->m_boundingBox))
-        return;
-    
-    if (node->isLeaf())
+    const bool bSingleObject = std::all_of(m_subObjects.begin(), m_subObjects.end(),
+        [&](const SubObj& subObj) { return subObj.pObj == m_subObjects[0].pObj; });
+    if (bSingleObject)
     {
-        // Leaf node - test all sub-objects
-        for (const SubObj& subObj : node->m_pSubObjects)
+        m_pSingleObject = m_subObjects[0].pObj;
+        m_leafSubObjects.resize(n);
+        for (uint32_t i = 0; i < n; ++i)
         {
-            if (subObj.pObj != nullptr)
+            m_leafSubObjects[i] = m_subObjects[i].m_uSubObj;
+        }
+    }
+
+    m_fBuildSAHCost = computeSAHCost();
+}
+
+void BVH::refit()
+{
+    assert(m_subObjects.size() == m_subObjectBoxes.size());
+    for (size_t i = 0; i < m_subObjects.size(); ++i)
+    {
+        const SubObj& subObj = m_subObjects[i];
+        m_subObjectBoxes[i] = subObj.pObj->getSubObjectBox(subObj.m_uSubObj);
+    }
+
+    // Children are always stored after their parent, so a reverse sweep updates bottom-up
+    for (size_t u = m_nodes.size(); u-- > 0; )
+    {
+        Node& node = m_nodes[u];
+        if (node.isLeaf())
+        {
+            box3 leafBox = box3::empty();
+            const uint32_t uEnd = node.m_uOffset + node.m_nSubObjects;
+            for (uint32_t i = node.m_uOffset; i < uEnd; ++i)
             {
-                // Test the bounding box of this specific sub-object first
-                box3 subObjBox = subObj.pObj->getSubObjectBox(subObj.m_uSubObj);
-                if (rayIntersectsBox(ray, subObjBox))
-                {
-                    // Let the object handle ray tracing for this specific sub-object
-                    // The object's trace method should internally check which sub-objects to test
-                    subObj.pObj->trace(ray, subObj.m_uSubObj);
-                }
+                leafBox = leafBox | m_subObjectBoxes[i];
             }
+            node.m_boundingBox = leafBox;
+        }
+        else
+        {
+            node.m_boundingBox = m_nodes[u + 1].m_boundingBox | m_nodes[node.m_uOffset].m_boundingBox;
         }
     }
-    else
+}
+
+float BVH::computeSAHCost() const
+{
+    if (m_nodes.empty())
+        return 0.0f;
+    const float rootArea = std::max(halfSurfaceArea(m_nodes[0].m_boundingBox), 1e-20f);
+    double cost = 0.0;
+    for (const Node& node : m_nodes)
     {
-        // Internal node - recursively traverse children
-        traceNode(ray, node->m_pLeft.get());
-        traceNode(ray, node->m_pRight.get());
+        const double area = halfSurfaceArea(node.m_boundingBox);
+        cost += area * (node.isLeaf() ? SAH_INTERSECTION_COST * node.m_nSubObjects : SAH_TRAVERSAL_COST);
     }
+    return static_cast<float>(cost / rootArea);
 }
 
-box3 BVH::calculateBoundingBox(const std::vector<SubObj>& subObjects)
+uint32_t BVH::buildNode(std::vector<Node>& nodes, uint32_t uBegin, uint32_t uEnd, int depth, int parallelDepth)
 {
-    if (subObjects.empty())
-        return box3();
-    
-    box3 result = subObjects[0].pObj->getSubObjectBox(subObjects[0].m_uSubObj);
-    
-    for (size_t i = 1; i < subObjects.size(); ++i)
+    const uint32_t uNode = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(Node());
+
+    box3 nodeBox = box3::empty();
+    for (uint32_t i = uBegin; i < uEnd; ++i)
     {
-        if (subObjects[i].pObj != nullptr)
+        nodeBox = nodeBox | m_subObjectBoxes[m_buildOrder[i]];
+    }
+
+    const uint32_t nObjects = uEnd - uBegin;
+    uint32_t uMid = uBegin;
+    if (nObjects > MAX_LEAF_OBJECTS && depth < MAX_DEPTH)
+    {
+        if (m_buildStrategy == BuildStrategy::MEDIAN)
+        {
+            box3 centroidBox = box3::empty();
+            for (uint32_t i = uBegin; i < uEnd; ++i)
+            {
+                centroidBox = centroidBox | m_buildCentroids[m_buildOrder[i]];
+            }
+            const float3 extent = centroidBox.m_maxs - centroidBox.m_mins;
+            const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+            uMid = partitionMedian(uBegin, uEnd, axis);
+        }
+        else
         {
-            result = result | subObjects[i].pObj->getSubObjectBox(subObjects[i].m_uSubObj);
+            uMid = partitionSAH(uBegin, uEnd, nodeBox);
         }
     }
-    
-    return result;
-}
 
+    if (uMid == uBegin || uMid == uEnd)
+    {
+        nodes[uNode] = Node{ nodeBox, uBegin, nObjects };
+        return uNode;
+    }
 
+    // Left child is built right after its parent, so only the right child offset is stored
+    uint32_t uRight;
+    if (depth < parallelDepth && nObjects >= m_nParallelBuildThreshold)
+    {
+        // The children cover disjoint ranges of m_buildOrder, so both can be partitioned concurrently.
+        // The right subtree goes to its own array that is appended after the left one, which gives
+        // exactly the serial layout.
+        std::vector<Node> rightNodes;
+        rightNodes.reserve(2 * static_cast<size_t>(uEnd - uMid));
+        auto rightTask = std::async(std::launch::async, [&]() {
+            buildNode(rightNodes, uMid, uEnd, depth + 1, parallelDepth);
+        });
+        buildNode(nodes, uBegin, uMid, depth + 1, parallelDepth);
+        rightTask.get();
 
-int BVH::getLongestAxis(const box3& box)
-{
-    float3 extent = box.m_maxs - box.m_mins;
-    
-    if (extent.x >= extent.y && extent.x >= extent.z)
-        return 0; // X axis
-    else if (extent.y >= extent.z)
-        return 1; // Y axis
+        uRight = static_cast<uint32_t>(nodes.size());
+        for (Node& node : rightNodes)
+        {
+            if (!node.isLeaf())
+                node.m_uOffset += uRight;
+        }
+        nodes.insert(nodes.end(), rightNodes.begin(), rightNodes.end());
+    }
     else
-        return 2; // Z axis
+    {
+        buildNode(nodes, uBegin, uMid, depth + 1, parallelDepth);
+        uRight = buildNode(nodes, uMid, uEnd, depth + 1, parallelDepth);
+    }
+    nodes[uNode] = Node{ nodeBox, uRight, 0 };
+    return uNode;
+}
+
+uint32_t BVH::partitionMedian(uint32_t uBegin, uint32_t uEnd, int axis)
+{
+    const uint32_t uMid = uBegin + (uEnd - uBegin) / 2;
+    std::nth_element(m_buildOrder.begin() + uBegin, m_buildOrder.begin() + uMid, m_buildOrder.begin() + uEnd,
+        [&](uint32_t a, uint32_t b) { return m_buildCentroids[a][axis] < m_buildCentroids[b][axis]; });
+    return uMid;
+}
+
+uint32_t BVH::partitionSAH(uint32_t uBegin, uint32_t uEnd, const box3& nodeBox)
+{
+    box3 centroidBox = box3::empty();
+    for (uint32_t i = uBegin; i < uEnd; ++i)
+    {
+        centroidBox = centroidBox | m_buildCentroids[m_buildOrder[i]];
+    }
+
+    struct Bin
+    {
+        box3 m_box = box3::empty();
+        uint32_t m_nObjects = 0;
+    };
+
+    const float parentArea = std::max(halfSurfaceArea(nodeBox), 1e-20f);
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float cMin = centroidBox.m_mins[axis];
+        const float extent = centroidBox.m_maxs[axis] - cMin;
+        if (extent <= 0.0f)
+            continue;
+        const float binScale = SAH_BIN_COUNT / extent;
+
+        Bin bins[SAH_BIN_COUNT];
+        for (uint32_t i = uBegin; i < uEnd; ++i)
+        {
+            const uint32_t uObj = m_buildOrder[i];
+            const uint32_t b = std::min(SAH_BIN_COUNT - 1,
+                static_cast<uint32_t>((m_buildCentroids[uObj][axis] - cMin) * binScale));
+            bins[b].m_box = bins[b].m_box | m_subObjectBoxes[uObj];
+            ++bins[b].m_nObjects;
+        }
+
+        // Sweep from the right to get area/count of every right-hand partition
+        float rightArea[SAH_BIN_COUNT];
+        uint32_t rightCount[SAH_BIN_COUNT];
+        box3 accBox = box3::empty();
+        uint32_t accCount = 0;
+        for (uint32_t b = SAH_BIN_COUNT - 1; b > 0; --b)
+        {
+            accBox = accBox | bins[b].m_box;
+            accCount += bins[b].m_nObjects;
+            rightArea[b] = halfSurfaceArea(accBox);
+            rightCount[b] = accCount;
+        }
+
+        // Sweep from the left and evaluate the split in front of every bin
+        accBox = box3::empty();
+        accCount = 0;
+        for (uint32_t b = 1; b < SAH_BIN_COUNT; ++b)
+        {
+            accBox = accBox | bins[b - 1].m_box;
+            accCount += bins[b - 1].m_nObjects;
+            if (accCount == 0 || rightCount[b] == 0)
+                continue;
+            const float cost = SAH_TRAVERSAL_COST + SAH_INTERSECTION_COST *
+                (halfSurfaceArea(accBox) * accCount + rightArea[b] * rightCount[b]) / parentArea;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    uint32_t uMid = uBegin;
+    if (bestAxis >= 0)
+    {
+        const float cMin = centroidBox.m_mins[bestAxis];
+        const float binScale = SAH_BIN_COUNT / (centroidBox.m_maxs[bestAxis] - cMin);
+        auto it = std::partition(m_buildOrder.begin() + uBegin, m_buildOrder.begin() + uEnd,
+            [&](uint32_t uObj) {
+                const uint32_t b = std::min(SAH_BIN_COUNT - 1,
+                    static_cast<uint32_t>((m_buildCentroids[uObj][bestAxis] - cMin) * binScale));
+                return b < bestSplit;
+            });
+        uMid = static_cast<uint32_t>(it - m_buildOrder.begin());
+    }
+
+    // Coincident centroids (or a degenerate partition): fall back to an object-median split
+    if (uMid == uBegin || uMid == uEnd)
+    {
+        uMid = partitionMedian(uBegin, uEnd, (bestAxis >= 0) ? bestAxis : 0);
+    }
+    return uMid;
 }
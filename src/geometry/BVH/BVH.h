@@ -10,14 +10,71 @@ class BVH : public ITraceableObject
 {
 public:
     BVH();
-    
+
     std::vector<std::shared_ptr<ITraceableObject>>& accessObjects();
+    // Substitute an object with an equivalent one (same sub-objects and boxes) without rebuilding,
+    // e.g. when a copied BVH must reference the copy of its owner
+    void replaceObject(const ITraceableObject* pOld, std::shared_ptr<ITraceableObject> pNew);
+
+    enum class BuildStrategy
+    {
+        BINNED_SAH,     // surface area heuristic over binned centroids (default)
+        MEDIAN          // object median along the widest centroid axis
+    };
+    void setBuildStrategy(BuildStrategy strategy) { m_buildStrategy = strategy; }
+    BuildStrategy getBuildStrategy() const { return m_buildStrategy; }
+
+    // Subtrees with at least this many sub-objects are built as parallel tasks; 0 builds serially.
+    // The resulting tree is identical for any thread count.
+    void setParallelBuildThreshold(uint32_t nSubObjects) { m_nParallelBuildThreshold = nSubObjects; }
 
     // Build/rebuild the BVH hierarchy
     void rebuildHierarchy();
-    
+
+    // Keep the tree topology and recompute sub-object and node bounds bottom-up in one linear pass.
+    // Valid only while the set of objects and their sub-object counts are unchanged; nested BVHs
+    // must be refitted before their parent.
+    void refit();
+
+    // Surface area heuristic cost of the current tree (relative to the root box), and the cost
+    // right after the last full rebuild. Their ratio measures how much refitting degraded the tree.
+    float computeSAHCost() const;
+    float getBuildSAHCost() const { return m_fBuildSAHCost; }
+
+    // Closest-hit queries for many rays at once. Consecutive rays are traversed together as
+    // packets of RayPacket::WIDTH, so rays with similar origin and direction should be adjacent.
+    // hits[i] receives the closest hit of rays[i].
+    void traceBatch(const std::vector<RayQuery>& rays, std::vector<RayHit>& hits) const;
+
+    // Sub-objects of this BVH and of other whose boxes overlap, with other moved by vOtherOffset
+    // and every box of both grown by fMargin. Both trees are descended at once, always splitting the
+    // larger of the two current nodes, so only overlapping subtrees are visited.
+    struct SubObjectPair
+    {
+        const ITraceableObject* m_pObj;
+        uint32_t m_uSubObj;
+        const ITraceableObject* m_pOtherObj;
+        uint32_t m_uOtherSubObj;
+    };
+    void findOverlaps(const BVH& other, const float3& vOtherOffset, float fMargin, std::vector<SubObjectPair>& pairs) const;
+
+    // Sub-objects in leaf order: every leaf references a contiguous range of positions.
+    // Objects traced by this BVH can lay out per-sub-object data in the same order.
+    uint32_t getLeafOrderSize() const { return static_cast<uint32_t>(m_subObjects.size()); }
+    uint32_t getLeafOrderSubObject(uint32_t uPos) const { return m_subObjects[uPos].m_uSubObj; }
+    // True if pSubObjs was passed to traceLeaf() by this BVH (it points into its leaf order)
+    bool isOwnLeafRange(const uint32_t* pSubObjs) const
+    {
+        return !m_leafSubObjects.empty() && pSubObjs >= m_leafSubObjects.data()
+            && pSubObjs < m_leafSubObjects.data() + m_leafSubObjects.size();
+    }
+
     // ITraceableObject interface
     void trace(IRay& ray, uint32_t uSubObj) const override;
+    void tracePacket(RayPacket& packet, uint32_t uSubObj, uint32_t uLaneMask) const override;
+    // Branch-and-bound nearest sub-object search: nearer children first, nodes farther than the
+    // closest distance found so far are skipped
+    void findClosestPoint(IPointQuery& query, uint32_t uSubObj) const override;
     virtual box3 getBox() const override;
     virtual box3 getSubObjectBox(uint32_t uSubObj) const override;
 
@@ -27,24 +84,38 @@ private:
         ITraceableObject* pObj;
         uint32_t m_uSubObj;
     };
+    // Nodes are stored depth-first in one array: the left child of an inner node
+    // immediately follows it, the right child is at m_uOffset. For leaves m_uOffset is
+    // the first index into m_subObjects and m_nSubObjects the number of sub-objects.
     struct Node
     {
         box3 m_boundingBox;
-        std::unique_ptr<Node> m_pLeft;
-        std::unique_ptr<Node> m_pRight;
-        std::vector<SubObj> m_pSubObjects;  // Only used for leaf nodes
-        
-        bool isLeaf() const { return m_pLeft == nullptr && m_pRight == nullptr; }
+        uint32_t m_uOffset;
+        uint32_t m_nSubObjects;  // 0 for inner nodes
+
+        bool isLeaf() const { return m_nSubObjects != 0; }
     };
+    static_assert(sizeof(Node) == 32, "BVH::Node is expected to be 32 bytes");
 
     std::vector<std::shared_ptr<ITraceableObject>> m_pObjects;
-    std::unique_ptr<Node> m_pRoot;
-
-    // Helper methods
-    bool rayIntersectsBox(const IRay& ray, const box3& box) const;
-    std::unique_ptr<Node> buildNode(std::vector<SubObj>& subObjects, int depth = 0);
-    void traceNode(IRay& ray, const Node* node) const;
-    box3 calculateBoundingBox(const std::vector<SubObj>& subObjects);
-    int getLongestAxis(const box3& box);
-};
+    std::vector<Node> m_nodes;
+    std::vector<SubObj> m_subObjects;     // reordered so every leaf references a contiguous range
+    std::vector<box3> m_subObjectBoxes;   // bounding boxes matching m_subObjects
+    // Set when all sub-objects belong to one object; leaves are then traced with one traceLeaf() call
+    const ITraceableObject* m_pSingleObject = nullptr;
+    std::vector<uint32_t> m_leafSubObjects; // sub-object indices matching m_subObjects (single object only)
+    float m_fBuildSAHCost = 0.0f;
+
+    BuildStrategy m_buildStrategy = BuildStrategy::BINNED_SAH;
+    uint32_t m_nParallelBuildThreshold = 4096;
 
+    // Build scratch (per sub-object centroids and ordering)
+    std::vector<float3> m_buildCentroids;
+    std::vector<uint32_t> m_buildOrder;
+
+    // Helper methods. buildNode appends the subtree over m_buildOrder[uBegin, uEnd) to nodes and
+    // returns its index there; subtrees handled by separate tasks go to their own node arrays.
+    uint32_t buildNode(std::vector<Node>& nodes, uint32_t uBegin, uint32_t uEnd, int depth, int parallelDepth);
+    uint32_t partitionSAH(uint32_t uBegin, uint32_t uEnd, const box3& nodeBox);
+    uint32_t partitionMedian(uint32_t uBegin, uint32_t uEnd, int axis);
+};
@@ -3,11 +3,14 @@
 #include <memory>
 #include <cstdint>
 #include "geometry/vectors/box.h"
+#include "RayPacket.h"
 
 // Forward declarations
 struct ITraceableObject;
 struct IRay;
 
+// Active range is [m_fMin, m_fMax]. Closest-hit queries should shrink m_fMax inside
+// notifyIntersection: traversal re-reads it and culls everything farther away.
 struct IRay
 {
     float3 m_vPos;
@@ -16,6 +19,15 @@ struct IRay
     virtual void notifyIntersection(float fDist, const ITraceableObject *pObject, uint32_t uSubObj) = 0;
 };
 
+// Nearest sub-object query around m_vPos. Only sub-objects closer than sqrt(m_fMaxDistSq) are
+// reported; notifyClosestPoint should shrink m_fMaxDistSq so that farther nodes are culled.
+struct IPointQuery
+{
+    float3 m_vPos;
+    float m_fMaxDistSq;
+    virtual void notifyClosestPoint(float fDistSq, const ITraceableObject* pObject, uint32_t uSubObj) = 0;
+};
+
 // Can represent triangular mesh for example where every
 // sub-object is a triangle. Must have at least one sub-object
 struct ITraceableObject : std::enable_shared_from_this<ITraceableObject>
@@ -29,6 +41,49 @@ struct ITraceableObject : std::enable_shared_from_this<ITraceableObject>
     virtual box3 getSubObjectBox(uint32_t uSubObj) const = 0;
     
     virtual void trace(IRay& ray, uint32_t uSubObj) const = 0;
+
+    // Report the distance from query.m_vPos to a sub-object. Objects without a distance test
+    // keep the default and are ignored by point queries.
+    virtual void findClosestPoint(IPointQuery& query, uint32_t uSubObj) const { }
+
+    // Trace all sub-objects of one BVH leaf. A BVH built over this object alone calls this instead
+    // of trace() per sub-object; the default traces them one by one.
+    virtual void traceLeaf(IRay& ray, const uint32_t* pSubObjs, uint32_t nSubObjs) const
+    {
+        for (uint32_t i = 0; i < nSubObjs; ++i)
+            trace(ray, pSubObjs[i]);
+    }
+
+    // Trace the packet lanes selected by uLaneMask against a sub-object. The default forwards
+    // each lane to trace(); objects with a vectorized intersection test override it.
+    virtual void tracePacket(RayPacket& packet, uint32_t uSubObj, uint32_t uLaneMask) const;
     
     virtual ~ITraceableObject() = default;
-}; 
\ No newline at end of file
+};
+
+inline void ITraceableObject::tracePacket(RayPacket& packet, uint32_t uSubObj, uint32_t uLaneMask) const
+{
+    struct LaneRay : IRay
+    {
+        RayPacket* m_pPacket;
+        uint32_t m_uLane;
+        void notifyIntersection(float fDist, const ITraceableObject* pObject, uint32_t uHitSubObj) override
+        {
+            m_pPacket->reportHit(m_uLane, fDist, pObject, uHitSubObj);
+            m_fMax = m_pPacket->m_fMax[m_uLane];
+        }
+    };
+    for (uint32_t uLane = 0; uLane < RayPacket::WIDTH; ++uLane)
+    {
+        if (!(uLaneMask & (1u << uLane)))
+            continue;
+        LaneRay ray;
+        ray.m_pPacket = &packet;
+        ray.m_uLane = uLane;
+        ray.m_vPos = packet.getPos(uLane);
+        ray.m_vDir = packet.getDir(uLane);
+        ray.m_fMin = packet.m_fMin[uLane];
+        ray.m_fMax = packet.m_fMax[uLane];
+        trace(ray, uSubObj);
+    }
+} 
\ No newline at end of file
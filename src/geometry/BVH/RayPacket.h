@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include "geometry/vectors/vector.h"
+
+struct ITraceableObject;
+
+// Input of a batched closest-hit query. Active range is [m_fMin, m_fMax].
+struct RayQuery
+{
+    float3 m_vPos;
+    float3 m_vDir;
+    float m_fMin = 0.0f;
+    float m_fMax = std::numeric_limits<float>::max();
+};
+
+// Closest hit of a batched query; m_pObject is null when the ray missed
+struct RayHit
+{
+    float m_fDist = std::numeric_limits<float>::max();
+    uint32_t m_uSubObj = UINT32_MAX;
+    const ITraceableObject* m_pObject = nullptr;
+
+    bool isHit() const { return m_pObject != nullptr; }
+};
+
+// Rays traversed together as one packet. Components are stored structure-of-arrays so that one
+// SIMD register holds the same component of all lanes. m_fMax of a lane shrinks to the closest
+// hit found so far, which culls everything farther away exactly like IRay::m_fMax.
+struct alignas(16) RayPacket
+{
+    static constexpr uint32_t WIDTH = 4;
+    static constexpr uint32_t ALL_LANES = (1u << WIDTH) - 1;
+
+    float m_posX[WIDTH], m_posY[WIDTH], m_posZ[WIDTH];
+    float m_dirX[WIDTH], m_dirY[WIDTH], m_dirZ[WIDTH];
+    float m_invDirX[WIDTH], m_invDirY[WIDTH], m_invDirZ[WIDTH];
+    float m_fMin[WIDTH], m_fMax[WIDTH];
+    uint32_t m_uHitSubObj[WIDTH];
+    const ITraceableObject* m_pHitObject[WIDTH];
+    uint32_t m_uLaneMask = 0;  // bit i is set if lane i holds a ray
+
+    // Fill lanes from rays[0..nRays) (nRays <= WIDTH); unused lanes are masked out
+    void load(const RayQuery* pRays, uint32_t nRays)
+    {
+        m_uLaneMask = 0;
+        for (uint32_t i = 0; i < WIDTH; ++i)
+        {
+            const bool bUsed = i < nRays;
+            const RayQuery ray = bUsed ? pRays[i] : RayQuery{ float3(0, 0, 0), float3(1, 0, 0), 0.0f, -1.0f };
+            m_posX[i] = ray.m_vPos.x; m_posY[i] = ray.m_vPos.y; m_posZ[i] = ray.m_vPos.z;
+            m_dirX[i] = ray.m_vDir.x; m_dirY[i] = ray.m_vDir.y; m_dirZ[i] = ray.m_vDir.z;
+            m_invDirX[i] = invComponent(ray.m_vDir.x);
+            m_invDirY[i] = invComponent(ray.m_vDir.y);
+            m_invDirZ[i] = invComponent(ray.m_vDir.z);
+            m_fMin[i] = ray.m_fMin;
+            m_fMax[i] = ray.m_fMax;
+            m_uHitSubObj[i] = UINT32_MAX;
+            m_pHitObject[i] = nullptr;
+            if (bUsed)
+                m_uLaneMask |= 1u << i;
+        }
+    }
+
+    float3 getPos(uint32_t uLane) const { return float3(m_posX[uLane], m_posY[uLane], m_posZ[uLane]); }
+    float3 getDir(uint32_t uLane) const { return float3(m_dirX[uLane], m_dirY[uLane], m_dirZ[uLane]); }
+
+    // Record a hit if it is the closest one for the lane so far
+    void reportHit(uint32_t uLane, float fDist, const ITraceableObject* pObject, uint32_t uSubObj)
+    {
+        if (fDist >= m_fMin[uLane] && fDist <= m_fMax[uLane])
+        {
+            m_fMax[uLane] = fDist;
+            m_pHitObject[uLane] = pObject;
+            m_uHitSubObj[uLane] = uSubObj;
+        }
+    }
+
+    RayHit getHit(uint32_t uLane) const
+    {
+        RayHit hit;
+        if (m_pHitObject[uLane])
+        {
+            hit.m_fDist = m_fMax[uLane];
+            hit.m_uSubObj = m_uHitSubObj[uLane];
+            hit.m_pObject = m_pHitObject[uLane];
+        }
+        return hit;
+    }
+
+private:
+    // Same convention as the single-ray traversal: near-zero components map to a large finite
+    // value so slab distances never become inf * 0 = NaN
+    static float invComponent(float d)
+    {
+        const float BIG = 1e30f;
+        return (std::abs(d) > std::numeric_limits<float>::epsilon()) ? 1.0f / d : (d >= 0.0f ? BIG : -BIG);
+    }
+};
@@ -0,0 +1,177 @@
+#include "BVHBenchmark.h"
+#include "BVHMesh.h"
+#include "BVHCache.h"
+#include "geometry/mesh/MeshHierarchy.h"
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace {
+    struct ClosestHitRay : IRay
+    {
+        float m_fClosest = std::numeric_limits<float>::max();
+        void notifyIntersection(float fDist, const ITraceableObject*, uint32_t) override
+        {
+            if (fDist < m_fClosest)
+            {
+                m_fClosest = fDist;
+                m_fMax = fDist;
+            }
+        }
+    };
+}
+
+BVHBenchmark::Result BVHBenchmark::run(uint32_t sphereSubdivisionLevel, BVH::BuildStrategy strategy,
+                                       uint32_t nParallelBuildThreshold, uint32_t nBuildRepetitions, uint32_t nRays)
+{
+    using Clock = std::chrono::steady_clock;
+    const float RADIUS = 10.0f;
+
+    // Deformed sphere so the tree is not built over a perfectly regular surface
+    auto pMesh = TriangleMesh::createSphere(RADIUS, sphereSubdivisionLevel);
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+    auto pVertices = pMesh->getVertices();
+    for (uint32_t i = 0; i < pVertices->getVertexCount(); ++i)
+    {
+        pVertices->setVertexPosition(i, pVertices->getVertexPosition(i) * (1.0f + 0.1f * uni(rng)));
+    }
+    auto pMeshObject = std::make_shared<BVHMesh>(pMesh);
+    pMeshObject->rebuildForCurrentMesh();
+
+    BVH bvh;
+    bvh.accessObjects().push_back(pMeshObject);
+    bvh.setBuildStrategy(strategy);
+    bvh.setParallelBuildThreshold(nParallelBuildThreshold);
+
+    Result result;
+    result.m_nTriangles = pMesh->getTriangleCount();
+
+    const Clock::time_point buildStart = Clock::now();
+    for (uint32_t i = 0; i < std::max(1u, nBuildRepetitions); ++i)
+    {
+        bvh.rebuildHierarchy();
+    }
+    result.m_fBuildMs = std::chrono::duration<double, std::milli>(Clock::now() - buildStart).count()
+        / std::max(1u, nBuildRepetitions);
+    result.m_fSAHCost = bvh.computeSAHCost();
+
+    std::vector<ClosestHitRay> rays(nRays);
+    for (ClosestHitRay& ray : rays)
+    {
+        ray.m_vPos = float3(uni(rng), uni(rng), uni(rng)) * (0.5f * RADIUS);
+        float3 dir(uni(rng), uni(rng), uni(rng));
+        ray.m_vDir = (length(dir) > 1e-3f) ? normalize(dir) : float3(1, 0, 0);
+        ray.m_fMin = 0.0f;
+        ray.m_fMax = std::numeric_limits<float>::max();
+    }
+    const Clock::time_point traceStart = Clock::now();
+    for (ClosestHitRay& ray : rays)
+    {
+        bvh.trace(ray, 0);
+    }
+    result.m_fTraceNsPerRay = std::chrono::duration<double, std::nano>(Clock::now() - traceStart).count()
+        / std::max(1u, nRays);
+    return result;
+}
+
+double BVHBenchmark::runCacheContention(uint32_t nThreads, uint32_t nLookupsPerThread, uint32_t sphereSubdivisionLevel)
+{
+    using Clock = std::chrono::steady_clock;
+    nThreads = std::max(1u, nThreads);
+
+    auto pMesh = TriangleMesh::createSphere(10.0f, sphereSubdivisionLevel);
+    // Held for the whole run so lookups find a live BVHMesh instead of rebuilding
+    const std::shared_ptr<BVHMesh> pBVH = BVHCache::instance().getOrCreate(pMesh);
+
+    std::atomic<uint32_t> nReady = 0;
+    std::atomic<bool> bStart = false;
+    std::atomic<uint32_t> nMismatches = 0;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < nThreads; ++t)
+    {
+        threads.emplace_back([&]()
+        {
+            ++nReady;
+            while (!bStart.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            uint32_t nLocalMismatches = 0;
+            for (uint32_t i = 0; i < nLookupsPerThread; ++i)
+            {
+                if (BVHCache::instance().getOrCreate(pMesh) != pBVH)
+                    ++nLocalMismatches;
+            }
+            nMismatches += nLocalMismatches;
+        });
+    }
+    while (nReady.load() < nThreads)
+        std::this_thread::yield();
+
+    const Clock::time_point start = Clock::now();
+    bStart.store(true, std::memory_order_release);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    const double fElapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    assert(nMismatches.load() == 0 && "BVHCache returned a different BVHMesh for an unchanged mesh");
+    return fElapsedNs / (static_cast<double>(nThreads) * std::max(1u, nLookupsPerThread));
+}
+
+std::vector<BVHBenchmark::LevelResult> BVHBenchmark::runLevelOfDetail(uint32_t sphereSubdivisionLevel, uint32_t nQueries)
+{
+    using Clock = std::chrono::steady_clock;
+    const float RADIUS = 10.0f;
+
+    // Deformed like run() so coarse levels have a real approximation error
+    auto pMesh = TriangleMesh::createSphere(RADIUS, sphereSubdivisionLevel);
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+    {
+        auto pVertices = pMesh->getVertices();
+        Vertices::PositionUpdate update = pVertices->beginPositionUpdate();
+        for (uint32_t i = 0; i < pVertices->getVertexCount(); ++i)
+        {
+            update.set(i, pVertices->getVertexPosition(i) * (1.0f + 0.1f * uni(rng)));
+        }
+    }
+
+    std::vector<RayQuery> rays(nQueries);
+    std::vector<float3> points(nQueries);
+    for (uint32_t i = 0; i < nQueries; ++i)
+    {
+        rays[i].m_vPos = float3(uni(rng), uni(rng), uni(rng)) * (0.5f * RADIUS);
+        const float3 dir(uni(rng), uni(rng), uni(rng));
+        rays[i].m_vDir = (length(dir) > 1e-3f) ? normalize(dir) : float3(1, 0, 0);
+        points[i] = float3(uni(rng), uni(rng), uni(rng)) * (1.2f * RADIUS);
+    }
+
+    std::vector<LevelResult> results;
+    std::vector<RayHit> hits;
+    std::vector<float> distances;
+    for (uint32_t uLevel = 0; uLevel < pMesh->getLevelCount(); ++uLevel)
+    {
+        auto pLevel = pMesh->getLevel(uLevel);
+        auto pMeshObject = std::make_shared<BVHMesh>(pLevel);
+        pMeshObject->rebuildForCurrentMesh();
+
+        LevelResult result;
+        result.m_uLevel = uLevel;
+        result.m_nTriangles = pLevel->getTriangleCount();
+        result.m_fApproximationError = pMesh->getLevelError(uLevel);
+
+        const Clock::time_point traceStart = Clock::now();
+        pMeshObject->getBVH().traceBatch(rays, hits);
+        result.m_fTraceNsPerRay = std::chrono::duration<double, std::nano>(Clock::now() - traceStart).count()
+            / std::max(1u, nQueries);
+
+        const Clock::time_point distanceStart = Clock::now();
+        pMeshObject->computeSignedDistances(points, distances);
+        result.m_fSignedDistanceNsPerQuery = std::chrono::duration<double, std::nano>(Clock::now() - distanceStart).count()
+            / std::max(1u, nQueries);
+        results.push_back(result);
+    }
+    return results;
+}
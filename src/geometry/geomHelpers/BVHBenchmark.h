@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "geometry/BVH/BVH.h"
+
+// Build time and trace cost of a BVH over a subdivided sphere for a given build configuration.
+// Used to compare builder changes (e.g. binned SAH vs median split, serial vs parallel);
+// it is not run as part of the simulation but by tests/bvhBenchmark.
+class BVHBenchmark
+{
+public:
+    struct Result
+    {
+        uint32_t m_nTriangles = 0;
+        double m_fBuildMs = 0.0;        // average over all build repetitions
+        double m_fTraceNsPerRay = 0.0;  // closest-hit queries from random points inside the sphere
+        float m_fSAHCost = 0.0f;
+    };
+
+    static Result run(uint32_t sphereSubdivisionLevel, BVH::BuildStrategy strategy,
+                      uint32_t nParallelBuildThreshold, uint32_t nBuildRepetitions = 5, uint32_t nRays = 100000);
+
+    // BVHCache::getOrCreate() contention: nThreads readers look up the BVHMesh of one unchanged
+    // mesh nLookupsPerThread times each. Returns the wall-clock time divided by the total number
+    // of lookups, in ns.
+    static double runCacheContention(uint32_t nThreads, uint32_t nLookupsPerThread = 1000000,
+                                     uint32_t sphereSubdivisionLevel = 3);
+
+    // Query cost per level of the subdivision hierarchy of a deformed sphere (see MeshHierarchy):
+    // the same closest-hit rays and signed distance queries against every level, coarsest first
+    struct LevelResult
+    {
+        uint32_t m_uLevel = 0;
+        uint32_t m_nTriangles = 0;
+        float m_fApproximationError = 0.0f;     // bound on the distance to the finest surface
+        double m_fTraceNsPerRay = 0.0;
+        double m_fSignedDistanceNsPerQuery = 0.0;
+    };
+    static std::vector<LevelResult> runLevelOfDetail(uint32_t sphereSubdivisionLevel, uint32_t nQueries = 100000);
+};
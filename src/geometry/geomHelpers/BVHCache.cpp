@@ -1,6 +1,43 @@
 #include "BVHCache.h"
 #include "BVHMesh.h"
 #include "geometry/mesh/TriangleMesh.h"
+#include <thread>
+
+class BVHCache::ReadSection
+{
+public:
+    ReadSection(BVHCache& cache)
+        : m_slot(cache.m_readerSlots[threadSlot()])
+    {
+        // A writer may advance the epoch between our read of it and our registration; a reader
+        // counted under a parity it no longer matches could be missed by the next writer waiting
+        // on that parity. Register and re-check until the epoch did not move in between.
+        for ( ; ; )
+        {
+            const uint32_t uEpoch = cache.m_uEpoch.load();
+            m_uParity = uEpoch & 1;
+            m_slot.m_nActive[m_uParity].fetch_add(1);
+            if (cache.m_uEpoch.load() == uEpoch)
+                break;
+            m_slot.m_nActive[m_uParity].fetch_sub(1, std::memory_order_release);
+        }
+    }
+    ~ReadSection()
+    {
+        m_slot.m_nActive[m_uParity].fetch_sub(1, std::memory_order_release);
+    }
+
+private:
+    ReaderSlot& m_slot;
+    uint32_t m_uParity = 0;
+
+    static uint32_t threadSlot()
+    {
+        static std::atomic<uint32_t> nextSlot = 0;
+        thread_local const uint32_t uSlot = nextSlot.fetch_add(1, std::memory_order_relaxed) % READER_SLOT_COUNT;
+        return uSlot;
+    }
+};
 
 BVHCache& BVHCache::instance()
 {
@@ -8,55 +45,146 @@ BVHCache& BVHCache::instance()
     return cache;
 }
 
+BVHCache::~BVHCache()
+{
+    if (const EntryMap* pEntries = m_pEntries.load())
+    {
+        for (const auto& [key, pEntry] : *pEntries)
+            delete pEntry;
+        delete pEntries;
+    }
+}
+
 std::shared_ptr<BVHMesh> BVHCache::getOrCreate(const std::shared_ptr<TriangleMesh>& mesh)
 {
     if (!mesh) return nullptr;
-    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Fast path: the published BVHMesh already matches the mesh version
+    {
+        ReadSection section(*this);
+        if (const EntryMap* pEntries = m_pEntries.load())
+        {
+            auto it = pEntries->find(mesh->getId());
+            if (it != pEntries->end())
+            {
+                if (const Snapshot* pSnapshot = it->second->pSnapshot.load())
+                {
+                    std::shared_ptr<BVHMesh> bvh = pSnapshot->lock();
+                    if (bvh && bvh->getMesh() == mesh && bvh->getBuiltVersion() == mesh->getVersion())
+                        return bvh;
+                }
+            }
+        }
+    }
+    return update(mesh);
+}
+
+std::shared_ptr<BVHMesh> BVHCache::update(const std::shared_ptr<TriangleMesh>& mesh)
+{
+    std::lock_guard<std::mutex> lock(m_writeMutex);
 
     const uint64_t key = mesh->getId();
-    auto it = m_entries.find(key);
     const uint64_t ver = mesh->getVersion();
-
-    if (it == m_entries.end())
+    const EntryMap* pEntries = m_pEntries.load();
+    Entry* pEntry = nullptr;
+    if (pEntries)
     {
-        auto bvh = std::make_shared<BVHMesh>(mesh);
-        bvh->rebuildForCurrentMesh();
-        m_entries.emplace(key, Entry{ std::weak_ptr<TriangleMesh>(mesh), std::weak_ptr<BVHMesh>(bvh), ver });
-        return bvh;
+        auto it = pEntries->find(key);
+        if (it != pEntries->end() && it->second->mesh.lock() == mesh)
+            pEntry = it->second;
+
+        // A spare that is the last owner of its mesh would keep the mesh alive forever
+        for (const auto& [entryKey, pOtherEntry] : *pEntries)
+        {
+            if (pOtherEntry->pSpare && pOtherEntry->mesh.use_count() == 1)
+                pOtherEntry->pSpare.reset();
+        }
     }
 
-    Entry& e = it->second;
+    // Another writer may have published while we waited for the lock
+    std::shared_ptr<BVHMesh> current;
+    if (pEntry && pEntry->pSnapshot.load())
+    {
+        current = pEntry->pSnapshot.load()->lock();
+        if (current && current->getBuiltVersion() == ver)
+            return current;
+    }
 
-    // If mesh expired or replaced, rebuild and replace entry
-    if (e.mesh.expired())
+    std::shared_ptr<BVHMesh> bvh;
+    const uint64_t topologyVer = mesh->getTopologyVersion();
+    if (pEntry && pEntry->pSpare && pEntry->pSpare.use_count() == 1
+        && pEntry->pSpare->getBuiltTopologyVersion() == topologyVer)
+    {
+        // Only vertex positions changed and no caller holds the spare any more: refit it in place.
+        // The fence orders our writes after the reads of whoever released it last.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        bvh = std::move(pEntry->pSpare);
+        bvh->refitForCurrentMesh();
+    }
+    else if (current && current->getBuiltTopologyVersion() == topologyVer)
+    {
+        // Only vertex positions changed: refit a copy so users of the current tree are undisturbed
+        bvh = current->clone();
+        bvh->refitForCurrentMesh();
+    }
+    else
     {
-        auto bvh = std::make_shared<BVHMesh>(mesh);
+        bvh = std::make_shared<BVHMesh>(mesh);
         bvh->rebuildForCurrentMesh();
-        e = Entry{ std::weak_ptr<TriangleMesh>(mesh), std::weak_ptr<BVHMesh>(bvh), ver };
-        return bvh;
     }
+    // Signed queries need the edge adjacency; create it here so concurrent readers only read it
+    mesh->getOrCreateEdges();
 
-    auto bvhLocked = e.bvh.lock();
-    if (!bvhLocked)
+    if (pEntry)
     {
-        auto bvh = std::make_shared<BVHMesh>(mesh);
-        bvh->rebuildForCurrentMesh();
-        e.bvh = bvh;
-        e.cachedVersion = ver;
+        Snapshot* pSnapshot = &pEntry->snapshots[pEntry->pSnapshot.load() == &pEntry->snapshots[0] ? 1 : 0];
+        pSnapshot->bvh = bvh;
+        pEntry->pSnapshot.store(pSnapshot);
+        waitForReaders();
+        // No reader can reach the replaced tree any more; keep it for the next refit
+        if (current && current->getBuiltTopologyVersion() == bvh->getBuiltTopologyVersion())
+            pEntry->pSpare = std::move(current);
+        else
+            pEntry->pSpare.reset();
         return bvh;
     }
 
-    if (e.cachedVersion != ver)
+    // New mesh (or its id's previous mesh expired): publish a new table without expired entries
+    EntryMap* pNewEntries = new EntryMap();
+    std::vector<Entry*> removed;
+    if (pEntries)
     {
-        // Mesh changed: rebuild BVHMesh
-        auto bvh = std::make_shared<BVHMesh>(mesh);
-        bvh->rebuildForCurrentMesh();
-        e.bvh = bvh;
-        e.cachedVersion = ver;
-        return bvh;
+        pNewEntries->reserve(pEntries->size() + 1);
+        for (const auto& [entryKey, pOldEntry] : *pEntries)
+        {
+            if (entryKey != key && !pOldEntry->mesh.expired())
+                pNewEntries->emplace(entryKey, pOldEntry);
+            else
+                removed.push_back(pOldEntry);
+        }
     }
+    pEntry = new Entry();
+    pEntry->mesh = mesh;
+    pEntry->snapshots[0].bvh = bvh;
+    pEntry->pSnapshot.store(&pEntry->snapshots[0]);
+    pNewEntries->emplace(key, pEntry);
+    m_pEntries.store(pNewEntries);
 
-    return bvhLocked;
+    waitForReaders();
+    for (Entry* pOldEntry : removed)
+        delete pOldEntry;
+    delete pEntries;
+    return bvh;
 }
 
-
+void BVHCache::waitForReaders()
+{
+    // Readers registering from now on confirm the new epoch and can only see the new pointers.
+    // Those counted under the old parity may have seen the old ones; wait for them to leave.
+    const uint32_t uOldParity = m_uEpoch.fetch_add(1) & 1;
+    for (ReaderSlot& slot : m_readerSlots)
+    {
+        while (slot.m_nActive[uOldParity].load() != 0)
+            std::this_thread::yield();
+    }
+}
@@ -2,11 +2,23 @@
 
 #include <memory>
 #include <unordered_map>
+#include <atomic>
 #include <mutex>
 #include <cstdint>
 
-// Simple flyweight-style cache for BVHMesh per TriangleMesh instance.
-// Rebuilds BVHMesh whenever TriangleMesh version changes.
+// Flyweight-style cache for BVHMesh per TriangleMesh instance.
+// Lookups of an up-to-date BVHMesh are lock-free. The entry table and each entry's snapshot are
+// immutable once published through atomic pointers; a reader marks itself active in an epoch
+// counter of its own, follows the pointers and leaves. Writers (rebuilds and refits, serialized by
+// a mutex) publish replacements and free the old objects only after a grace period in which every
+// reader that could still see them has left.
+// When only vertex positions changed (same topology version) the tree replaced by the previous
+// update is refitted in place and published, once no caller holds it any more; callers still
+// holding the current BVHMesh are undisturbed. Steady stepping therefore alternates between two
+// trees per mesh and allocates nothing. A copy of the current tree is refitted only while the
+// spare is still in use, and topology changes build a new BVHMesh.
+// The meshes themselves are not synchronized: a mesh must not be modified while other threads
+// query it or its BVHMesh.
 class TriangleMesh;
 class BVHMesh;
 
@@ -14,21 +26,48 @@ class BVHCache
 {
 public:
     static BVHCache& instance();
+    ~BVHCache();
 
     std::shared_ptr<BVHMesh> getOrCreate(const std::shared_ptr<TriangleMesh>& mesh);
 
 private:
     BVHCache() = default;
 
-    struct Entry
+    // The cache does not own the published BVHMesh: it lives as long as some caller holds it
+    struct Snapshot
     {
-        std::weak_ptr<TriangleMesh>    mesh;
+        std::shared_ptr<BVHMesh> lock() const { return bvh.lock(); }
         std::weak_ptr<BVHMesh> bvh;
-        uint64_t               cachedVersion = 0;
     };
+    struct Entry
+    {
+        std::weak_ptr<TriangleMesh> mesh;
+        std::atomic<const Snapshot*> pSnapshot = nullptr;
+        // pSnapshot points to one of these; the other one was retired by the previous update, which
+        // waited for its readers, so the next update can rewrite it
+        Snapshot snapshots[2];
+        // The BVHMesh retired by the previous update, kept for refitting in place. It holds its
+        // mesh, so it is dropped once nothing else does.
+        std::shared_ptr<BVHMesh> pSpare;
+    };
+    typedef std::unordered_map<uint64_t, Entry*> EntryMap;
 
-    std::unordered_map<uint64_t, Entry> m_entries;
-    std::mutex m_mutex;
-};
+    std::atomic<const EntryMap*> m_pEntries = nullptr;
+    std::mutex m_writeMutex;
 
+    // Readers count themselves in the slot of their thread under the current epoch parity.
+    // Threads are spread over the slots round-robin, so readers rarely share a cache line.
+    static constexpr uint32_t READER_SLOT_COUNT = 64;
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint32_t> m_nActive[2] = { 0, 0 };
+    };
+    ReaderSlot m_readerSlots[READER_SLOT_COUNT];
+    std::atomic<uint32_t> m_uEpoch = 0;
 
+    class ReadSection;
+
+    std::shared_ptr<BVHMesh> update(const std::shared_ptr<TriangleMesh>& mesh);
+    // Waits until no reader can still hold a pointer unpublished before the call
+    void waitForReaders();
+};
@@ -1,4 +1,7 @@
 #include "BVHMesh.h"
+#include "geometry/vectors/simd4.h"
+#include "geometry/vectors/intersections.h"
+#include "geometry/mesh/Edges.h"
 #include <limits>
 #include <algorithm>
 
@@ -6,15 +9,94 @@ BVHMesh::BVHMesh(std::shared_ptr<TriangleMesh> pMesh)
     : m_pMesh(pMesh)
 {
 }
+
+// Pseudo-normals are not copied: the clone is normally refitted right away, which invalidates them
+BVHMesh::BVHMesh(const BVHMesh& other)
+    : ITraceableObject(other)
+    , m_pMesh(other.m_pMesh)
+    , m_bvh(other.m_bvh)
+    , m_builtTopologyVersion(other.m_builtTopologyVersion)
+    , m_builtVersion(other.m_builtVersion)
+    , m_triangleData(other.m_triangleData)
+    , m_triangleDataStride(other.m_triangleDataStride)
+    , m_triangleSlots(other.m_triangleSlots)
+{
+}
+
+std::shared_ptr<BVHMesh> BVHMesh::clone() const
+{
+    std::shared_ptr<BVHMesh> pClone(new BVHMesh(*this));
+    pClone->m_bvh.replaceObject(this, pClone->selfReference());
+    return pClone;
+}
+
+std::shared_ptr<ITraceableObject> BVHMesh::selfReference()
+{
+    // The embedded BVH must not own its BVHMesh (that cycle would keep both alive forever)
+    return std::shared_ptr<ITraceableObject>(std::shared_ptr<ITraceableObject>(), this);
+}
+
 void BVHMesh::rebuildForCurrentMesh()
 {
     m_nSubObjects = m_pMesh->getTriangleCount();
     m_bvh.accessObjects().clear();
-    m_bvh.accessObjects().push_back(shared_from_this());
+    m_bvh.accessObjects().push_back(selfReference());
     m_bvh.rebuildHierarchy();
-#ifndef NDEBUG
-    m_debugVersion = m_pMesh->getVersion();
-#endif
+    m_builtTopologyVersion = m_pMesh->getTopologyVersion();
+    updateTriangleData();
+    m_builtVersion = m_pMesh->getVersion();
+}
+
+bool BVHMesh::refitForCurrentMesh()
+{
+    if (m_builtTopologyVersion != m_pMesh->getTopologyVersion())
+    {
+        rebuildForCurrentMesh();
+        return false;
+    }
+
+    m_bvh.refit();
+    bool bRefitted = true;
+    if (m_bvh.computeSAHCost() > REFIT_MAX_SAH_GROWTH * m_bvh.getBuildSAHCost())
+    {
+        // Vertices moved far enough to make the old partitioning inefficient
+        m_bvh.rebuildHierarchy();
+        bRefitted = false;
+    }
+    updateTriangleData();
+    m_builtVersion = m_pMesh->getVersion();
+    return bRefitted;
+}
+
+void BVHMesh::updateTriangleData()
+{
+    const uint32_t nSlots = m_bvh.getLeafOrderSize();
+    m_triangleDataStride = nSlots + RayPacket::WIDTH;
+    m_triangleData.assign(static_cast<size_t>(TRIANGLE_COMPONENT_COUNT) * m_triangleDataStride, 0.0f);
+    m_triangleSlots.assign(m_pMesh->getTriangleCount(), UINT32_MAX);
+
+    const Vertices& vertices = *m_pMesh->getVertices();
+    float* pData = m_triangleData.data();
+    const size_t stride = m_triangleDataStride;
+    for (uint32_t uSlot = 0; uSlot < nSlots; ++uSlot)
+    {
+        const uint32_t triangleIndex = m_bvh.getLeafOrderSubObject(uSlot);
+        m_triangleSlots[triangleIndex] = uSlot;
+
+        const uint3 triangle = m_pMesh->getTriangleVertices(triangleIndex);
+        const float3 v0 = vertices.getVertexPosition(triangle.x);
+        const float3 edge1 = vertices.getVertexPosition(triangle.y) - v0;
+        const float3 edge2 = vertices.getVertexPosition(triangle.z) - v0;
+        pData[V0X * stride + uSlot] = v0.x;
+        pData[V0Y * stride + uSlot] = v0.y;
+        pData[V0Z * stride + uSlot] = v0.z;
+        pData[E1X * stride + uSlot] = edge1.x;
+        pData[E1Y * stride + uSlot] = edge1.y;
+        pData[E1Z * stride + uSlot] = edge1.z;
+        pData[E2X * stride + uSlot] = edge2.x;
+        pData[E2Y * stride + uSlot] = edge2.y;
+        pData[E2Z * stride + uSlot] = edge2.z;
+    }
 }
 
 // BVH is maintained fresh by BVHCache-managed refresh in clients
@@ -42,18 +124,16 @@ box3 BVHMesh::getSubObjectBox(uint32_t uSubObj) const
 void BVHMesh::trace(IRay& ray, uint32_t triangleIndex) const
 {
     assert(m_pMesh && "BVHMesh must have a valid TriangleMesh");
-    assert(m_debugVersion == m_pMesh->getVersion() && "BVHMesh BVH is out of sync with TriangleMesh version");
+    assert(m_builtVersion == m_pMesh->getVersion() && "BVHMesh BVH is out of sync with TriangleMesh version");
     const float EPSILON = 1e-8f;
 
-    // Get triangle vertices
-    uint3 triangle = m_pMesh->getTriangleVertices(triangleIndex);
-    float3 v0 = m_pMesh->getVertices()->getVertexPosition(triangle.x);
-    float3 v1 = m_pMesh->getVertices()->getVertexPosition(triangle.y);
-    float3 v2 = m_pMesh->getVertices()->getVertexPosition(triangle.z);
+    // Precomputed triangle vertex and edges
+    const uint32_t uSlot = m_triangleSlots[triangleIndex];
+    float3 v0(getTriangleComponent(V0X)[uSlot], getTriangleComponent(V0Y)[uSlot], getTriangleComponent(V0Z)[uSlot]);
+    float3 edge1(getTriangleComponent(E1X)[uSlot], getTriangleComponent(E1Y)[uSlot], getTriangleComponent(E1Z)[uSlot]);
+    float3 edge2(getTriangleComponent(E2X)[uSlot], getTriangleComponent(E2Y)[uSlot], getTriangleComponent(E2Z)[uSlot]);
 
     // Möller-Trumbore ray-triangle intersection algorithm
-    float3 edge1 = v1 - v0;
-    float3 edge2 = v2 - v0;
     float3 h = cross(ray.m_vDir, edge2);
     float a = dot(edge1, h);
 
@@ -87,3 +167,319 @@ void BVHMesh::trace(IRay& ray, uint32_t triangleIndex) const
     }
 }
 
+void BVHMesh::traceLeaf(IRay& ray, const uint32_t* pTriangles, uint32_t nTriangles) const
+{
+    assert(m_pMesh && "BVHMesh must have a valid TriangleMesh");
+    assert(m_builtVersion == m_pMesh->getVersion() && "BVHMesh BVH is out of sync with TriangleMesh version");
+    if (nTriangles == 0)
+        return;
+
+    // Leaves of another BVH built over this mesh do not follow our slot layout
+    if (!m_bvh.isOwnLeafRange(pTriangles))
+    {
+        ITraceableObject::traceLeaf(ray, pTriangles, nTriangles);
+        return;
+    }
+
+    // A leaf occupies consecutive slots starting at the slot of its first triangle
+    const uint32_t uFirstSlot = m_triangleSlots[pTriangles[0]];
+
+    // Ray is shared by all lanes, each lane tests one triangle
+    const simd4f dx = simd4f::broadcast(ray.m_vDir.x), dy = simd4f::broadcast(ray.m_vDir.y), dz = simd4f::broadcast(ray.m_vDir.z);
+    const simd4f px = simd4f::broadcast(ray.m_vPos.x), py = simd4f::broadcast(ray.m_vPos.y), pz = simd4f::broadcast(ray.m_vPos.z);
+    const simd4f tMin = simd4f::broadcast(ray.m_fMin);
+    const simd4f epsilon = simd4f::broadcast(1e-8f);
+    const simd4f zero = simd4f::zero();
+    const simd4f one = simd4f::broadcast(1.0f);
+
+    for (uint32_t uFirst = 0; uFirst < nTriangles; uFirst += RayPacket::WIDTH)
+    {
+        const uint32_t uSlot = uFirstSlot + uFirst;
+        const uint32_t nLanes = std::min<uint32_t>(RayPacket::WIDTH, nTriangles - uFirst);
+        const simd4f v0x = simd4f::loadUnaligned(getTriangleComponent(V0X) + uSlot);
+        const simd4f v0y = simd4f::loadUnaligned(getTriangleComponent(V0Y) + uSlot);
+        const simd4f v0z = simd4f::loadUnaligned(getTriangleComponent(V0Z) + uSlot);
+        const simd4f e1x = simd4f::loadUnaligned(getTriangleComponent(E1X) + uSlot);
+        const simd4f e1y = simd4f::loadUnaligned(getTriangleComponent(E1Y) + uSlot);
+        const simd4f e1z = simd4f::loadUnaligned(getTriangleComponent(E1Z) + uSlot);
+        const simd4f e2x = simd4f::loadUnaligned(getTriangleComponent(E2X) + uSlot);
+        const simd4f e2y = simd4f::loadUnaligned(getTriangleComponent(E2Y) + uSlot);
+        const simd4f e2z = simd4f::loadUnaligned(getTriangleComponent(E2Z) + uSlot);
+
+        // Same operation order as trace(); all conditions are evaluated as masks without branches
+        const simd4f hx = dy * e2z - dz * e2y;
+        const simd4f hy = dz * e2x - dx * e2z;
+        const simd4f hz = dx * e2y - dy * e2x;
+        const simd4f a = e1x * hx + e1y * hy + e1z * hz;
+        const simd4f f = one / a;
+        const simd4f sx = px - v0x, sy = py - v0y, sz = pz - v0z;
+        const simd4f u = f * (sx * hx + sy * hy + sz * hz);
+        const simd4f qx = sy * e1z - sz * e1y;
+        const simd4f qy = sz * e1x - sx * e1z;
+        const simd4f qz = sx * e1y - sy * e1x;
+        const simd4f v = f * (dx * qx + dy * qy + dz * qz);
+        const simd4f t = f * (e2x * qx + e2y * qy + e2z * qz);
+        const simd4f valid = ((a <= zero - epsilon) | (a >= epsilon))
+            & (u >= zero) & (u <= one) & (v >= zero) & (u + v <= one)
+            & (t > epsilon) & (t >= tMin) & (t <= simd4f::broadcast(ray.m_fMax));
+
+        uint32_t uHitMask = static_cast<uint32_t>(movemask(valid)) & ((1u << nLanes) - 1);
+        if (uHitMask == 0)
+            continue;
+
+        // Report in slot order; m_fMax may shrink with every reported hit
+        alignas(16) float dist[RayPacket::WIDTH];
+        t.store(dist);
+        for (uint32_t uLane = 0; uLane < nLanes; ++uLane)
+        {
+            if ((uHitMask & (1u << uLane)) && dist[uLane] <= ray.m_fMax)
+                ray.notifyIntersection(dist[uLane], this, pTriangles[uFirst + uLane]);
+        }
+    }
+}
+
+void BVHMesh::tracePacket(RayPacket& packet, uint32_t triangleIndex, uint32_t uLaneMask) const
+{
+    assert(m_pMesh && "BVHMesh must have a valid TriangleMesh");
+    assert(m_builtVersion == m_pMesh->getVersion() && "BVHMesh BVH is out of sync with TriangleMesh version");
+
+    // Triangle data is shared by all lanes
+    const uint32_t uSlot = m_triangleSlots[triangleIndex];
+    const simd4f e1x = simd4f::broadcast(getTriangleComponent(E1X)[uSlot]);
+    const simd4f e1y = simd4f::broadcast(getTriangleComponent(E1Y)[uSlot]);
+    const simd4f e1z = simd4f::broadcast(getTriangleComponent(E1Z)[uSlot]);
+    const simd4f e2x = simd4f::broadcast(getTriangleComponent(E2X)[uSlot]);
+    const simd4f e2y = simd4f::broadcast(getTriangleComponent(E2Y)[uSlot]);
+    const simd4f e2z = simd4f::broadcast(getTriangleComponent(E2Z)[uSlot]);
+    const simd4f dx = simd4f::load(packet.m_dirX), dy = simd4f::load(packet.m_dirY), dz = simd4f::load(packet.m_dirZ);
+    const simd4f epsilon = simd4f::broadcast(1e-8f);
+    const simd4f zero = simd4f::zero();
+    const simd4f one = simd4f::broadcast(1.0f);
+
+    // Möller-Trumbore with the same operation order as trace() so both paths report identical distances
+    const simd4f hx = dy * e2z - dz * e2y;
+    const simd4f hy = dz * e2x - dx * e2z;
+    const simd4f hz = dx * e2y - dy * e2x;
+    const simd4f a = e1x * hx + e1y * hy + e1z * hz;
+    simd4f valid = (a <= zero - epsilon) | (a >= epsilon);
+
+    const simd4f f = one / a;
+    const simd4f sx = simd4f::load(packet.m_posX) - simd4f::broadcast(getTriangleComponent(V0X)[uSlot]);
+    const simd4f sy = simd4f::load(packet.m_posY) - simd4f::broadcast(getTriangleComponent(V0Y)[uSlot]);
+    const simd4f sz = simd4f::load(packet.m_posZ) - simd4f::broadcast(getTriangleComponent(V0Z)[uSlot]);
+    const simd4f u = f * (sx * hx + sy * hy + sz * hz);
+    valid = valid & (u >= zero) & (u <= one);
+
+    const simd4f qx = sy * e1z - sz * e1y;
+    const simd4f qy = sz * e1x - sx * e1z;
+    const simd4f qz = sx * e1y - sy * e1x;
+    const simd4f v = f * (dx * qx + dy * qy + dz * qz);
+    valid = valid & (v >= zero) & (u + v <= one);
+
+    const simd4f t = f * (e2x * qx + e2y * qy + e2z * qz);
+    valid = valid & (t > epsilon) & (t >= simd4f::load(packet.m_fMin)) & (t <= simd4f::load(packet.m_fMax));
+
+    const uint32_t uHitMask = uLaneMask & static_cast<uint32_t>(movemask(valid));
+    if (uHitMask == 0)
+        return;
+
+    alignas(16) float dist[RayPacket::WIDTH];
+    t.store(dist);
+    for (uint32_t uLane = 0; uLane < RayPacket::WIDTH; ++uLane)
+    {
+        if (uHitMask & (1u << uLane))
+            packet.reportHit(uLane, dist[uLane], this, triangleIndex);
+    }
+}
+
+void BVHMesh::findClosestPoint(IPointQuery& query, uint32_t triangleIndex) const
+{
+    assert(m_builtVersion == m_pMesh->getVersion() && "BVHMesh BVH is out of sync with TriangleMesh version");
+    const uint32_t uSlot = m_triangleSlots[triangleIndex];
+    const float3 v0(getTriangleComponent(V0X)[uSlot], getTriangleComponent(V0Y)[uSlot], getTriangleComponent(V0Z)[uSlot]);
+    const float3 edge1(getTriangleComponent(E1X)[uSlot], getTriangleComponent(E1Y)[uSlot], getTriangleComponent(E1Z)[uSlot]);
+    const float3 edge2(getTriangleComponent(E2X)[uSlot], getTriangleComponent(E2Y)[uSlot], getTriangleComponent(E2Z)[uSlot]);
+
+    float3 bary;
+    const float3 closest = closestPointOnTriangle(query.m_vPos, v0, v0 + edge1, v0 + edge2, bary);
+    const float3 d = closest - query.m_vPos;
+    const float distSq = dot(d, d);
+    if (distSq <= query.m_fMaxDistSq)
+    {
+        query.notifyClosestPoint(distSq, this, triangleIndex);
+    }
+}
+
+namespace {
+    struct NearestTriangleQuery : IPointQuery
+    {
+        uint32_t m_uTriangle = TriangleMesh::INVALID_INDEX;
+
+        void notifyClosestPoint(float fDistSq, const ITraceableObject*, uint32_t uSubObj) override
+        {
+            // Ties (shared edges and vertices) keep the first triangle found
+            if (m_uTriangle == TriangleMesh::INVALID_INDEX || fDistSq < m_fMaxDistSq)
+            {
+                m_fMaxDistSq = fDistSq;
+                m_uTriangle = uSubObj;
+            }
+        }
+    };
+}
+
+BVHMesh::ClosestPoint BVHMesh::findClosestSurfacePoint(const float3& vPos, float fMaxDistance) const
+{
+    ClosestPoint result;
+    if (m_pMesh->getTriangleCount() == 0)
+        return result;
+
+    NearestTriangleQuery query;
+    query.m_vPos = vPos;
+    query.m_fMaxDistSq = (fMaxDistance < std::sqrt(std::numeric_limits<float>::max()))
+        ? fMaxDistance * fMaxDistance : std::numeric_limits<float>::max();
+    getBVH().findClosestPoint(query, 0);
+    if (query.m_uTriangle == TriangleMesh::INVALID_INDEX)
+        return result;
+
+    // Recover the closest point and its barycentrics on the winning triangle
+    const uint32_t uSlot = m_triangleSlots[query.m_uTriangle];
+    const float3 v0(getTriangleComponent(V0X)[uSlot], getTriangleComponent(V0Y)[uSlot], getTriangleComponent(V0Z)[uSlot]);
+    const float3 edge1(getTriangleComponent(E1X)[uSlot], getTriangleComponent(E1Y)[uSlot], getTriangleComponent(E1Z)[uSlot]);
+    const float3 edge2(getTriangleComponent(E2X)[uSlot], getTriangleComponent(E2Y)[uSlot], getTriangleComponent(E2Z)[uSlot]);
+    result.m_vPoint = closestPointOnTriangle(vPos, v0, v0 + edge1, v0 + edge2, result.m_vBarycentric);
+    result.m_uTriangle = query.m_uTriangle;
+    result.m_fDistance = std::sqrt(query.m_fMaxDistSq);
+    return result;
+}
+
+void BVHMesh::findClosestSurfacePoints(const std::vector<float3>& positions, std::vector<ClosestPoint>& results,
+                                       float fMaxDistance) const
+{
+    results.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        // Triangle inequality: the previous closest point is at most this far from the current
+        // position. Slightly widened so rounding cannot exclude the true closest triangle.
+        float fBound = fMaxDistance;
+        if (i > 0 && results[i - 1].isValid())
+        {
+            const float fPrevBound = results[i - 1].m_fDistance + length(positions[i] - positions[i - 1]);
+            fBound = std::min(fBound, fPrevBound * 1.0001f + 1e-6f);
+        }
+        results[i] = findClosestSurfacePoint(positions[i], fBound);
+    }
+}
+
+float BVHMesh::getSide(const float3& vPos, const ClosestPoint& closest) const
+{
+    assert(closest.isValid());
+    updatePseudoNormals();
+
+    // Exact zeros in the barycentrics identify the closest feature (vertex, edge or face)
+    const uint3 tri = m_pMesh->getTriangleVertices(closest.m_uTriangle);
+    const float bary[3] = { closest.m_vBarycentric.x, closest.m_vBarycentric.y, closest.m_vBarycentric.z };
+    const uint32_t corners[3] = { tri.x, tri.y, tri.z };
+    int nZero = 0, zeroCorner = -1, nonZeroCorner = -1;
+    for (int k = 0; k < 3; ++k)
+    {
+        if (bary[k] == 0.0f)
+        {
+            ++nZero;
+            zeroCorner = k;
+        }
+        else
+        {
+            nonZeroCorner = k;
+        }
+    }
+
+    float3 normal;
+    if (nZero >= 2)
+        normal = m_vertexPseudoNormals[corners[nonZeroCorner]];
+    else if (nZero == 1)
+        normal = m_edgePseudoNormals[3 * closest.m_uTriangle + (zeroCorner + 1) % 3];
+    else
+        normal = m_facePseudoNormals[closest.m_uTriangle];
+
+    return (dot(vPos - closest.m_vPoint, normal) * m_fOrientation >= 0.0f) ? 1.0f : -1.0f;
+}
+
+float BVHMesh::computeSignedDistance(const float3& vPos, ClosestPoint* pClosest) const
+{
+    const ClosestPoint closest = findClosestSurfacePoint(vPos);
+    if (pClosest)
+        *pClosest = closest;
+    if (!closest.isValid())
+        return std::numeric_limits<float>::max();
+    return getSide(vPos, closest) * closest.m_fDistance;
+}
+
+void BVHMesh::computeSignedDistances(const std::vector<float3>& positions, std::vector<float>& distances) const
+{
+    std::vector<ClosestPoint> closest;
+    findClosestSurfacePoints(positions, closest);
+    distances.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        distances[i] = closest[i].isValid() ? getSide(positions[i], closest[i]) * closest[i].m_fDistance
+                                            : std::numeric_limits<float>::max();
+    }
+}
+
+void BVHMesh::updatePseudoNormals() const
+{
+    if (m_pseudoNormalVersion.load(std::memory_order_acquire) == m_pMesh->getVersion())
+        return;
+    std::lock_guard<std::mutex> lock(m_pseudoNormalMutex);
+    if (m_pseudoNormalVersion.load(std::memory_order_relaxed) == m_pMesh->getVersion())
+        return;
+
+    const Vertices& vertices = *m_pMesh->getVertices();
+    const uint32_t nTriangles = m_pMesh->getTriangleCount();
+    m_facePseudoNormals.assign(nTriangles, float3(0, 0, 0));
+    m_edgePseudoNormals.assign(3 * static_cast<size_t>(nTriangles), float3(0, 0, 0));
+    m_vertexPseudoNormals.assign(vertices.getVertexCount(), float3(0, 0, 0));
+
+    // Face normals, angle-weighted vertex normals and per-edge sums of the adjacent face normals
+    const auto pEdges = m_pMesh->getOrCreateEdges();
+    std::vector<float3>& edgeNormalSums = m_edgeNormalSums;
+    edgeNormalSums.assign(pEdges->getEdgeCount(), float3(0, 0, 0));
+    double signedVolume = 0.0;
+    for (uint32_t t = 0; t < nTriangles; ++t)
+    {
+        const uint3 tri = m_pMesh->getTriangleVertices(t);
+        const uint32_t corners[3] = { tri.x, tri.y, tri.z };
+        const float3 p[3] = {
+            vertices.getVertexPosition(tri.x),
+            vertices.getVertexPosition(tri.y),
+            vertices.getVertexPosition(tri.z)
+        };
+        const float3 n = cross(p[1] - p[0], p[2] - p[0]);
+        const float len = length(n);
+        if (len <= 0.0f)
+            continue;
+        const float3 faceNormal = n / len;
+        m_facePseudoNormals[t] = faceNormal;
+        signedVolume += dot(p[0], cross(p[1], p[2]));
+
+        for (int k = 0; k < 3; ++k)
+        {
+            const float3 e0 = p[(k + 1) % 3] - p[k];
+            const float3 e1 = p[(k + 2) % 3] - p[k];
+            const float cosAngle = dot(e0, e1) / std::max(length(e0) * length(e1), 1e-30f);
+            const float angle = std::acos(std::clamp(cosAngle, -1.0f, 1.0f));
+            m_vertexPseudoNormals[corners[k]] += faceNormal * angle;
+            edgeNormalSums[pEdges->getTriangleEdge(t, k)] += faceNormal;
+        }
+    }
+    for (uint32_t t = 0; t < nTriangles; ++t)
+    {
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            m_edgePseudoNormals[3 * t + k] = edgeNormalSums[pEdges->getTriangleEdge(t, k)];
+        }
+    }
+
+    m_fOrientation = (signedVolume < 0.0) ? -1.0f : 1.0f;
+    m_pseudoNormalVersion.store(m_pMesh->getVersion(), std::memory_order_release);
+}
@@ -2,8 +2,15 @@
 
 #include "geometry/BVH/BVH.h"
 #include "geometry/mesh/TriangleMesh.h"
+#include <atomic>
 #include <cassert>
+#include <limits>
+#include <mutex>
+#include <vector>
 
+// Queries are const and may run concurrently from several threads, provided nobody modifies the
+// mesh or calls rebuild/refit on the same BVHMesh meanwhile. To update a BVHMesh that others may be
+// tracing, refit a clone() and publish it instead (see BVHCache).
 class BVHMesh : public ITraceableObject
 {
 public:
@@ -13,21 +20,94 @@ public:
     virtual box3 getBox() const override;
     virtual box3 getSubObjectBox(uint32_t uSubObj) const override;
     virtual void trace(IRay& ray, uint32_t triangleIndex) const override;
+    // Tests the leaf's triangles RayPacket::WIDTH at a time
+    virtual void traceLeaf(IRay& ray, const uint32_t* pTriangles, uint32_t nTriangles) const override;
+    // Same test as trace(), evaluated for all packet lanes at once
+    virtual void tracePacket(RayPacket& packet, uint32_t triangleIndex, uint32_t uLaneMask) const override;
+    virtual void findClosestPoint(IPointQuery& query, uint32_t triangleIndex) const override;
+
+    // Closest point on the mesh surface
+    struct ClosestPoint
+    {
+        float3 m_vPoint = float3(0, 0, 0);
+        float3 m_vBarycentric = float3(0, 0, 0);  // of m_vPoint within m_uTriangle
+        uint32_t m_uTriangle = TriangleMesh::INVALID_INDEX;
+        float m_fDistance = std::numeric_limits<float>::max();
+
+        bool isValid() const { return m_uTriangle != TriangleMesh::INVALID_INDEX; }
+    };
+
+    // Closest surface point within fMaxDistance (invalid result if there is none)
+    ClosestPoint findClosestSurfacePoint(const float3& vPos, float fMaxDistance = std::numeric_limits<float>::max()) const;
+    // Batched variant: each query starts with the bound given by the previous point's result,
+    // so spatially coherent inputs prune most of the tree immediately
+    void findClosestSurfacePoints(const std::vector<float3>& positions, std::vector<ClosestPoint>& results,
+                                  float fMaxDistance = std::numeric_limits<float>::max()) const;
+
+    // Signed distance to the surface, negative inside. The sign comes from angle-weighted
+    // pseudo-normals of the closest feature, which is exact for closed manifold meshes.
+    float computeSignedDistance(const float3& vPos, ClosestPoint* pClosest = nullptr) const;
+    void computeSignedDistances(const std::vector<float3>& positions, std::vector<float>& distances) const;
+    // +1 if vPos is outside the surface, -1 if inside, given its closest surface point
+    float getSide(const float3& vPos, const ClosestPoint& closest) const;
 
     const BVH &getBVH() const {
         assert(m_pMesh && "BVHMesh must have a valid TriangleMesh");
-        assert(m_debugVersion == m_pMesh->getVersion() && "BVHMesh BVH is out of sync with TriangleMesh version");
+        assert(m_builtVersion == m_pMesh->getVersion() && "BVHMesh BVH is out of sync with TriangleMesh version");
         return m_bvh;
     }
 
+    // Independent copy of the tree and triangle data for the same mesh. Refitting the copy does not
+    // disturb queries running on this object.
+    std::shared_ptr<BVHMesh> clone() const;
+
     // Rebuild BVH to match current TriangleMesh topology
     void rebuildForCurrentMesh();
+
+    // Update BVH bounds for moved vertices when the topology is unchanged. Falls back to a full
+    // rebuild when the refitted tree's SAH cost grows past REFIT_MAX_SAH_GROWTH times its build cost.
+    // Returns true if the tree was refitted, false if it had to be rebuilt.
+    bool refitForCurrentMesh();
+
+    // Topology version of the mesh the BVH was last built for
+    uint64_t getBuiltTopologyVersion() const { return m_builtTopologyVersion; }
+    // Mesh version the BVH was last built or refitted for
+    uint64_t getBuiltVersion() const { return m_builtVersion; }
     
-    std::shared_ptr<TriangleMesh> getMesh() const { return m_pMesh; }
+    const std::shared_ptr<TriangleMesh>& getMesh() const { return m_pMesh; }
+
+    static constexpr float REFIT_MAX_SAH_GROWTH = 1.5f;
 
 private:
     std::shared_ptr<TriangleMesh> m_pMesh;
     BVH m_bvh;
-    uint64_t m_debugVersion = 0;
+    uint64_t m_builtTopologyVersion = UINT64_MAX;
+    uint64_t m_builtVersion = UINT64_MAX;
+
+    BVHMesh(const BVHMesh& other);
+    std::shared_ptr<ITraceableObject> selfReference();
+
+    // Möller-Trumbore inputs (first vertex and the two edges from it) of every triangle, stored
+    // structure-of-arrays in BVH leaf order so that a leaf is a contiguous run of slots loaded
+    // straight into SIMD registers. Refreshed whenever the BVH is rebuilt or refitted.
+    enum TriangleComponent { V0X, V0Y, V0Z, E1X, E1Y, E1Z, E2X, E2Y, E2Z, TRIANGLE_COMPONENT_COUNT };
+    std::vector<float> m_triangleData;      // component c of slot i is at c * m_triangleDataStride + i
+    uint32_t m_triangleDataStride = 0;      // slot count plus zero padding for full-width loads
+    std::vector<uint32_t> m_triangleSlots;  // triangle index -> slot
+
+    const float* getTriangleComponent(TriangleComponent c) const { return &m_triangleData[c * m_triangleDataStride]; }
+    void updateTriangleData();
+
+    // Pseudo-normals for inside/outside classification, computed on the first signed query after
+    // the mesh changed (under m_pseudoNormalMutex, so concurrent readers compute them once).
+    // Edge k of a triangle joins its corners k and k + 1.
+    mutable std::vector<float3> m_facePseudoNormals;
+    mutable std::vector<float3> m_edgePseudoNormals;   // 3 per triangle
+    mutable std::vector<float3> m_vertexPseudoNormals;
+    mutable float m_fOrientation = 1.0f;               // -1 if triangles are wound inwards
+    mutable std::vector<float3> m_edgeNormalSums;      // scratch: sum of the face normals per edge
+    mutable std::atomic<uint64_t> m_pseudoNormalVersion = UINT64_MAX;
+    mutable std::mutex m_pseudoNormalMutex;
+    void updatePseudoNormals() const;
 };
 
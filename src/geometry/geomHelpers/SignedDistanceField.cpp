@@ -0,0 +1,208 @@
+#include "SignedDistanceField.h"
+#include "BVHMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SignedDistanceField::SignedDistanceField(uint32_t resolution, uint32_t bandCells, float rebuildToleranceCells)
+    : m_resolution(std::max(2u, resolution))
+    , m_bandCells(std::max(1u, bandCells))
+    , m_fRebuildToleranceCells(rebuildToleranceCells)
+{
+}
+
+bool SignedDistanceField::update(const BVHMesh& bvhMesh)
+{
+    const TriangleMesh& mesh = *bvhMesh.getMesh();
+    if (m_meshId == mesh.getId() && m_checkedVersion == mesh.getVersion())
+        return false;
+
+    const Vertices& vertices = *mesh.getVertices();
+    bool bRebuild = m_meshId != mesh.getId() || m_builtTopologyVersion != mesh.getTopologyVersion();
+    if (!bRebuild)
+    {
+        // Positions moved: keep the field while every vertex stays within the tolerance. A single
+        // position write since the last check only adds its maximum displacement to the bound;
+        // vertices are compared one by one only when the bound is exceeded or unknown.
+        const float fTolerance = m_fRebuildToleranceCells * m_fCellSize;
+        const Vertices::PositionChange& change = vertices.getLastPositionChange();
+        if (change.m_fromVersion == m_checkedVertexVersion && change.m_toVersion == vertices.getVersion())
+            m_fDisplacementBound += change.m_fMaxDisplacement;
+        else
+            m_fDisplacementBound = std::numeric_limits<float>::infinity();
+        if (m_fDisplacementBound > fTolerance)
+            m_fDisplacementBound = computeMaxDisplacement(vertices);
+        bRebuild = m_fDisplacementBound > fTolerance;
+    }
+
+    m_checkedVersion = mesh.getVersion();
+    m_checkedVertexVersion = vertices.getVersion();
+    if (!bRebuild)
+        return false;
+
+    rebuild(bvhMesh);
+    return true;
+}
+
+float SignedDistanceField::computeMaxDisplacement(const Vertices& vertices) const
+{
+    float fMaxSq = 0.0f;
+    for (uint32_t i = 0; i < vertices.getVertexCount(); ++i)
+    {
+        const float3 d = vertices.getVertexPosition(i) - m_builtPositions[i];
+        fMaxSq = std::max(fMaxSq, dot(d, d));
+    }
+    return std::sqrt(fMaxSq);
+}
+
+void SignedDistanceField::rebuild(const BVHMesh& bvhMesh)
+{
+    const TriangleMesh& mesh = *bvhMesh.getMesh();
+    const Vertices& vertices = *mesh.getVertices();
+
+    m_meshId = mesh.getId();
+    m_builtTopologyVersion = mesh.getTopologyVersion();
+    m_fDisplacementBound = 0.0f;
+    m_builtPositions.resize(vertices.getVertexCount());
+    for (uint32_t i = 0; i < vertices.getVertexCount(); ++i)
+    {
+        m_builtPositions[i] = vertices.getVertexPosition(i);
+    }
+
+    const box3 meshBox = mesh.getBox();
+    if (mesh.getTriangleCount() == 0 || meshBox.isempty())
+    {
+        m_values.clear();
+        return;
+    }
+
+    // Grid covers the mesh box plus the band and one cell, so every node outside the band is
+    // separated from the surface by band nodes and the grid border is outside the mesh
+    const float3 extent = meshBox.m_maxs - meshBox.m_mins;
+    m_fCellSize = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f)) / m_resolution;
+    m_fBandWidth = m_bandCells * m_fCellSize;
+    const float fMargin = m_fBandWidth + m_fCellSize;
+    m_gridBox = box3(meshBox.m_mins - float3(fMargin, fMargin, fMargin), meshBox.m_maxs + float3(fMargin, fMargin, fMargin));
+    for (int a = 0; a < 3; ++a)
+    {
+        m_dims[a] = static_cast<uint32_t>(std::ceil((m_gridBox.m_maxs[a] - m_gridBox.m_mins[a]) / m_fCellSize)) + 1;
+    }
+    const size_t nNodes = static_cast<size_t>(m_dims[0]) * m_dims[1] * m_dims[2];
+
+    // Mark nodes inside the band-expanded box of any triangle
+    m_bandMask.assign(nNodes, 0);
+    for (uint32_t t = 0; t < mesh.getTriangleCount(); ++t)
+    {
+        const uint3 tri = mesh.getTriangleVertices(t);
+        const float3 v0 = vertices.getVertexPosition(tri.x);
+        const float3 v1 = vertices.getVertexPosition(tri.y);
+        const float3 v2 = vertices.getVertexPosition(tri.z);
+        const float3 lo = min(min(v0, v1), v2) - float3(m_fBandWidth, m_fBandWidth, m_fBandWidth) - m_gridBox.m_mins;
+        const float3 hi = max(max(v0, v1), v2) + float3(m_fBandWidth, m_fBandWidth, m_fBandWidth) - m_gridBox.m_mins;
+        uint32_t iLo[3], iHi[3];
+        for (int a = 0; a < 3; ++a)
+        {
+            iLo[a] = static_cast<uint32_t>(std::max(0.0f, std::ceil(lo[a] / m_fCellSize)));
+            iHi[a] = std::min(m_dims[a] - 1, static_cast<uint32_t>(std::max(0.0f, std::floor(hi[a] / m_fCellSize))));
+        }
+        for (uint32_t z = iLo[2]; z <= iHi[2]; ++z)
+        for (uint32_t y = iLo[1]; y <= iHi[1]; ++y)
+        for (uint32_t x = iLo[0]; x <= iHi[0]; ++x)
+        {
+            m_bandMask[nodeIndex(x, y, z)] = 1;
+        }
+    }
+
+    // Exact signed distances for band nodes, queried in grid order so consecutive queries are close
+    m_bandNodes.clear();
+    m_bandPositions.clear();
+    for (uint32_t z = 0; z < m_dims[2]; ++z)
+    for (uint32_t y = 0; y < m_dims[1]; ++y)
+    for (uint32_t x = 0; x < m_dims[0]; ++x)
+    {
+        const uint32_t uNode = nodeIndex(x, y, z);
+        if (m_bandMask[uNode])
+        {
+            m_bandNodes.push_back(uNode);
+            m_bandPositions.push_back(nodePosition(x, y, z));
+        }
+    }
+    bvhMesh.computeSignedDistances(m_bandPositions, m_bandDistances);
+
+    m_values.assign(nNodes, 0.0f);
+    for (size_t i = 0; i < m_bandNodes.size(); ++i)
+    {
+        m_values[m_bandNodes[i]] = std::clamp(m_bandDistances[i], -m_fBandWidth, m_fBandWidth);
+    }
+
+    // Nodes outside the band take the sign of the last band node along their x row; rows start
+    // at the grid border, which is outside the mesh
+    for (uint32_t z = 0; z < m_dims[2]; ++z)
+    for (uint32_t y = 0; y < m_dims[1]; ++y)
+    {
+        float fSign = 1.0f;
+        for (uint32_t x = 0; x < m_dims[0]; ++x)
+        {
+            const uint32_t uNode = nodeIndex(x, y, z);
+            if (m_bandMask[uNode])
+                fSign = (m_values[uNode] < 0.0f) ? -1.0f : 1.0f;
+            else
+                m_values[uNode] = fSign * m_fBandWidth;
+        }
+    }
+}
+
+bool SignedDistanceField::locate(const float3& pos, uint32_t cell[3], float3& frac) const
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        const float f = (pos[a] - m_gridBox.m_mins[a]) / m_fCellSize;
+        if (!(f >= 0.0f && f <= float(m_dims[a] - 1)))
+            return false;
+        cell[a] = std::min(static_cast<uint32_t>(f), m_dims[a] - 2);
+        frac[a] = f - float(cell[a]);
+    }
+    return true;
+}
+
+float SignedDistanceField::sample(const float3& pos) const
+{
+    uint32_t c[3];
+    float3 f;
+    if (!isValid() || !locate(pos, c, f))
+        return m_fBandWidth;  // the grid encloses the mesh with margin: everything outside is outside
+
+    const float* v = m_values.data();
+    const uint32_t sx = 1, sy = m_dims[0], sz = m_dims[0] * m_dims[1];
+    const uint32_t i = nodeIndex(c[0], c[1], c[2]);
+    const float c00 = v[i] + (v[i + sx] - v[i]) * f.x;
+    const float c10 = v[i + sy] + (v[i + sy + sx] - v[i + sy]) * f.x;
+    const float c01 = v[i + sz] + (v[i + sz + sx] - v[i + sz]) * f.x;
+    const float c11 = v[i + sz + sy] + (v[i + sz + sy + sx] - v[i + sz + sy]) * f.x;
+    const float c0 = c00 + (c10 - c00) * f.y;
+    const float c1 = c01 + (c11 - c01) * f.y;
+    return c0 + (c1 - c0) * f.z;
+}
+
+float3 SignedDistanceField::sampleGradient(const float3& pos) const
+{
+    uint32_t c[3];
+    float3 f;
+    if (!isValid() || !locate(pos, c, f))
+        return float3(0, 0, 0);
+
+    const float* v = m_values.data();
+    const uint32_t sx = 1, sy = m_dims[0], sz = m_dims[0] * m_dims[1];
+    const uint32_t i = nodeIndex(c[0], c[1], c[2]);
+    const float v000 = v[i], v100 = v[i + sx], v010 = v[i + sy], v110 = v[i + sy + sx];
+    const float v001 = v[i + sz], v101 = v[i + sz + sx], v011 = v[i + sz + sy], v111 = v[i + sz + sy + sx];
+
+    // Partial derivatives of the trilinear interpolant
+    const float dx = ((v100 - v000) * (1 - f.y) + (v110 - v010) * f.y) * (1 - f.z)
+                   + ((v101 - v001) * (1 - f.y) + (v111 - v011) * f.y) * f.z;
+    const float dy = ((v010 - v000) * (1 - f.x) + (v110 - v100) * f.x) * (1 - f.z)
+                   + ((v011 - v001) * (1 - f.x) + (v111 - v101) * f.x) * f.z;
+    const float dz = ((v001 - v000) * (1 - f.x) + (v101 - v100) * f.x) * (1 - f.y)
+                   + ((v011 - v010) * (1 - f.x) + (v111 - v110) * f.x) * f.y;
+    return float3(dx, dy, dz) / m_fCellSize;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "geometry/vectors/vector.h"
+#include "geometry/vectors/box.h"
+
+class BVHMesh;
+class Vertices;
+
+// Narrow-band signed distance field of a closed TriangleMesh, sampled on a regular grid around the
+// mesh box and queried by trilinear interpolation. Grid nodes within the band store exact signed
+// distances (from BVHMesh::computeSignedDistances); nodes farther away only keep the sign and
+// read as +/- band width. The field is rebuilt once the mesh topology changes or any vertex moved
+// farther than the rebuild tolerance since the last build, so slowly deforming meshes are rebuilt
+// only every few steps.
+class SignedDistanceField
+{
+public:
+    // resolution: grid cells along the longest axis of the mesh box
+    // bandCells: half-width of the exact band, in cells
+    // rebuildToleranceCells: vertex displacement (in cells) accepted before rebuilding
+    SignedDistanceField(uint32_t resolution = 32, uint32_t bandCells = 3, float rebuildToleranceCells = 0.25f);
+
+    // Bring the field in sync with the mesh of bvhMesh; returns true if it was rebuilt
+    bool update(const BVHMesh& bvhMesh);
+
+    bool isValid() const { return !m_values.empty(); }
+
+    // Signed distance (negative inside), clamped to +/- getBandWidth()
+    float sample(const float3& pos) const;
+    // Gradient of the interpolated field (approximately the outward surface normal within the band)
+    float3 sampleGradient(const float3& pos) const;
+
+    // True if pos is certainly inside the mesh and at least fDepth away from its surface
+    bool isInsideBy(const float3& pos, float fDepth) const { return isValid() && sample(pos) < -(fDepth + getMaxError()); }
+
+    float getCellSize() const { return m_fCellSize; }
+    float getBandWidth() const { return m_fBandWidth; }
+    // Bound on |sample() - true distance| inside the band: interpolation error of a 1-Lipschitz
+    // function over one cell plus the vertex motion tolerated since the last build
+    float getMaxError() const { return m_fCellSize * (std::sqrt(3.0f) + m_fRebuildToleranceCells); }
+
+private:
+    uint32_t m_resolution;
+    uint32_t m_bandCells;
+    float m_fRebuildToleranceCells;
+
+    box3 m_gridBox = box3::empty();
+    float m_fCellSize = 0.0f;
+    float m_fBandWidth = 0.0f;
+    uint32_t m_dims[3] = { 0, 0, 0 };     // node counts per axis
+    std::vector<float> m_values;          // node values, x fastest
+
+    // Mesh state at the last build
+    uint64_t m_meshId = UINT64_MAX;
+    uint64_t m_builtTopologyVersion = UINT64_MAX;
+    uint64_t m_checkedVersion = UINT64_MAX;
+    uint64_t m_checkedVertexVersion = UINT64_MAX;
+    std::vector<float3> m_builtPositions;
+    float m_fDisplacementBound = 0.0f;    // upper bound on vertex motion since the build
+
+    // Build scratch
+    std::vector<uint8_t> m_bandMask;
+    std::vector<uint32_t> m_bandNodes;
+    std::vector<float3> m_bandPositions;
+    std::vector<float> m_bandDistances;
+
+    void rebuild(const BVHMesh& bvhMesh);
+    float computeMaxDisplacement(const Vertices& vertices) const;
+    uint32_t nodeIndex(uint32_t x, uint32_t y, uint32_t z) const { return x + m_dims[0] * (y + m_dims[1] * z); }
+    float3 nodePosition(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        return m_gridBox.m_mins + float3(float(x), float(y), float(z)) * m_fCellSize;
+    }
+    // Cell containing pos and the fractional position inside it; false outside the grid
+    bool locate(const float3& pos, uint32_t cell[3], float3& frac) const;
+};
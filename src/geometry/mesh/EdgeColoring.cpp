@@ -0,0 +1,60 @@
+#include "EdgeColoring.h"
+#include "Edges.h"
+#include <algorithm>
+#include <bit>
+
+std::shared_ptr<EdgeColoring> EdgeColoring::computeColoring(const Edges& edges) {
+    auto coloring = std::shared_ptr<EdgeColoring>(new EdgeColoring());
+    coloring->m_topologyVersion = edges.getTopologyVersion();
+
+    const uint32_t vertexCount = edges.getVertexCount();
+    const uint32_t edgeCount = edges.getEdgeCount();
+    uint32_t maxValence = 0;
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        maxValence = std::max(maxValence, static_cast<uint32_t>(edges.getVertexEdges(v).size()));
+    }
+
+    // Bit masks of the colors already used at every vertex
+    const uint32_t maxColors = (maxValence > 0) ? 2 * maxValence - 1 : 1;
+    const uint32_t maskWords = (maxColors + 63) / 64;
+    std::vector<uint64_t> usedColors(size_t(vertexCount) * maskWords, 0);
+    std::vector<uint32_t> edgeColors(edgeCount);
+    uint32_t colorCount = 0;
+    for (uint32_t e = 0; e < edgeCount; ++e) {
+        const auto ab = edges.getEdge(e);
+        uint64_t* pA = &usedColors[size_t(ab.first) * maskWords];
+        uint64_t* pB = &usedColors[size_t(ab.second) * maskWords];
+        uint32_t color = 0;
+        for (uint32_t w = 0; w < maskWords; ++w) {
+            const uint64_t freeColors = ~(pA[w] | pB[w]);
+            if (freeColors != 0) {
+                color = 64 * w + static_cast<uint32_t>(std::countr_zero(freeColors));
+                break;
+            }
+        }
+        pA[color / 64] |= uint64_t(1) << (color % 64);
+        pB[color / 64] |= uint64_t(1) << (color % 64);
+        edgeColors[e] = color;
+        colorCount = std::max(colorCount, color + 1);
+    }
+
+    // Group edges by color (counting sort keeps them ascending within a color)
+    coloring->m_colorOffsets.assign(colorCount + 1, 0);
+    for (uint32_t color : edgeColors) {
+        ++coloring->m_colorOffsets[color + 1];
+    }
+    for (uint32_t c = 0; c < colorCount; ++c) {
+        coloring->m_colorOffsets[c + 1] += coloring->m_colorOffsets[c];
+    }
+    coloring->m_colorEdges.resize(edgeCount);
+    std::vector<uint32_t> cursor(coloring->m_colorOffsets.begin(), coloring->m_colorOffsets.end() - 1);
+    for (uint32_t e = 0; e < edgeCount; ++e) {
+        coloring->m_colorEdges[cursor[edgeColors[e]]++] = e;
+    }
+    return coloring;
+}
+
+std::span<const uint32_t> EdgeColoring::getColorEdges(uint32_t color) const {
+    const uint32_t begin = m_colorOffsets[color];
+    return std::span<const uint32_t>(m_colorEdges.data() + begin, m_colorOffsets[color + 1] - begin);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <span>
+#include <cstdint>
+
+class Edges;
+
+// Partition of the edges of a mesh into colors such that no two edges of one color share a vertex.
+// Per-edge kernels that scatter into both endpoints can then run over one color in parallel without
+// atomics, and a vertex receives its contributions in color order however the colors are split
+// between threads. Greedy coloring in edge order: at most 2 * (max valence) - 1 colors.
+class EdgeColoring
+{
+public:
+    static std::shared_ptr<EdgeColoring> computeColoring(const Edges& edges);
+
+    uint32_t getColorCount() const { return static_cast<uint32_t>(m_colorOffsets.size()) - 1; }
+    // Edges of a color, ascending
+    std::span<const uint32_t> getColorEdges(uint32_t color) const;
+    uint32_t getEdgeCount() const { return static_cast<uint32_t>(m_colorEdges.size()); }
+    // Topology version of the Edges it was computed from
+    uint64_t getTopologyVersion() const { return m_topologyVersion; }
+
+private:
+    EdgeColoring() = default;
+
+    std::vector<uint32_t> m_colorOffsets;   // size colors + 1
+    std::vector<uint32_t> m_colorEdges;     // size E, grouped by color
+    uint64_t m_topologyVersion = UINT64_MAX;
+};
@@ -1,39 +1,98 @@
 #include "Edges.h"
 #include "TriangleMesh.h"
+#include <algorithm>
 
 Edges::Edges() {
 }
 
 std::shared_ptr<Edges> Edges::computeEdges(const TriangleMesh& mesh) {
     auto edges = std::shared_ptr<Edges>(new Edges());
-    
-    std::unordered_map<uint64_t, uint32_t> edgeMap;
-    
+
+    const uint32_t vertexCount = mesh.getVertices()->getVertexCount();
     const uint32_t triangleCount = mesh.getTriangleCount();
-    for (uint32_t i = 0; i < triangleCount; ++i) {
-        uint3 triangle = mesh.getTriangleVertices(i);
-        edges->addEdge(triangle.x, triangle.y, edgeMap);
-        edges->addEdge(triangle.y, triangle.z, edgeMap);
-        edges->addEdge(triangle.z, triangle.x, edgeMap);
+    const uint32_t halfEdgeCount = 3 * triangleCount;
+    edges->m_topologyVersion = mesh.getTopologyVersion();
+
+    // Half-edge h = 3 * triangle + k runs from corner k to corner (k + 1) % 3
+    std::vector<uint32_t> halfEdgeLo(halfEdgeCount), halfEdgeHi(halfEdgeCount);
+    for (uint32_t t = 0; t < triangleCount; ++t) {
+        const uint3 triangle = mesh.getTriangleVertices(t);
+        const uint32_t corners[3] = { triangle.x, triangle.y, triangle.z };
+        for (uint32_t k = 0; k < 3; ++k) {
+            const uint32_t a = corners[k];
+            const uint32_t b = corners[(k + 1) % 3];
+            halfEdgeLo[3 * t + k] = std::min(a, b);
+            halfEdgeHi[3 * t + k] = std::max(a, b);
+        }
     }
-    
-    return edges;
-}
 
-uint32_t Edges::addEdge(uint32_t startVertex, uint32_t endVertex, std::unordered_map<uint64_t, uint32_t>& edgeMap) {
-    auto key = directionlessEdgeKey(startVertex, endVertex);
-    auto it = edgeMap.find(key);
-    
-    if (it != edgeMap.end()) {
-        return it->second;
+    // Counting sort of half-edges by their smaller vertex, then by the larger one within each bucket
+    // (buckets hold the few edges of a vertex's one-ring, so insertion sort is linear overall)
+    std::vector<uint32_t> bucketOffsets(vertexCount + 1, 0);
+    for (uint32_t h = 0; h < halfEdgeCount; ++h) {
+        ++bucketOffsets[halfEdgeLo[h] + 1];
+    }
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        bucketOffsets[v + 1] += bucketOffsets[v];
+    }
+    std::vector<uint32_t> sorted(halfEdgeCount);
+    {
+        std::vector<uint32_t> cursor(bucketOffsets.begin(), bucketOffsets.end() - 1);
+        for (uint32_t h = 0; h < halfEdgeCount; ++h) {
+            sorted[cursor[halfEdgeLo[h]]++] = h;
+        }
+    }
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        for (uint32_t i = bucketOffsets[v] + 1; i < bucketOffsets[v + 1]; ++i) {
+            const uint32_t h = sorted[i];
+            uint32_t j = i;
+            for (; j > bucketOffsets[v] && halfEdgeHi[sorted[j - 1]] > halfEdgeHi[h]; --j) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = h;
+        }
+    }
+
+    // Runs of equal (lo, hi) form one edge; its half-edges give the adjacent triangles
+    edges->edges.reserve(halfEdgeCount / 2 + 1);
+    edges->m_edgeTriangleOffsets.reserve(halfEdgeCount / 2 + 2);
+    edges->m_edgeTriangles.resize(halfEdgeCount);
+    edges->m_triangleEdges.resize(halfEdgeCount);
+    for (uint32_t i = 0; i < halfEdgeCount; ++i) {
+        const uint32_t h = sorted[i];
+        if (i == 0 || halfEdgeLo[h] != halfEdgeLo[sorted[i - 1]] || halfEdgeHi[h] != halfEdgeHi[sorted[i - 1]]) {
+            edges->edges.emplace_back(halfEdgeLo[h], halfEdgeHi[h]);
+            edges->m_edgeTriangleOffsets.push_back(i);
+        }
+        edges->m_edgeTriangles[i] = h / 3;
+        edges->m_triangleEdges[h] = static_cast<uint32_t>(edges->edges.size() - 1);
+    }
+    edges->m_edgeTriangleOffsets.push_back(halfEdgeCount);
+
+    // Vertex -> edges: every edge is listed at both endpoints, in increasing edge order
+    const uint32_t edgeCount = edges->getEdgeCount();
+    edges->m_vertexEdgeOffsets.assign(vertexCount + 1, 0);
+    for (const Edge& edge : edges->edges) {
+        ++edges->m_vertexEdgeOffsets[edge.startVertex + 1];
+        ++edges->m_vertexEdgeOffsets[edge.endVertex + 1];
+    }
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        edges->m_vertexEdgeOffsets[v + 1] += edges->m_vertexEdgeOffsets[v];
+    }
+    edges->m_vertexEdges.resize(2 * edgeCount);
+    edges->m_vertexNeighbors.resize(2 * edgeCount);
+    std::vector<uint32_t> cursor(edges->m_vertexEdgeOffsets.begin(), edges->m_vertexEdgeOffsets.end() - 1);
+    for (uint32_t e = 0; e < edgeCount; ++e) {
+        const Edge& edge = edges->edges[e];
+        const uint32_t startSlot = cursor[edge.startVertex]++;
+        edges->m_vertexEdges[startSlot] = e;
+        edges->m_vertexNeighbors[startSlot] = edge.endVertex;
+        const uint32_t endSlot = cursor[edge.endVertex]++;
+        edges->m_vertexEdges[endSlot] = e;
+        edges->m_vertexNeighbors[endSlot] = edge.startVertex;
     }
-    
-    edges.emplace_back(startVertex, endVertex);
-    uint32_t edgeIndex = static_cast<uint32_t>(edges.size() - 1);
-    
-    edgeMap[key] = edgeIndex;
-    
-    return edgeIndex;
+
+    return edges;
 }
 
 uint32_t Edges::getEdgeCount() const {
@@ -48,6 +107,36 @@ std::pair<uint32_t, uint32_t> Edges::getEdge(uint32_t edgeIndex) const {
     return std::make_pair(INVALID_INDEX, INVALID_INDEX);
 }
 
+std::span<const uint32_t> Edges::getVertexEdges(uint32_t vertexIndex) const {
+    const uint32_t begin = m_vertexEdgeOffsets[vertexIndex];
+    return std::span<const uint32_t>(m_vertexEdges.data() + begin, m_vertexEdgeOffsets[vertexIndex + 1] - begin);
+}
+
+std::span<const uint32_t> Edges::getVertexNeighbors(uint32_t vertexIndex) const {
+    const uint32_t begin = m_vertexEdgeOffsets[vertexIndex];
+    return std::span<const uint32_t>(m_vertexNeighbors.data() + begin, m_vertexEdgeOffsets[vertexIndex + 1] - begin);
+}
+
+std::span<const uint32_t> Edges::getEdgeTriangles(uint32_t edgeIndex) const {
+    const uint32_t begin = m_edgeTriangleOffsets[edgeIndex];
+    return std::span<const uint32_t>(m_edgeTriangles.data() + begin, m_edgeTriangleOffsets[edgeIndex + 1] - begin);
+}
+
+uint32_t Edges::findEdge(uint32_t v1, uint32_t v2) const {
+    const uint32_t lo = std::min(v1, v2);
+    const uint32_t hi = std::max(v1, v2);
+    if (hi >= getVertexCount()) {
+        return INVALID_INDEX;
+    }
+    const std::span<const uint32_t> neighbors = getVertexNeighbors(lo);
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+        if (neighbors[i] == hi) {
+            return getVertexEdges(lo)[i];
+        }
+    }
+    return INVALID_INDEX;
+}
+
 uint64_t Edges::directionalEdgeKey(uint32_t startVertex, uint32_t endVertex) {
     return ((uint64_t)endVertex << 32) | (uint64_t)startVertex;
 }
@@ -55,4 +144,3 @@ uint64_t Edges::directionalEdgeKey(uint32_t startVertex, uint32_t endVertex) {
 uint64_t Edges::directionlessEdgeKey(uint32_t v1, uint32_t v2) {
     return (v1 <= v2) ? directionalEdgeKey(v1, v2) : directionalEdgeKey(v2, v1);
 }
-
@@ -1,40 +1,66 @@
 #pragma once
 
 #include <vector>
-#include <unordered_map>
 #include <memory>
+#include <span>
 #include <cstdint>
 
 class TriangleMesh;
 
 struct Edge {
     static const uint32_t INVALID_INDEX = UINT32_MAX;
-    
+
     uint32_t startVertex;
     uint32_t endVertex;
-    
+
     Edge(uint32_t start, uint32_t end)
         : startVertex(start)
         , endVertex(end) {}
 };
 
+// Edge adjacency of a TriangleMesh in compressed (CSR) form. Edges are ordered by
+// (smaller vertex, larger vertex) and every adjacency query returns a contiguous index range:
+// vertex -> incident edges and one-ring neighbors, edge -> adjacent triangles,
+// triangle -> its three edges. Built by counting sort in time linear in the mesh size.
+// Depends on topology only; positions may change freely.
 class Edges : public std::enable_shared_from_this<Edges> {
 public:
     static const uint32_t INVALID_INDEX = UINT32_MAX;
-    
+
     static std::shared_ptr<Edges> computeEdges(const TriangleMesh& mesh);
-    
+
     uint32_t getEdgeCount() const;
+    // Edge vertices, smaller index first
     std::pair<uint32_t, uint32_t> getEdge(uint32_t edgeIndex) const;
-    
+
+    // Edges incident to a vertex; getVertexNeighbors() lists the opposite endpoints in the same order
+    std::span<const uint32_t> getVertexEdges(uint32_t vertexIndex) const;
+    std::span<const uint32_t> getVertexNeighbors(uint32_t vertexIndex) const;
+    // Triangles sharing an edge (two for closed manifold meshes)
+    std::span<const uint32_t> getEdgeTriangles(uint32_t edgeIndex) const;
+    // Edge k of a triangle joins its corners k and (k + 1) % 3
+    uint32_t getTriangleEdge(uint32_t triangleIndex, uint32_t k) const { return m_triangleEdges[3 * triangleIndex + k]; }
+    // Index of the edge between two vertices, or INVALID_INDEX
+    uint32_t findEdge(uint32_t v1, uint32_t v2) const;
+
+    uint32_t getVertexCount() const { return static_cast<uint32_t>(m_vertexEdgeOffsets.size()) - 1; }
+    uint64_t getTopologyVersion() const { return m_topologyVersion; }
+
     static uint64_t directionlessEdgeKey(uint32_t v1, uint32_t v2);
-    
+
 private:
     Edges();
-    
+
     std::vector<Edge> edges;
-    
-    uint32_t addEdge(uint32_t startVertex, uint32_t endVertex, std::unordered_map<uint64_t, uint32_t>& edgeMap);
+
+    // CSR adjacency
+    std::vector<uint32_t> m_vertexEdgeOffsets;    // size V + 1
+    std::vector<uint32_t> m_vertexEdges;          // size 2E
+    std::vector<uint32_t> m_vertexNeighbors;      // size 2E, other endpoint of m_vertexEdges
+    std::vector<uint32_t> m_edgeTriangleOffsets;  // size E + 1
+    std::vector<uint32_t> m_edgeTriangles;        // size 3F
+    std::vector<uint32_t> m_triangleEdges;        // size 3F
+    uint64_t m_topologyVersion = UINT64_MAX;
+
     static uint64_t directionalEdgeKey(uint32_t startVertex, uint32_t endVertex);
 };
-
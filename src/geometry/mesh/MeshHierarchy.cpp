@@ -0,0 +1,228 @@
+#include "MeshHierarchy.h"
+#include <algorithm>
+#include <cassert>
+
+MeshHierarchy::MeshHierarchy(const std::vector<std::shared_ptr<TriangleMesh>>& levels) {
+    assert(!levels.empty());
+    const uint32_t finestLevel = static_cast<uint32_t>(levels.size()) - 1;
+    const TriangleMesh& finest = *levels.back();
+    const Vertices& sharedVertices = *finest.getVertices();
+
+    m_coarseLevels.resize(finestLevel);
+    m_vertexParents.resize(finestLevel + 1);
+    m_triangleParents.resize(finestLevel + 1);
+    m_childOffsets.resize(finestLevel);
+    m_children.resize(finestLevel);
+    m_nextLevelVertex.resize(finestLevel);
+    m_finestVertex.resize(finestLevel);
+    m_restrictedVersions.assign(finestLevel, UINT64_MAX);
+
+    // subdivide() appends the midpoints to the shared vertices, so the vertices of a level are a
+    // prefix of those of every finer level
+    std::vector<uint32_t> levelVertexCounts(finestLevel + 1, 0);
+    for (uint32_t level = 0; level <= finestLevel; ++level) {
+        const TriangleMesh& mesh = *levels[level];
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); ++t) {
+            const uint3 triangle = mesh.getTriangleVertices(t);
+            levelVertexCounts[level] = std::max(levelVertexCounts[level], std::max(triangle.x, std::max(triangle.y, triangle.z)) + 1);
+        }
+    }
+
+    for (uint32_t level = 0; level < finestLevel; ++level) {
+        const TriangleMesh& coarse = *levels[level];
+        const TriangleMesh& fine = *levels[level + 1];
+        const uint32_t coarseVertexCount = levelVertexCounts[level];
+        const uint32_t coarseTriangleCount = coarse.getTriangleCount();
+        assert(fine.getTriangleCount() == 4 * coarseTriangleCount && "Levels must come from subdivide()");
+
+        // Separate copy of the coarse level
+        std::vector<float3> positions(coarseVertexCount);
+        std::vector<uint3> triangles(coarseTriangleCount);
+        for (uint32_t i = 0; i < coarseVertexCount; ++i) {
+            positions[i] = sharedVertices.getVertexPosition(i);
+        }
+        for (uint32_t t = 0; t < coarseTriangleCount; ++t) {
+            triangles[t] = coarse.getTriangleVertices(t);
+        }
+        auto pVertices = std::make_shared<Vertices>();
+        pVertices->assignPositions(positions);
+        m_coarseLevels[level] = std::make_shared<TriangleMesh>(pVertices);
+        m_coarseLevels[level]->setTriangles(std::move(triangles));
+
+        // Triangle t becomes 4t..4t+3: (v1, m12, m31), (m12, v2, m23), (m31, m23, v3), (m12, m23, m31)
+        std::vector<VertexParents>& parents = m_vertexParents[level + 1];
+        parents.assign(levelVertexCounts[level + 1], VertexParents{ INVALID_INDEX, INVALID_INDEX });
+        for (uint32_t i = 0; i < coarseVertexCount; ++i) {
+            parents[i] = VertexParents{ i, i };
+        }
+        m_triangleParents[level + 1].resize(fine.getTriangleCount());
+        for (uint32_t t = 0; t < coarseTriangleCount; ++t) {
+            const uint3 triangle = coarse.getTriangleVertices(t);
+            const uint3 corner1 = fine.getTriangleVertices(4 * t);
+            const uint3 corner2 = fine.getTriangleVertices(4 * t + 1);
+            assert(corner1.x == triangle.x && corner2.y == triangle.y && "Levels must come from subdivide()");
+            parents[corner1.y] = VertexParents{ triangle.x, triangle.y };
+            parents[corner2.z] = VertexParents{ triangle.y, triangle.z };
+            parents[corner1.z] = VertexParents{ triangle.z, triangle.x };
+            for (uint32_t k = 0; k < 4; ++k) {
+                m_triangleParents[level + 1][4 * t + k] = t;
+            }
+        }
+
+        m_nextLevelVertex[level].resize(coarseVertexCount);
+        m_finestVertex[level].resize(coarseVertexCount);
+        for (uint32_t i = 0; i < coarseVertexCount; ++i) {
+            m_nextLevelVertex[level][i] = i;
+            m_finestVertex[level][i] = i;
+        }
+        buildChildren(level);
+    }
+    m_finestTopologyVersion = finest.getTopologyVersion();
+}
+
+void MeshHierarchy::buildChildren(uint32_t uLevel) {
+    const std::vector<uint32_t>& parents = m_triangleParents[uLevel + 1];
+    std::vector<uint32_t>& offsets = m_childOffsets[uLevel];
+    std::vector<uint32_t>& children = m_children[uLevel];
+    offsets.assign(m_coarseLevels[uLevel]->getTriangleCount() + 1, 0);
+    for (uint32_t parent : parents) {
+        ++offsets[parent + 1];
+    }
+    for (size_t t = 1; t < offsets.size(); ++t) {
+        offsets[t] += offsets[t - 1];
+    }
+    children.resize(parents.size());
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (uint32_t child = 0; child < parents.size(); ++child) {
+        children[cursor[parents[child]]++] = child;
+    }
+}
+
+std::shared_ptr<TriangleMesh> MeshHierarchy::getCoarseLevel(uint32_t uLevel, const TriangleMesh& finest) const {
+    assert(uLevel < getFinestLevel() && isValidFor(finest));
+    const std::shared_ptr<TriangleMesh>& pLevel = m_coarseLevels[uLevel];
+    if (m_restrictedVersions[uLevel] != finest.getVersion()) {
+        const Vertices& finestVertices = *finest.getVertices();
+        const std::vector<uint32_t>& finestVertex = m_finestVertex[uLevel];
+        Vertices::PositionUpdate update = pLevel->getVertices()->beginPositionUpdate();
+        for (uint32_t i = 0; i < finestVertex.size(); ++i) {
+            update.set(i, finestVertices.getVertexPosition(finestVertex[i]));
+        }
+        update.commit();
+        m_restrictedVersions[uLevel] = finest.getVersion();
+    }
+    return pLevel;
+}
+
+std::span<const uint32_t> MeshHierarchy::getTriangleChildren(uint32_t uLevel, uint32_t triangleIndex) const {
+    const std::vector<uint32_t>& offsets = m_childOffsets[uLevel];
+    return std::span<const uint32_t>(m_children[uLevel].data() + offsets[triangleIndex],
+                                     offsets[triangleIndex + 1] - offsets[triangleIndex]);
+}
+
+uint32_t MeshHierarchy::getFinestVertex(uint32_t uLevel, uint32_t vertexIndex) const {
+    return (uLevel == getFinestLevel()) ? vertexIndex : m_finestVertex[uLevel][vertexIndex];
+}
+
+void MeshHierarchy::restrictToLevel(uint32_t uFromLevel, uint32_t uToLevel, const std::vector<float3>& values,
+                                    std::vector<float3>& result) const {
+    assert(uToLevel <= uFromLevel && uFromLevel <= getFinestLevel());
+    result = values;
+    std::vector<float3> coarse;
+    for (uint32_t level = uFromLevel; level > uToLevel; --level) {
+        const std::vector<uint32_t>& nextLevelVertex = m_nextLevelVertex[level - 1];
+        coarse.resize(nextLevelVertex.size());
+        for (size_t i = 0; i < coarse.size(); ++i) {
+            coarse[i] = result[nextLevelVertex[i]];
+        }
+        result.swap(coarse);
+    }
+}
+
+void MeshHierarchy::prolongToLevel(uint32_t uFromLevel, uint32_t uToLevel, const std::vector<float3>& values,
+                                   std::vector<float3>& result) const {
+    assert(uFromLevel <= uToLevel && uToLevel <= getFinestLevel());
+    result = values;
+    std::vector<float3> fine;
+    for (uint32_t level = uFromLevel + 1; level <= uToLevel; ++level) {
+        const std::vector<VertexParents>& parents = m_vertexParents[level];
+        fine.resize(parents.size());
+        for (size_t i = 0; i < fine.size(); ++i) {
+            const VertexParents& p = parents[i];
+            fine[i] = (p.m_uA == p.m_uB) ? result[p.m_uA] : (result[p.m_uA] + result[p.m_uB]) * 0.5f;
+        }
+        result.swap(fine);
+    }
+}
+
+void MeshHierarchy::applyDisplacements(uint32_t uLevel, const std::vector<float3>& displacements, TriangleMesh& finest) const {
+    assert(isValidFor(finest));
+    std::vector<float3> finestDisplacements;
+    prolongToLevel(uLevel, getFinestLevel(), displacements, finestDisplacements);
+    Vertices& vertices = *finest.getVertices();
+    Vertices::PositionUpdate update = vertices.beginPositionUpdate();
+    for (uint32_t i = 0; i < finestDisplacements.size(); ++i) {
+        update.set(i, vertices.getVertexPosition(i) + finestDisplacements[i]);
+    }
+}
+
+float MeshHierarchy::getApproximationError(uint32_t uLevel, const TriangleMesh& finest) const {
+    assert(uLevel <= getFinestLevel() && isValidFor(finest));
+    if (m_errorVersion != finest.getVersion()) {
+        // Largest detail of every level: offset of its midpoint vertices from their parent edge midpoints
+        const Vertices& vertices = *finest.getVertices();
+        const uint32_t finestLevel = getFinestLevel();
+        std::vector<float> details(finestLevel + 1, 0.0f);
+        for (uint32_t level = 1; level <= finestLevel; ++level) {
+            const std::vector<VertexParents>& parents = m_vertexParents[level];
+            for (uint32_t i = 0; i < parents.size(); ++i) {
+                const VertexParents& p = parents[i];
+                if (p.m_uA == p.m_uB) {
+                    continue;
+                }
+                const float3 midpoint = (vertices.getVertexPosition(getFinestVertex(level - 1, p.m_uA))
+                                       + vertices.getVertexPosition(getFinestVertex(level - 1, p.m_uB))) * 0.5f;
+                details[level] = std::max(details[level], length(vertices.getVertexPosition(getFinestVertex(level, i)) - midpoint));
+            }
+        }
+        m_approximationErrors.assign(finestLevel + 1, 0.0f);
+        for (uint32_t level = finestLevel; level > 0; --level) {
+            m_approximationErrors[level - 1] = m_approximationErrors[level] + details[level];
+        }
+        m_errorVersion = finest.getVersion();
+    }
+    return m_approximationErrors[uLevel];
+}
+
+void MeshHierarchy::remapFinest(const TriangleMesh::Reordering& reordering, const TriangleMesh& finest) {
+    const uint32_t finestLevel = getFinestLevel();
+    if (finestLevel == 0) {
+        m_finestTopologyVersion = finest.getTopologyVersion();
+        return;
+    }
+    const std::vector<uint32_t>& newVertex = reordering.m_newVertexIndex;
+    const std::vector<uint32_t>& newTriangle = reordering.m_newTriangleIndex;
+
+    std::vector<VertexParents> vertexParents(m_vertexParents[finestLevel].size());
+    for (size_t i = 0; i < vertexParents.size(); ++i) {
+        vertexParents[newVertex[i]] = m_vertexParents[finestLevel][i];
+    }
+    m_vertexParents[finestLevel] = std::move(vertexParents);
+
+    std::vector<uint32_t> triangleParents(m_triangleParents[finestLevel].size());
+    for (size_t t = 0; t < triangleParents.size(); ++t) {
+        triangleParents[newTriangle[t]] = m_triangleParents[finestLevel][t];
+    }
+    m_triangleParents[finestLevel] = std::move(triangleParents);
+
+    for (uint32_t& v : m_nextLevelVertex[finestLevel - 1]) {
+        v = newVertex[v];
+    }
+    for (std::vector<uint32_t>& finestVertex : m_finestVertex) {
+        for (uint32_t& v : finestVertex) {
+            v = newVertex[v];
+        }
+    }
+    buildChildren(finestLevel - 1);
+    m_finestTopologyVersion = finest.getTopologyVersion();
+}
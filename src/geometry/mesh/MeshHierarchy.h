@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <span>
+#include <cstdint>
+#include "geometry/vectors/vector.h"
+#include "TriangleMesh.h"
+
+// Nested subdivision levels of a mesh built by repeated TriangleMesh::subdivide(), with parent/child
+// maps between consecutive levels. Level 0 is the coarsest; the finest level is the mesh owning the
+// hierarchy (TriangleMesh::getLevel()) and is not stored here. Every vertex of a level is also a
+// vertex of all finer levels, the remaining vertices of a level are midpoints of edges of the next
+// coarser one, and every triangle has four children.
+// Coarse levels are separate meshes so they can be traced and queried on their own; their positions
+// follow the finest mesh by restriction when they are requested. Per-vertex values move between
+// levels by restriction (injection) and prolongation (linear interpolation at edge midpoints).
+class MeshHierarchy
+{
+public:
+    static const uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // A vertex of a level is the vertex m_uA of the next coarser level (m_uA == m_uB) or the
+    // midpoint of its edge (m_uA, m_uB)
+    struct VertexParents
+    {
+        uint32_t m_uA;
+        uint32_t m_uB;
+    };
+
+    // levels: meshes produced by repeated subdivide(), coarsest first, sharing one Vertices as
+    // subdivide() does. The last mesh is the finest level; the others are copied.
+    explicit MeshHierarchy(const std::vector<std::shared_ptr<TriangleMesh>>& levels);
+
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(m_coarseLevels.size()) + 1; }
+    uint32_t getFinestLevel() const { return static_cast<uint32_t>(m_coarseLevels.size()); }
+
+    // True while finest has the topology the hierarchy was built for (or last remapped to)
+    bool isValidFor(const TriangleMesh& finest) const { return finest.getTopologyVersion() == m_finestTopologyVersion; }
+
+    // Mesh of a coarse level (uLevel < getFinestLevel()) with positions restricted from finest
+    std::shared_ptr<TriangleMesh> getCoarseLevel(uint32_t uLevel, const TriangleMesh& finest) const;
+
+    // Parents in level uLevel - 1 of the vertices and triangles of level uLevel (1 <= uLevel <= finest)
+    const std::vector<VertexParents>& getVertexParents(uint32_t uLevel) const { return m_vertexParents[uLevel]; }
+    const std::vector<uint32_t>& getTriangleParents(uint32_t uLevel) const { return m_triangleParents[uLevel]; }
+    // Children in level uLevel + 1 of a triangle of level uLevel < finest
+    std::span<const uint32_t> getTriangleChildren(uint32_t uLevel, uint32_t triangleIndex) const;
+    // Vertex of the finest level that coincides with a vertex of level uLevel
+    uint32_t getFinestVertex(uint32_t uLevel, uint32_t vertexIndex) const;
+
+    // Per-vertex values of level uFromLevel to the coarser level uToLevel: every coarse vertex takes
+    // the value of the same vertex on uFromLevel
+    void restrictToLevel(uint32_t uFromLevel, uint32_t uToLevel, const std::vector<float3>& values,
+                         std::vector<float3>& result) const;
+    // Per-vertex values of level uFromLevel to the finer level uToLevel: midpoints take the mean of
+    // their edge ends, one level at a time
+    void prolongToLevel(uint32_t uFromLevel, uint32_t uToLevel, const std::vector<float3>& values,
+                        std::vector<float3>& result) const;
+    // Move finest by displacements given per vertex of level uLevel (prolonged to the finest level)
+    void applyDisplacements(uint32_t uLevel, const std::vector<float3>& displacements, TriangleMesh& finest) const;
+
+    // Bound on the distance between the surfaces of level uLevel and finest: the sum over all finer
+    // levels of the largest offset of a midpoint vertex from the midpoint of its parent edge
+    float getApproximationError(uint32_t uLevel, const TriangleMesh& finest) const;
+
+    // Follow a permutation of the vertices and triangles of the finest level
+    // (TriangleMesh::reorderSpatially()); coarse levels keep their order
+    void remapFinest(const TriangleMesh::Reordering& reordering, const TriangleMesh& finest);
+
+private:
+    std::vector<std::shared_ptr<TriangleMesh>> m_coarseLevels;
+    // Indexed by level; entry 0 is empty
+    std::vector<std::vector<VertexParents>> m_vertexParents;
+    std::vector<std::vector<uint32_t>> m_triangleParents;
+    // Indexed by coarse level: children in the next level (CSR), vertex in the next level, vertex in the finest level
+    std::vector<std::vector<uint32_t>> m_childOffsets;
+    std::vector<std::vector<uint32_t>> m_children;
+    std::vector<std::vector<uint32_t>> m_nextLevelVertex;
+    std::vector<std::vector<uint32_t>> m_finestVertex;
+    uint64_t m_finestTopologyVersion = UINT64_MAX;
+
+    // Finest mesh version each coarse level was last restricted from, and of the cached errors
+    mutable std::vector<uint64_t> m_restrictedVersions;
+    mutable std::vector<float> m_approximationErrors;
+    mutable uint64_t m_errorVersion = UINT64_MAX;
+
+    void buildChildren(uint32_t uLevel);
+};
@@ -0,0 +1,80 @@
+#include "MeshLaplacian.h"
+#include "TriangleMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+bool MeshLaplacian::updateForMesh(const TriangleMesh& mesh)
+{
+    if (m_meshId == mesh.getId() && m_meshVersion == mesh.getVersion())
+        return false;
+
+    const auto pVertices = mesh.getVertices();
+    const uint32_t nVertices = pVertices->getVertexCount();
+    const uint32_t nTriangles = mesh.getTriangleCount();
+
+    m_vertexAreas.assign(nVertices, 0.0);
+    m_triplets.clear();
+    m_triplets.reserve(static_cast<size_t>(nTriangles) * 9);
+
+    for (uint32_t t = 0; t < nTriangles; ++t)
+    {
+        const uint3 tri = mesh.getTriangleVertices(t);
+        const uint32_t idx[3] = { tri.x, tri.y, tri.z };
+        const double3 p[3] = {
+            double3(pVertices->getVertexPosition(tri.x)),
+            double3(pVertices->getVertexPosition(tri.y)),
+            double3(pVertices->getVertexPosition(tri.z))
+        };
+
+        const double doubleArea = length(cross(p[1] - p[0], p[2] - p[0]));
+        if (doubleArea <= 1e-12)
+            continue;
+
+        // Lumped mass: one third of the triangle area goes to each corner
+        for (int k = 0; k < 3; ++k)
+            m_vertexAreas[idx[k]] += doubleArea / 6.0;
+
+        // Each corner k contributes 0.5 * cot(angle at k) to the edge opposite to it.
+        // Negative cotangents (obtuse angles) are clamped so the operator stays an M-matrix
+        // and explicit steps cannot create negative concentrations.
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t i = idx[(k + 1) % 3];
+            const uint32_t j = idx[(k + 2) % 3];
+            const double3 e0 = p[(k + 1) % 3] - p[k];
+            const double3 e1 = p[(k + 2) % 3] - p[k];
+            const double cotAngle = dot(e0, e1) / doubleArea;
+            const double w = 0.5 * std::max(0.0, cotAngle);
+
+            m_triplets.push_back({ i, j, w });
+            m_triplets.push_back({ j, i, w });
+            m_triplets.push_back({ i, i, -w });
+            m_triplets.push_back({ j, j, -w });
+        }
+    }
+
+    m_stiffness.setFromTriplets(nVertices, nVertices, m_triplets);
+
+    m_meshId = mesh.getId();
+    m_meshVersion = mesh.getVersion();
+    ++m_buildVersion;
+    return true;
+}
+
+double MeshLaplacian::computeMaxStableExplicitStep(double diffusionCoeff) const
+{
+    if (diffusionCoeff <= 0.0)
+        return std::numeric_limits<double>::max();
+
+    // Positivity of u_i + dt * D / A_i * (L u)_i requires dt <= A_i / (D * |L_ii|)
+    double dtMax = std::numeric_limits<double>::max();
+    for (uint32_t i = 0; i < m_vertexAreas.size(); ++i)
+    {
+        const double diag = -m_stiffness.getDiagonal(i);
+        if (diag <= 0.0 || m_vertexAreas[i] <= 0.0)
+            continue;
+        dtMax = std::min(dtMax, m_vertexAreas[i] / (diffusionCoeff * diag));
+    }
+    return dtMax;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "SparseMatrix.h"
+
+class TriangleMesh;
+
+// Cotangent Laplace-Beltrami operator of a closed TriangleMesh together with lumped
+// (barycentric) vertex areas. For a per-vertex field c the surface Laplacian is
+// approximately M^-1 * L * c, where L is the symmetric negative semi-definite stiffness
+// matrix and M = diag(vertex areas). Rebuilt only when the mesh identity or version changes.
+class MeshLaplacian
+{
+public:
+    MeshLaplacian() = default;
+
+    // Rebuild operator if the mesh differs from the one it was built for; returns true if rebuilt
+    bool updateForMesh(const TriangleMesh& mesh);
+
+    const SparseMatrix& getStiffness() const { return m_stiffness; }
+    const std::vector<double>& getVertexAreas() const { return m_vertexAreas; }
+    uint32_t getVertexCount() const { return static_cast<uint32_t>(m_vertexAreas.size()); }
+
+    // Largest explicit Euler step for du/dt = D * M^-1 * L * u that keeps the update positive
+    double computeMaxStableExplicitStep(double diffusionCoeff) const;
+
+    // Version of the operator (incremented on every rebuild) so dependents can cache derived matrices
+    uint64_t getBuildVersion() const { return m_buildVersion; }
+
+private:
+    uint64_t m_meshId = UINT64_MAX;
+    uint64_t m_meshVersion = UINT64_MAX;
+    uint64_t m_buildVersion = 0;
+
+    SparseMatrix m_stiffness;
+    std::vector<double> m_vertexAreas;
+    std::vector<SparseMatrix::Triplet> m_triplets; // assembly scratch
+};
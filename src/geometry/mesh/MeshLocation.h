@@ -4,6 +4,7 @@
 #include <cassert>
 #include <limits>
 #include <cmath>
+#include <vector>
 #include "geometry/vectors/vector.h"
 
 // Generic geometric address on a triangulated surface
@@ -38,4 +39,12 @@ public:
         assert(!std::isnan(v.x) && "Setting invalid normalized coordinate (NaN sentinel) is not allowed");
         m_normalized = v;
     }
+
+    // Follow a triangle permutation of the mesh (see TriangleMesh::reorderSpatially); corner order
+    // and therefore the barycentric coordinates are preserved
+    void remapTriangle(const std::vector<uint32_t>& newTriangleIndex)
+    {
+        assert(m_triangleIndex < newTriangleIndex.size());
+        m_triangleIndex = newTriangleIndex[m_triangleIndex];
+    }
 };
@@ -0,0 +1,590 @@
+#include "MeshRemesher.h"
+#include "Edges.h"
+#include "geometry/vectors/intersections.h"
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <limits>
+
+namespace {
+    const uint32_t INVALID = TriangleMesh::INVALID_INDEX;
+
+    // Lowest normal cosine between a triangle before and after an operation
+    const float MIN_TRIANGLE_NORMAL_COS = 0.5f;
+    // Edges longer than SPLIT_RATIO times their target length are split, edges shorter than
+    // COLLAPSE_RATIO times it collapsed. Halves of a split edge (> 2/3 of the target) and edges
+    // created by a collapse (< SPLIT_RATIO) stay clear of both thresholds, so rounds converge.
+    const float SPLIT_RATIO = 4.0f / 3.0f;
+    const float COLLAPSE_RATIO = 0.5f;
+    // Valence every vertex keeps at least
+    const uint32_t MIN_VALENCE = 3;
+
+    float3 triangleNormal(const std::vector<float3>& positions, const uint3& triangle) {
+        return cross(positions[triangle.y] - positions[triangle.x], positions[triangle.z] - positions[triangle.x]);
+    }
+
+    bool normalsAgree(const float3& n0, const float3& n1, float fMinCos) {
+        const float len0 = length(n0);
+        const float len1 = length(n1);
+        return len0 > 0.0f && len1 > 0.0f && dot(n0, n1) >= fMinCos * len0 * len1;
+    }
+
+    bool hasCorner(const uint3& triangle, uint32_t v) {
+        return triangle.x == v || triangle.y == v || triangle.z == v;
+    }
+
+    // Working state of one remesh() call. Vertex indices stay stable over the passes (removed
+    // vertices are only marked); the triangle list is compacted between passes.
+    struct WorkMesh {
+        std::vector<float3> positions;
+        std::vector<MeshRemesher::Changes::VertexSource> sources;  // relative to the input mesh
+        std::vector<uint8_t> isInput;         // vertex existed before this call
+        std::vector<uint8_t> isAlive;
+        std::vector<uint32_t> mergedInto;     // surviving vertex of a collapsed one
+        std::vector<uint3> triangles;
+        std::vector<uint32_t> triangleOrigin; // input triangle if unchanged, INVALID otherwise
+
+        TriangleMesh mesh;                    // mirror used to compute the edge adjacency of a pass
+
+        std::shared_ptr<Edges> computeEdges() {
+            mesh.getVertices()->assignPositions(positions);
+            mesh.setTriangles(triangles);
+            return Edges::computeEdges(mesh);
+        }
+
+        // Curvature across an edge: dihedral angle over the distance between the face centroids
+        float edgeCurvature(const Edges& edges, uint32_t e) const {
+            const std::span<const uint32_t> edgeTriangles = edges.getEdgeTriangles(e);
+            if (edgeTriangles.size() != 2) {
+                return 0.0f;
+            }
+            const uint3 t0 = triangles[edgeTriangles[0]];
+            const uint3 t1 = triangles[edgeTriangles[1]];
+            const float3 n0 = triangleNormal(positions, t0);
+            const float3 n1 = triangleNormal(positions, t1);
+            const float len0 = length(n0);
+            const float len1 = length(n1);
+            if (len0 <= 0.0f || len1 <= 0.0f) {
+                return 0.0f;
+            }
+            const float3 c0 = (positions[t0.x] + positions[t0.y] + positions[t0.z]) / 3.0f;
+            const float3 c1 = (positions[t1.x] + positions[t1.y] + positions[t1.z]) / 3.0f;
+            const float distance = length(c1 - c0);
+            const float angle = std::acos(std::clamp(dot(n0, n1) / (len0 * len1), -1.0f, 1.0f));
+            return (distance > 0.0f) ? angle / distance : 0.0f;
+        }
+
+        // Target length of every edge from the curvature averaged over the edges around its endpoints,
+        // which is less sensitive to the tessellation than the curvature across the edge alone
+        std::vector<float> computeEdgeTargets(const Edges& edges, const MeshRemesher& remesher) const {
+            std::vector<float> edgeCurvatures(edges.getEdgeCount());
+            for (uint32_t e = 0; e < edges.getEdgeCount(); ++e) {
+                edgeCurvatures[e] = edgeCurvature(edges, e);
+            }
+            std::vector<float> vertexCurvatures(edges.getVertexCount(), 0.0f);
+            for (uint32_t v = 0; v < edges.getVertexCount(); ++v) {
+                const std::span<const uint32_t> vertexEdges = edges.getVertexEdges(v);
+                for (uint32_t e : vertexEdges) {
+                    vertexCurvatures[v] += edgeCurvatures[e];
+                }
+                vertexCurvatures[v] /= std::max<size_t>(vertexEdges.size(), 1);
+            }
+            std::vector<float> targets(edges.getEdgeCount());
+            for (uint32_t e = 0; e < edges.getEdgeCount(); ++e) {
+                const auto ab = edges.getEdge(e);
+                targets[e] = remesher.computeTargetEdgeLength(0.5f * (vertexCurvatures[ab.first] + vertexCurvatures[ab.second]));
+            }
+            return targets;
+        }
+
+        float edgeLength(const Edges& edges, uint32_t e) const {
+            const auto ab = edges.getEdge(e);
+            return length(positions[ab.second] - positions[ab.first]);
+        }
+
+        // Angle-weighted vertex normals
+        std::vector<float3> computeVertexNormals() const {
+            std::vector<float3> normals(positions.size(), float3(0, 0, 0));
+            for (const uint3& triangle : triangles) {
+                const uint32_t corners[3] = { triangle.x, triangle.y, triangle.z };
+                const float3 n = triangleNormal(positions, triangle);
+                const float len = length(n);
+                if (len <= 0.0f) {
+                    continue;
+                }
+                for (uint32_t k = 0; k < 3; ++k) {
+                    const float3 e0 = positions[corners[(k + 1) % 3]] - positions[corners[k]];
+                    const float3 e1 = positions[corners[(k + 2) % 3]] - positions[corners[k]];
+                    const float cosAngle = dot(e0, e1) / std::max(length(e0) * length(e1), 1e-30f);
+                    normals[corners[k]] += n * (std::acos(std::clamp(cosAngle, -1.0f, 1.0f)) / len);
+                }
+            }
+            for (float3& n : normals) {
+                const float len = length(n);
+                n = (len > 0.0f) ? n / len : float3(0, 0, 0);
+            }
+            return normals;
+        }
+
+        // Midpoint of the cubic edge curve of a PN triangle (Vlachos et al. 2001) through a and b: the
+        // chord midpoint pushed out along the vertex normals, so that refined regions get rounder
+        // instead of keeping the creases of the coarse mesh
+        float3 curvedMidpoint(uint32_t a, uint32_t b, const std::vector<float3>& normals) const {
+            const float3 ab = positions[b] - positions[a];
+            return 0.5f * (positions[a] + positions[b])
+                - (dot(ab, normals[a]) * normals[a] - dot(ab, normals[b]) * normals[b]) / 8.0f;
+        }
+
+        void removeDeadTriangles() {
+            size_t nKept = 0;
+            for (size_t t = 0; t < triangles.size(); ++t) {
+                if (triangles[t].x != INVALID) {
+                    triangles[nKept] = triangles[t];
+                    triangleOrigin[nKept] = triangleOrigin[t];
+                    ++nKept;
+                }
+            }
+            triangles.resize(nKept);
+            triangleOrigin.resize(nKept);
+        }
+    };
+
+    // Vertex -> incident triangles (CSR)
+    void buildVertexTriangles(const std::vector<uint3>& triangles, uint32_t vertexCount,
+                              std::vector<uint32_t>& offsets, std::vector<uint32_t>& vertexTriangles) {
+        offsets.assign(vertexCount + 1, 0);
+        for (const uint3& triangle : triangles) {
+            ++offsets[triangle.x + 1];
+            ++offsets[triangle.y + 1];
+            ++offsets[triangle.z + 1];
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        vertexTriangles.resize(offsets[vertexCount]);
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32_t t = 0; t < triangles.size(); ++t) {
+            vertexTriangles[cursor[triangles[t].x]++] = t;
+            vertexTriangles[cursor[triangles[t].y]++] = t;
+            vertexTriangles[cursor[triangles[t].z]++] = t;
+        }
+    }
+}
+
+float MeshRemesher::computeTargetEdgeLength(float fCurvature) const {
+    // Edge length of an equilateral triangle on a sphere of radius 1 / curvature whose
+    // midpoint deviates from the sphere by the approximation error
+    const float error = m_settings.m_fMaxApproximationError;
+    float target = m_settings.m_fMaxEdgeLength;
+    if (fCurvature > 0.0f) {
+        const float lengthSq = 6.0f * error / fCurvature - 3.0f * error * error;
+        target = (lengthSq > 0.0f) ? std::sqrt(lengthSq) : 0.0f;
+    }
+    return std::clamp(target, m_settings.m_fMinEdgeLength, m_settings.m_fMaxEdgeLength);
+}
+
+MeshRemesher::Changes MeshRemesher::remesh(TriangleMesh& mesh) const {
+    Changes changes;
+    const Vertices& inputVertices = *mesh.getVertices();
+    const uint32_t inputVertexCount = inputVertices.getVertexCount();
+    const uint32_t inputTriangleCount = mesh.getTriangleCount();
+
+    WorkMesh work;
+    work.positions.resize(inputVertexCount);
+    work.sources.resize(inputVertexCount);
+    for (uint32_t v = 0; v < inputVertexCount; ++v) {
+        work.positions[v] = inputVertices.getVertexPosition(v);
+        work.sources[v] = { v, v, 0.0f };
+    }
+    work.isInput.assign(inputVertexCount, 1);
+    work.isAlive.assign(inputVertexCount, 1);
+    work.mergedInto.assign(inputVertexCount, INVALID);
+    work.triangles.resize(inputTriangleCount);
+    work.triangleOrigin.resize(inputTriangleCount);
+    for (uint32_t t = 0; t < inputTriangleCount; ++t) {
+        work.triangles[t] = mesh.getTriangleVertices(t);
+        work.triangleOrigin[t] = t;
+    }
+    const std::vector<float3> inputPositions = work.positions;
+
+    // Split: long edges get a midpoint, then every triangle is refined by the pattern of its split edges
+    std::vector<uint32_t> inputEdgeSplits(3 * static_cast<size_t>(inputTriangleCount), INVALID);
+    {
+        const std::shared_ptr<Edges> pEdges = work.computeEdges();
+        const std::vector<float> targets = work.computeEdgeTargets(*pEdges, *this);
+        const std::vector<float3> normals = work.computeVertexNormals();
+        std::vector<uint32_t> edgeMidpoint(pEdges->getEdgeCount(), INVALID);
+        for (uint32_t e = 0; e < pEdges->getEdgeCount(); ++e) {
+            const float len = work.edgeLength(*pEdges, e);
+            if (len > SPLIT_RATIO * targets[e] && 0.5f * len >= m_settings.m_fMinEdgeLength) {
+                const auto ab = pEdges->getEdge(e);
+                edgeMidpoint[e] = static_cast<uint32_t>(work.positions.size());
+                work.positions.push_back(work.curvedMidpoint(ab.first, ab.second, normals));
+                work.sources.push_back({ ab.first, ab.second, 0.5f });
+                work.isInput.push_back(0);
+                work.isAlive.push_back(1);
+                work.mergedInto.push_back(INVALID);
+                ++changes.m_nSplits;
+            }
+        }
+
+        std::vector<uint3> refined;
+        std::vector<uint32_t> refinedOrigin;
+        refined.reserve(work.triangles.size() + 3 * changes.m_nSplits);
+        refinedOrigin.reserve(refined.capacity());
+        auto emit = [&](uint32_t a, uint32_t b, uint32_t c) {
+            refined.emplace_back(a, b, c);
+            refinedOrigin.push_back(INVALID);
+        };
+        for (uint32_t t = 0; t < work.triangles.size(); ++t) {
+            const uint3 triangle = work.triangles[t];
+            const uint32_t c[3] = { triangle.x, triangle.y, triangle.z };
+            uint32_t m[3];
+            uint32_t nSplit = 0;
+            for (uint32_t k = 0; k < 3; ++k) {
+                m[k] = edgeMidpoint[pEdges->getTriangleEdge(t, k)];
+                inputEdgeSplits[3 * t + k] = m[k];
+                nSplit += (m[k] != INVALID);
+            }
+            if (nSplit == 0) {
+                refined.push_back(triangle);
+                refinedOrigin.push_back(work.triangleOrigin[t]);
+            }
+            else if (nSplit == 1) {
+                const uint32_t k = (m[0] != INVALID) ? 0 : (m[1] != INVALID) ? 1 : 2;
+                emit(c[k], m[k], c[(k + 2) % 3]);
+                emit(m[k], c[(k + 1) % 3], c[(k + 2) % 3]);
+            }
+            else if (nSplit == 2) {
+                // Edge j = (a, b) is not split; m1 lies on (b, c), m2 on (c, a)
+                const uint32_t j = (m[0] == INVALID) ? 0 : (m[1] == INVALID) ? 1 : 2;
+                const uint32_t a = c[j], b = c[(j + 1) % 3], cc = c[(j + 2) % 3];
+                const uint32_t m1 = m[(j + 1) % 3], m2 = m[(j + 2) % 3];
+                emit(m1, cc, m2);
+                // Split the remaining quad (a, b, m1, m2) along its shorter diagonal
+                if (length(work.positions[m1] - work.positions[a]) <= length(work.positions[m2] - work.positions[b])) {
+                    emit(a, b, m1);
+                    emit(a, m1, m2);
+                }
+                else {
+                    emit(a, b, m2);
+                    emit(b, m1, m2);
+                }
+            }
+            else {
+                emit(c[0], m[0], m[2]);
+                emit(m[0], c[1], m[1]);
+                emit(m[2], m[1], c[2]);
+                emit(m[0], m[1], m[2]);
+            }
+        }
+        work.triangles = std::move(refined);
+        work.triangleOrigin = std::move(refinedOrigin);
+    }
+
+    // Collapse: short edges between input vertices, shortest first, merged at their midpoint
+    {
+        const std::shared_ptr<Edges> pEdges = work.computeEdges();
+        const uint32_t vertexCount = static_cast<uint32_t>(work.positions.size());
+        std::vector<uint32_t> vertexTriangleOffsets, vertexTriangles;
+        buildVertexTriangles(work.triangles, vertexCount, vertexTriangleOffsets, vertexTriangles);
+        const std::vector<float3> normals = work.computeVertexNormals();
+
+        std::vector<std::pair<float, uint32_t>> candidates;
+        const std::vector<float> targets = work.computeEdgeTargets(*pEdges, *this);
+        for (uint32_t e = 0; e < pEdges->getEdgeCount(); ++e) {
+            const float len = work.edgeLength(*pEdges, e);
+            if (len < COLLAPSE_RATIO * targets[e]) {
+                candidates.emplace_back(len, e);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        auto isInterior = [&](uint32_t v) {
+            for (uint32_t e : pEdges->getVertexEdges(v)) {
+                if (pEdges->getEdgeTriangles(e).size() != 2) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        std::vector<uint8_t> isLocked(vertexCount, 0);
+        for (const auto& [len, e] : candidates) {
+            const auto ab = pEdges->getEdge(e);
+            const uint32_t a = ab.first, b = ab.second;
+            if (!work.isInput[a] || !work.isInput[b] || isLocked[a] || isLocked[b]) {
+                continue;
+            }
+            if (!isInterior(a) || !isInterior(b)) {
+                continue;
+            }
+
+            // Link condition: the only common neighbours are the two vertices opposite the edge
+            const std::span<const uint32_t> ringA = pEdges->getVertexNeighbors(a);
+            const std::span<const uint32_t> ringB = pEdges->getVertexNeighbors(b);
+            uint32_t nCommon = 0;
+            bool bValenceOk = ringA.size() + ringB.size() >= MIN_VALENCE + 4;
+            for (uint32_t n : ringA) {
+                if (std::find(ringB.begin(), ringB.end(), n) != ringB.end()) {
+                    ++nCommon;
+                    bValenceOk = bValenceOk && pEdges->getVertexNeighbors(n).size() > MIN_VALENCE;
+                }
+            }
+            if (nCommon != 2 || !bValenceOk) {
+                continue;
+            }
+
+            // The surrounding triangles must keep their orientation and not get over-long edges
+            const float3 merged = work.curvedMidpoint(a, b, normals);
+            const float maxLength = SPLIT_RATIO * targets[e];
+            bool bValid = true;
+            for (uint32_t v : { a, b }) {
+                for (uint32_t i = vertexTriangleOffsets[v]; bValid && i < vertexTriangleOffsets[v + 1]; ++i) {
+                    const uint3 triangle = work.triangles[vertexTriangles[i]];
+                    if (hasCorner(triangle, a) && hasCorner(triangle, b)) {
+                        continue;
+                    }
+                    float3 corners[3] = { work.positions[triangle.x], work.positions[triangle.y], work.positions[triangle.z] };
+                    const uint32_t indices[3] = { triangle.x, triangle.y, triangle.z };
+                    for (uint32_t k = 0; k < 3; ++k) {
+                        if (indices[k] == v) {
+                            corners[k] = merged;
+                        }
+                        else if (length(work.positions[indices[k]] - merged) > maxLength) {
+                            bValid = false;
+                        }
+                    }
+                    const float3 newNormal = cross(corners[1] - corners[0], corners[2] - corners[0]);
+                    bValid = bValid && normalsAgree(triangleNormal(work.positions, triangle), newNormal, MIN_TRIANGLE_NORMAL_COS);
+                }
+            }
+            if (!bValid) {
+                continue;
+            }
+
+            // Merge b into a
+            work.positions[a] = merged;
+            work.sources[a] = { work.sources[a].m_uA, work.sources[b].m_uA, 0.5f };
+            work.isAlive[b] = 0;
+            work.mergedInto[b] = a;
+            for (uint32_t v : { a, b }) {
+                for (uint32_t i = vertexTriangleOffsets[v]; i < vertexTriangleOffsets[v + 1]; ++i) {
+                    uint3& triangle = work.triangles[vertexTriangles[i]];
+                    work.triangleOrigin[vertexTriangles[i]] = INVALID;
+                    if (triangle.x == INVALID) {
+                        continue;
+                    }
+                    if (hasCorner(triangle, a) && hasCorner(triangle, b)) {
+                        triangle = uint3(INVALID, INVALID, INVALID);
+                        continue;
+                    }
+                    triangle.x = (triangle.x == b) ? a : triangle.x;
+                    triangle.y = (triangle.y == b) ? a : triangle.y;
+                    triangle.z = (triangle.z == b) ? a : triangle.z;
+                }
+            }
+            isLocked[a] = isLocked[b] = 1;
+            for (uint32_t n : ringA) {
+                isLocked[n] = 1;
+            }
+            for (uint32_t n : ringB) {
+                isLocked[n] = 1;
+            }
+            ++changes.m_nCollapses;
+        }
+        work.removeDeadTriangles();
+    }
+
+    // Flip: interior edges whose flip brings the four involved valences closer to 6
+    {
+        const std::shared_ptr<Edges> pEdges = work.computeEdges();
+        std::vector<uint8_t> isLocked(work.positions.size(), 0);
+        auto deviation = [](int valence) { return std::abs(valence - 6); };
+        for (uint32_t e = 0; e < pEdges->getEdgeCount(); ++e) {
+            const std::span<const uint32_t> edgeTriangles = pEdges->getEdgeTriangles(e);
+            if (edgeTriangles.size() != 2) {
+                continue;
+            }
+            // Orient the edge as it appears in t0 = (a, b, c); t1 = (b, a, d)
+            uint32_t t0 = edgeTriangles[0], t1 = edgeTriangles[1];
+            const auto ab = pEdges->getEdge(e);
+            uint32_t k = 0;
+            while (k < 3 && !(pEdges->getTriangleEdge(t0, k) == e)) {
+                ++k;
+            }
+            const uint3 tri0 = work.triangles[t0];
+            const uint32_t c0[3] = { tri0.x, tri0.y, tri0.z };
+            const uint32_t a = c0[k], b = c0[(k + 1) % 3], c = c0[(k + 2) % 3];
+            const uint3 tri1 = work.triangles[t1];
+            const uint32_t d = (tri1.x != ab.first && tri1.x != ab.second) ? tri1.x
+                             : (tri1.y != ab.first && tri1.y != ab.second) ? tri1.y : tri1.z;
+            if (isLocked[a] || isLocked[b] || isLocked[c] || isLocked[d] || c == d
+                || pEdges->findEdge(c, d) != Edges::INVALID_INDEX) {
+                continue;
+            }
+
+            const int va = static_cast<int>(pEdges->getVertexNeighbors(a).size());
+            const int vb = static_cast<int>(pEdges->getVertexNeighbors(b).size());
+            const int vc = static_cast<int>(pEdges->getVertexNeighbors(c).size());
+            const int vd = static_cast<int>(pEdges->getVertexNeighbors(d).size());
+            if (va <= static_cast<int>(MIN_VALENCE) || vb <= static_cast<int>(MIN_VALENCE)) {
+                continue;
+            }
+            const int before = deviation(va) + deviation(vb) + deviation(vc) + deviation(vd);
+            const int after = deviation(va - 1) + deviation(vb - 1) + deviation(vc + 1) + deviation(vd + 1);
+            if (after >= before) {
+                continue;
+            }
+
+            // Only flip nearly flat edges, and only if the new triangles face the same way
+            const float3 n0 = triangleNormal(work.positions, tri0);
+            const float3 n1 = triangleNormal(work.positions, tri1);
+            if (!normalsAgree(n0, n1, m_settings.m_fFlipMinNormalCos)) {
+                continue;
+            }
+            const uint3 flipped0(c, a, d);
+            const uint3 flipped1(d, b, c);
+            const float3 m0 = triangleNormal(work.positions, flipped0);
+            const float3 m1 = triangleNormal(work.positions, flipped1);
+            const float3 averageNormal = n0 / length(n0) + n1 / length(n1);
+            if (!normalsAgree(m0, averageNormal, MIN_TRIANGLE_NORMAL_COS) || !normalsAgree(m1, averageNormal, MIN_TRIANGLE_NORMAL_COS)
+                || !normalsAgree(m0, m1, m_settings.m_fFlipMinNormalCos)) {
+                continue;
+            }
+
+            work.triangles[t0] = flipped0;
+            work.triangles[t1] = flipped1;
+            work.triangleOrigin[t0] = work.triangleOrigin[t1] = INVALID;
+            isLocked[a] = isLocked[b] = isLocked[c] = isLocked[d] = 1;
+            ++changes.m_nFlips;
+        }
+    }
+
+    if (changes.isEmpty()) {
+        return changes;
+    }
+    changes.m_pOldEdges = mesh.getOrCreateEdges();
+
+    // Compact vertices (removed ones are dropped, order is kept) and express everything in new indices
+    std::vector<uint32_t> newIndex(work.positions.size(), INVALID);
+    std::vector<float3> newPositions;
+    newPositions.reserve(work.positions.size());
+    for (uint32_t v = 0; v < work.positions.size(); ++v) {
+        if (work.isAlive[v]) {
+            newIndex[v] = static_cast<uint32_t>(newPositions.size());
+            newPositions.push_back(work.positions[v]);
+            changes.m_vertexSources.push_back(work.sources[v]);
+        }
+    }
+    changes.m_newVertexIndex.resize(inputVertexCount);
+    for (uint32_t v = 0; v < inputVertexCount; ++v) {
+        changes.m_newVertexIndex[v] = newIndex[work.isAlive[v] ? v : work.mergedInto[v]];
+    }
+    for (uint3& triangle : work.triangles) {
+        triangle = uint3(newIndex[triangle.x], newIndex[triangle.y], newIndex[triangle.z]);
+    }
+    changes.m_newTriangleIndex.assign(inputTriangleCount, INVALID);
+    for (uint32_t t = 0; t < work.triangles.size(); ++t) {
+        if (work.triangleOrigin[t] != INVALID) {
+            changes.m_newTriangleIndex[work.triangleOrigin[t]] = t;
+        }
+    }
+
+    // New triangles around the images of a replaced triangle's corners and edge midpoints cover it
+    std::vector<uint32_t> vertexTriangleOffsets, vertexTriangles;
+    buildVertexTriangles(work.triangles, static_cast<uint32_t>(newPositions.size()), vertexTriangleOffsets, vertexTriangles);
+    changes.m_candidateOffsets.push_back(0);
+    for (uint32_t t = 0; t < inputTriangleCount; ++t) {
+        if (changes.m_newTriangleIndex[t] != INVALID) {
+            continue;
+        }
+        const uint3 triangle = mesh.getTriangleVertices(t);
+        changes.m_replacedTriangles.push_back(t);
+        changes.m_replacedCorners.push_back(inputPositions[triangle.x]);
+        changes.m_replacedCorners.push_back(inputPositions[triangle.y]);
+        changes.m_replacedCorners.push_back(inputPositions[triangle.z]);
+
+        uint32_t vertices[6] = {
+            changes.m_newVertexIndex[triangle.x], changes.m_newVertexIndex[triangle.y], changes.m_newVertexIndex[triangle.z],
+            INVALID, INVALID, INVALID
+        };
+        for (uint32_t k = 0; k < 3; ++k) {
+            const uint32_t midpoint = inputEdgeSplits[3 * t + k];
+            vertices[3 + k] = (midpoint != INVALID) ? newIndex[midpoint] : INVALID;
+        }
+        const size_t first = changes.m_candidateTriangles.size();
+        for (uint32_t v : vertices) {
+            if (v == INVALID) {
+                continue;
+            }
+            changes.m_candidateTriangles.insert(changes.m_candidateTriangles.end(),
+                vertexTriangles.begin() + vertexTriangleOffsets[v], vertexTriangles.begin() + vertexTriangleOffsets[v + 1]);
+        }
+        std::sort(changes.m_candidateTriangles.begin() + first, changes.m_candidateTriangles.end());
+        changes.m_candidateTriangles.erase(std::unique(changes.m_candidateTriangles.begin() + first, changes.m_candidateTriangles.end()),
+                                           changes.m_candidateTriangles.end());
+        changes.m_candidateOffsets.push_back(static_cast<uint32_t>(changes.m_candidateTriangles.size()));
+    }
+
+    mesh.getVertices()->assignPositions(newPositions);
+    mesh.setTriangles(std::move(work.triangles));
+    return changes;
+}
+
+void MeshRemesher::Changes::relocate(MeshLocation& location, const TriangleMesh& newMesh) const {
+    const uint32_t oldTriangle = location.m_triangleIndex;
+    if (isEmpty() || oldTriangle >= m_newTriangleIndex.size()) {
+        return;
+    }
+    if (m_newTriangleIndex[oldTriangle] != INVALID) {
+        location.m_triangleIndex = m_newTriangleIndex[oldTriangle];
+        return;
+    }
+
+    const auto it = std::lower_bound(m_replacedTriangles.begin(), m_replacedTriangles.end(), oldTriangle);
+    assert(it != m_replacedTriangles.end() && *it == oldTriangle);
+    const size_t i = it - m_replacedTriangles.begin();
+    const float3& bary = location.getBarycentric();
+    const float3 point = bary.x * m_replacedCorners[3 * i] + bary.y * m_replacedCorners[3 * i + 1]
+                       + bary.z * m_replacedCorners[3 * i + 2];
+
+    const Vertices& vertices = *newMesh.getVertices();
+    float bestDistSq = std::numeric_limits<float>::max();
+    for (uint32_t c = m_candidateOffsets[i]; c < m_candidateOffsets[i + 1]; ++c) {
+        const uint3 triangle = newMesh.getTriangleVertices(m_candidateTriangles[c]);
+        float3 candidateBary;
+        const float3 closest = closestPointOnTriangle(point, vertices.getVertexPosition(triangle.x),
+            vertices.getVertexPosition(triangle.y), vertices.getVertexPosition(triangle.z), candidateBary);
+        const float3 d = closest - point;
+        if (dot(d, d) < bestDistSq) {
+            bestDistSq = dot(d, d);
+            location.m_triangleIndex = m_candidateTriangles[c];
+            location.setBarycentric(candidateBary);
+        }
+    }
+}
+
+uint32_t MeshRemesher::Changes::findOldEdge(uint32_t uNewA, uint32_t uNewB) const {
+    const VertexSource& a = m_vertexSources[uNewA];
+    const VertexSource& b = m_vertexSources[uNewB];
+    const bool bSingleA = a.m_uA == a.m_uB;
+    const bool bSingleB = b.m_uA == b.m_uB;
+    if (bSingleA && bSingleB) {
+        return m_pOldEdges->findEdge(a.m_uA, b.m_uA);
+    }
+    // Half of a split edge joins its midpoint to one of the old endpoints; the other endpoint must
+    // not have been merged away by a collapse of the same round
+    if (bSingleA != bSingleB) {
+        const VertexSource& single = bSingleA ? a : b;
+        const VertexSource& midpoint = bSingleA ? b : a;
+        if (single.m_uA == midpoint.m_uA || single.m_uA == midpoint.m_uB) {
+            const uint32_t uOther = (single.m_uA == midpoint.m_uA) ? midpoint.m_uB : midpoint.m_uA;
+            const VertexSource& other = m_vertexSources[m_newVertexIndex[uOther]];
+            if (other.m_uA == other.m_uB) {
+                return m_pOldEdges->findEdge(midpoint.m_uA, midpoint.m_uB);
+            }
+        }
+    }
+    return INVALID;
+}
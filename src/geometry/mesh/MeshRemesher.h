@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "geometry/vectors/vector.h"
+#include "TriangleMesh.h"
+#include "MeshLocation.h"
+
+class Edges;
+
+// Adaptive remeshing of a closed triangle mesh: edges longer than 4/3 of the local target length
+// are split, edges shorter than 1/2 of it collapsed, and edges flipped where that evens out vertex
+// valences. The target length follows the curvature (the longest edge whose chord stays within
+// m_fMaxApproximationError of the bent surface), so triangle count tracks geometric complexity.
+// Each remesh() call performs one round of every operation; operations of a round touch disjoint
+// neighbourhoods. The returned change list lets owners of per-vertex, per-edge and per-location data
+// update it in place instead of rebuilding it.
+class MeshRemesher
+{
+public:
+    struct Settings
+    {
+        float m_fMinEdgeLength = 0.05f;
+        float m_fMaxEdgeLength = 1.0f;
+        float m_fMaxApproximationError = 0.01f;
+        // Edges whose adjacent faces bend by more than this (cosine of the dihedral angle) are not flipped
+        float m_fFlipMinNormalCos = 0.9f;
+    };
+
+    // What one remesh() call did, in terms of the mesh before and after it
+    struct Changes
+    {
+        // Every new vertex interpolates at most two old ones: (1 - m_fT) * old[m_uA] + m_fT * old[m_uB].
+        // Unchanged vertices have m_uA == m_uB.
+        struct VertexSource
+        {
+            uint32_t m_uA;
+            uint32_t m_uB;
+            float m_fT;
+        };
+        std::vector<VertexSource> m_vertexSources;
+        // Old vertex -> new vertex; both ends of a collapsed edge map to the merged vertex
+        std::vector<uint32_t> m_newVertexIndex;
+        // Old triangle -> new index if it survived unchanged, INVALID_INDEX if it was replaced
+        std::vector<uint32_t> m_newTriangleIndex;
+        // Edge adjacency of the old mesh, for remapping per-edge data
+        std::shared_ptr<const Edges> m_pOldEdges;
+
+        // Replaced old triangles (ascending), their corner positions and the new triangles covering them
+        std::vector<uint32_t> m_replacedTriangles;
+        std::vector<float3> m_replacedCorners;       // 3 per replaced triangle
+        std::vector<uint32_t> m_candidateOffsets;    // size m_replacedTriangles.size() + 1
+        std::vector<uint32_t> m_candidateTriangles;
+
+        uint32_t m_nSplits = 0;
+        uint32_t m_nCollapses = 0;
+        uint32_t m_nFlips = 0;
+
+        // True if the mesh was not modified; the vectors above are then empty
+        bool isEmpty() const { return m_nSplits + m_nCollapses + m_nFlips == 0; }
+
+        // Move a location on the old mesh to the new one. Locations on unchanged triangles only get
+        // the new triangle index; others are projected onto the closest new triangle covering their
+        // old triangle.
+        void relocate(MeshLocation& location, const TriangleMesh& newMesh) const;
+
+        // Old edge a new edge (given by its new vertices) lies on: the same edge, or the edge it is
+        // one half of after a split. INVALID_INDEX for edges created by collapses and flips.
+        uint32_t findOldEdge(uint32_t uNewA, uint32_t uNewB) const;
+    };
+
+    MeshRemesher() = default;
+    explicit MeshRemesher(const Settings& settings) : m_settings(settings) {}
+
+    const Settings& getSettings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+
+    // Target edge length for a surface with curvature fCurvature (1 / radius)
+    float computeTargetEdgeLength(float fCurvature) const;
+
+    Changes remesh(TriangleMesh& mesh) const;
+
+private:
+    Settings m_settings;
+};
@@ -0,0 +1,163 @@
+#include "SparseMatrix.h"
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+void SparseMatrix::setFromTriplets(uint32_t nRows, uint32_t nCols, std::vector<Triplet>& triplets)
+{
+    std::sort(triplets.begin(), triplets.end(), [](const Triplet& a, const Triplet& b) {
+        return (a.m_row != b.m_row) ? (a.m_row < b.m_row) : (a.m_col < b.m_col);
+    });
+
+    m_nCols = nCols;
+    m_rowStart.assign(nRows + 1, 0);
+    m_colIndices.clear();
+    m_values.clear();
+    m_colIndices.reserve(triplets.size());
+    m_values.reserve(triplets.size());
+
+    for (size_t i = 0; i < triplets.size(); ++i)
+    {
+        const Triplet& t = triplets[i];
+        assert(t.m_row < nRows && t.m_col < nCols);
+        // Merge duplicates with the previously emitted entry of the same row
+        const bool isDuplicate = !m_colIndices.empty() && i > 0 &&
+            triplets[i - 1].m_row == t.m_row && m_colIndices.back() == t.m_col;
+        if (isDuplicate)
+        {
+            m_values.back() += t.m_value;
+            continue;
+        }
+        m_colIndices.push_back(t.m_col);
+        m_values.push_back(t.m_value);
+        ++m_rowStart[t.m_row + 1];
+    }
+    for (uint32_t r = 0; r < nRows; ++r)
+    {
+        m_rowStart[r + 1] += m_rowStart[r];
+    }
+
+    m_diagIndex.assign(nRows, INVALID_INDEX);
+    for (uint32_t r = 0; r < nRows; ++r)
+    {
+        for (uint32_t k = m_rowStart[r]; k < m_rowStart[r + 1]; ++k)
+        {
+            if (m_colIndices[k] == r)
+            {
+                m_diagIndex[r] = k;
+                break;
+            }
+        }
+    }
+}
+
+void SparseMatrix::multiply(const std::vector<double>& x, std::vector<double>& y) const
+{
+    assert(x.size() >= m_nCols);
+    const uint32_t nRows = getRowCount();
+    y.resize(nRows);
+    for (uint32_t r = 0; r < nRows; ++r)
+    {
+        double sum = 0.0;
+        for (uint32_t k = m_rowStart[r]; k < m_rowStart[r + 1]; ++k)
+        {
+            sum += m_values[k] * x[m_colIndices[k]];
+        }
+        y[r] = sum;
+    }
+}
+
+double SparseMatrix::getDiagonal(uint32_t row) const
+{
+    const uint32_t k = m_diagIndex[row];
+    return (k == INVALID_INDEX) ? 0.0 : m_values[k];
+}
+
+void SparseMatrix::scale(double s)
+{
+    for (double& v : m_values)
+    {
+        v *= s;
+    }
+}
+
+void SparseMatrix::addToDiagonal(const std::vector<double>& d)
+{
+    assert(d.size() == getRowCount());
+    for (uint32_t r = 0; r < d.size(); ++r)
+    {
+        if (d[r] == 0.0)
+            continue;
+        assert(m_diagIndex[r] != INVALID_INDEX && "addToDiagonal requires a stored diagonal entry");
+        m_values[m_diagIndex[r]] += d[r];
+    }
+}
+
+uint32_t SparseMatrix::solveConjugateGradient(const std::vector<double>& b, std::vector<double>& x,
+                                              uint32_t maxIterations, double relTolerance) const
+{
+    const uint32_t n = getRowCount();
+    assert(b.size() == n && n == m_nCols);
+    x.resize(n, 0.0);
+    m_cgR.resize(n);
+    m_cgZ.resize(n);
+    m_cgP.resize(n);
+
+    auto applyPreconditioner = [&](const std::vector<double>& r, std::vector<double>& z) {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const double d = getDiagonal(i);
+            z[i] = (d != 0.0) ? r[i] / d : r[i];
+        }
+    };
+
+    // r = b - A x
+    multiply(x, m_cgAp);
+    double bNorm2 = 0.0;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        m_cgR[i] = b[i] - m_cgAp[i];
+        bNorm2 += b[i] * b[i];
+    }
+    const double tol2 = relTolerance * relTolerance * std::max(bNorm2, 1e-300);
+
+    applyPreconditioner(m_cgR, m_cgZ);
+    m_cgP = m_cgZ;
+    double rz = 0.0;
+    for (uint32_t i = 0; i < n; ++i)
+        rz += m_cgR[i] * m_cgZ[i];
+
+    uint32_t it = 0;
+    for (; it < maxIterations; ++it)
+    {
+        double rNorm2 = 0.0;
+        for (uint32_t i = 0; i < n; ++i)
+            rNorm2 += m_cgR[i] * m_cgR[i];
+        if (rNorm2 <= tol2)
+            break;
+
+        multiply(m_cgP, m_cgAp);
+        double pAp = 0.0;
+        for (uint32_t i = 0; i < n; ++i)
+            pAp += m_cgP[i] * m_cgAp[i];
+        if (pAp <= 0.0)
+            break; // not SPD or converged to machine precision
+
+        const double alpha = rz / pAp;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            x[i] += alpha * m_cgP[i];
+            m_cgR[i] -= alpha * m_cgAp[i];
+        }
+
+        applyPreconditioner(m_cgR, m_cgZ);
+        double rzNew = 0.0;
+        for (uint32_t i = 0; i < n; ++i)
+            rzNew += m_cgR[i] * m_cgZ[i];
+        const double beta = rzNew / rz;
+        rz = rzNew;
+        for (uint32_t i = 0; i < n; ++i)
+            m_cgP[i] = m_cgZ[i] + beta * m_cgP[i];
+    }
+    return it;
+}
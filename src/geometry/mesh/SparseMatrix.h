@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Compressed sparse row (CSR) matrix of doubles.
+// Used for mesh operators (e.g. surface Laplacian) that are assembled rarely and applied often.
+class SparseMatrix
+{
+public:
+    static const uint32_t INVALID_INDEX = UINT32_MAX;
+
+    struct Triplet
+    {
+        uint32_t m_row;
+        uint32_t m_col;
+        double m_value;
+    };
+
+    SparseMatrix() = default;
+
+    // Assemble from (row, col, value) triplets; duplicates are summed.
+    // The triplet vector is sorted in place so callers can reuse its storage.
+    void setFromTriplets(uint32_t nRows, uint32_t nCols, std::vector<Triplet>& triplets);
+
+    uint32_t getRowCount() const { return static_cast<uint32_t>(m_rowStart.empty() ? 0 : m_rowStart.size() - 1); }
+    uint32_t getColCount() const { return m_nCols; }
+    uint32_t getNonZeroCount() const { return static_cast<uint32_t>(m_values.size()); }
+
+    // y = A * x (y is resized as needed)
+    void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+
+    // Diagonal element (0 if not stored)
+    double getDiagonal(uint32_t row) const;
+
+    // A *= s
+    void scale(double s);
+    // A += diag(d); every row touched must have a stored diagonal entry
+    void addToDiagonal(const std::vector<double>& d);
+
+    // Solve A x = b for symmetric positive definite A using Jacobi-preconditioned conjugate gradient.
+    // x is used as the initial guess. Returns the number of iterations performed.
+    uint32_t solveConjugateGradient(const std::vector<double>& b, std::vector<double>& x,
+                                    uint32_t maxIterations, double relTolerance) const;
+
+private:
+    uint32_t m_nCols = 0;
+    std::vector<uint32_t> m_rowStart;    // size nRows + 1
+    std::vector<uint32_t> m_colIndices;  // size nnz
+    std::vector<double> m_values;        // size nnz
+    std::vector<uint32_t> m_diagIndex;   // per row: index of diagonal entry in m_values or INVALID_INDEX
+
+    // Conjugate gradient scratch (kept to avoid per-solve allocations)
+    mutable std::vector<double> m_cgR, m_cgZ, m_cgP, m_cgAp;
+};
@@ -5,6 +5,7 @@
 #include <cassert>
 #include "geometry/vectors/intersections.h"
 #include "Edges.h"
+#include "MeshHierarchy.h"
 
 // Constructor
 TriangleMesh::TriangleMesh() 
@@ -31,6 +32,7 @@ void TriangleMesh::clear() {
     m_pVertexMesh->clear();
     m_triangles.clear();
     invalidateEdges();
+    m_pHierarchy.reset();
     incrementVersion();
 }
 
@@ -94,15 +96,128 @@ uint32_t TriangleMesh::addTriangle(uint32_t v1, uint32_t v2, uint32_t v3) {
     return static_cast<uint32_t>(m_triangles.size() - 1);
 }
 
+// Replace the triangle list
+void TriangleMesh::setTriangles(std::vector<uint3> triangles) {
+    m_triangles = std::move(triangles);
+    invalidateEdges();
+    m_pHierarchy.reset();
+    incrementVersion();
+}
+
 // Extract triangles (move out, leaving vertices intact)
 std::vector<uint3> TriangleMesh::extractTriangles() {
     std::vector<uint3> extracted = std::move(m_triangles);
     m_triangles.clear(); // Ensure triangles is in a valid empty state
     invalidateEdges();
+    m_pHierarchy.reset();
     incrementVersion();
     return extracted;
 }
 
+namespace {
+    // Spread the low 10 bits of v so that there are two zero bits between consecutive bits
+    uint32_t expandBits10(uint32_t v) {
+        v &= 0x3ff;
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v << 8)) & 0x0300f00f;
+        v = (v | (v << 4)) & 0x030c30c3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    // 30-bit Morton code of a point quantized to 1024 steps per axis of box
+    uint32_t mortonCode(const float3& p, const box3& box) {
+        uint32_t code = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            const float extent = box.m_maxs[axis] - box.m_mins[axis];
+            const float f = (extent > 0.0f) ? (p[axis] - box.m_mins[axis]) / extent : 0.0f;
+            const uint32_t q = static_cast<uint32_t>(std::clamp(f * 1024.0f, 0.0f, 1023.0f));
+            code |= expandBits10(q) << (2 - axis);
+        }
+        return code;
+    }
+
+    // Indices sorted by code (ties keep index order); returns the new position of every index
+    std::vector<uint32_t> sortByCode(const std::vector<uint32_t>& codes) {
+        std::vector<uint64_t> keys(codes.size());
+        for (size_t i = 0; i < codes.size(); ++i) {
+            keys[i] = (uint64_t(codes[i]) << 32) | i;
+        }
+        std::sort(keys.begin(), keys.end());
+        std::vector<uint32_t> newIndex(codes.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            newIndex[static_cast<uint32_t>(keys[i])] = static_cast<uint32_t>(i);
+        }
+        return newIndex;
+    }
+}
+
+// Reorder vertices and triangles along a Morton curve
+TriangleMesh::Reordering TriangleMesh::reorderSpatially() {
+    Reordering reordering;
+    const bool bHasHierarchy = getHierarchy() != nullptr;
+    const uint32_t vertexCount = m_pVertexMesh->getVertexCount();
+    const box3 box = getBox();
+
+    std::vector<uint32_t> codes(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        codes[i] = mortonCode(m_pVertexMesh->getVertexPosition(i), box);
+    }
+    reordering.m_newVertexIndex = sortByCode(codes);
+    m_pVertexMesh->permuteVertices(reordering.m_newVertexIndex);
+
+    codes.resize(m_triangles.size());
+    for (size_t t = 0; t < m_triangles.size(); ++t) {
+        uint3& triangle = m_triangles[t];
+        triangle = uint3(reordering.m_newVertexIndex[triangle.x], reordering.m_newVertexIndex[triangle.y],
+                         reordering.m_newVertexIndex[triangle.z]);
+        const float3 centroid = (m_pVertexMesh->getVertexPosition(triangle.x) + m_pVertexMesh->getVertexPosition(triangle.y)
+                               + m_pVertexMesh->getVertexPosition(triangle.z)) / 3.0f;
+        codes[t] = mortonCode(centroid, box);
+    }
+    reordering.m_newTriangleIndex = sortByCode(codes);
+    std::vector<uint3> permuted(m_triangles);
+    for (size_t t = 0; t < m_triangles.size(); ++t) {
+        permuted[reordering.m_newTriangleIndex[t]] = m_triangles[t];
+    }
+    m_triangles = std::move(permuted);
+    incrementVersion();
+
+    if (m_pEdges) {
+        m_pEdges = Edges::computeEdges(*this);
+    }
+    if (bHasHierarchy) {
+        m_pHierarchy->remapFinest(reordering, *this);
+    }
+    return reordering;
+}
+
+uint32_t TriangleMesh::getLevelCount() const {
+    auto pHierarchy = getHierarchy();
+    return pHierarchy ? pHierarchy->getLevelCount() : 1;
+}
+
+std::shared_ptr<TriangleMesh> TriangleMesh::getLevel(uint32_t uLevel) {
+    auto pHierarchy = getHierarchy();
+    if (pHierarchy && uLevel < pHierarchy->getFinestLevel()) {
+        return pHierarchy->getCoarseLevel(uLevel, *this);
+    }
+    assert(uLevel + 1 == getLevelCount() && "Level out of range");
+    return std::static_pointer_cast<TriangleMesh>(shared_from_this());
+}
+
+float TriangleMesh::getLevelError(uint32_t uLevel) const {
+    auto pHierarchy = getHierarchy();
+    return pHierarchy ? pHierarchy->getApproximationError(uLevel, *this) : 0.0f;
+}
+
+std::shared_ptr<const MeshHierarchy> TriangleMesh::getHierarchy() const {
+    if (m_pHierarchy && m_pHierarchy->isValidFor(*this)) {
+        return m_pHierarchy;
+    }
+    return nullptr;
+}
+
 // Static factory method to create an icosahedron
 std::shared_ptr<TriangleMesh> TriangleMesh::createIcosahedron(double radius) {
     std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>();
@@ -165,10 +280,12 @@ std::shared_ptr<TriangleMesh> TriangleMesh::createSphere(double radius, uint32_t
     
     triangleMesh->verifyTopology();
     
-    // Subdivide the mesh the requested number of times
+    // Subdivide the mesh the requested number of times, keeping the levels for the hierarchy
+    std::vector<std::shared_ptr<TriangleMesh>> levels(1, triangleMesh);
     for (uint32_t level = 0; level < subdivisionLevel; ++level) {
         triangleMesh = triangleMesh->subdivide();
         triangleMesh->verifyTopology();
+        levels.push_back(triangleMesh);
     }
     
     triangleMesh->getOrCreateEdges();
@@ -181,20 +298,25 @@ std::shared_ptr<TriangleMesh> TriangleMesh::createSphere(double radius, uint32_t
     uint32_t F = triangleMesh->getTriangleCount();
     uint32_t expectedF = 20 * (1u << (2 * subdivisionLevel)); // 20 * 4^subdivisionLevel
     assert(F == expectedF && "Triangle count mismatch for subdivided icosahedron");
+
+    if (subdivisionLevel > 0) {
+        triangleMesh->m_pHierarchy = std::make_shared<MeshHierarchy>(levels);
+    }
     
     return triangleMesh;
 }
 
-// Lazily compute and return edges
+// Lazily compute and return edges; vertices added or removed directly through Vertices also
+// invalidate them via the topology version
 std::shared_ptr<Edges> TriangleMesh::getOrCreateEdges() {
-    if (!m_pEdges) {
+    if (!m_pEdges || m_pEdges->getTopologyVersion() != getTopologyVersion()) {
         m_pEdges = Edges::computeEdges(*this);
     }
     return m_pEdges;
 }
 
 std::shared_ptr<const Edges> TriangleMesh::getOrCreateEdges() const {
-    if (!m_pEdges) {
+    if (!m_pEdges || m_pEdges->getTopologyVersion() != getTopologyVersion()) {
         m_pEdges = Edges::computeEdges(*this);
     }
     return m_pEdges;
@@ -221,7 +343,8 @@ void TriangleMesh::verifyTopology() const {
     }
 }
 
-// Subdivide the mesh once (creates a new subdivided mesh)
+// Subdivide the mesh once (creates a new subdivided mesh). Midpoints are appended to the shared
+// vertices and triangle t becomes triangles 4t..4t+3; MeshHierarchy relies on both.
 std::shared_ptr<TriangleMesh> TriangleMesh::subdivide() const {
     auto subdivided = std::make_shared<TriangleMesh>(m_pVertexMesh);
     
@@ -10,6 +10,7 @@
 #include "Identifiable.h"
 
 class Edges;
+class MeshHierarchy;
 
 class TriangleMesh : public Identifiable
 {
@@ -30,7 +31,7 @@ public:
     
     // Vertex mesh access
     std::shared_ptr<Vertices> getVertices() const { return m_pVertexMesh; }
-    void setVertices(std::shared_ptr<Vertices> vertexMesh) { m_pVertexMesh = vertexMesh; }
+    void setVertices(std::shared_ptr<Vertices> vertexMesh) { m_pVertexMesh = vertexMesh; incrementVersion(); }
     
     // Edge access (lazily computed)
     std::shared_ptr<Edges> getOrCreateEdges();
@@ -47,15 +48,40 @@ public:
     float3 computeBary(uint32_t triangleIndex, const float3& point) const;
     
     uint32_t addTriangle(uint32_t v1, uint32_t v2, uint32_t v3);
+    // Replace the whole triangle list (e.g. after remeshing)
+    void setTriangles(std::vector<uint3> triangles);
 
     // Clear mesh data (vertices and triangles)
     void clear();
     
     // Extract triangles (move out, leaving vertices intact)
     std::vector<uint3> extractTriangles();
+
+    // Permutation applied by reorderSpatially(): new index of every old vertex and triangle
+    struct Reordering
+    {
+        std::vector<uint32_t> m_newVertexIndex;
+        std::vector<uint32_t> m_newTriangleIndex;
+    };
+    // Sort vertices and triangles along a Morton (Z-order) curve so that elements close in space are
+    // close in memory. Triangle corners keep their order, so barycentric coordinates stay valid.
+    // Edges are recomputed for the new indices; other per-vertex or per-triangle data (PhysicsMesh,
+    // MeshLocation, ...) must be remapped by the caller with the returned permutation.
+    Reordering reorderSpatially();
+
+    // Subdivision levels recorded by createSphere() (see MeshHierarchy). Level 0 is the coarsest and
+    // getLevelCount() - 1 is this mesh. Topology changes other than reorderSpatially() drop the
+    // hierarchy, leaving this mesh as its only level.
+    uint32_t getLevelCount() const;
+    std::shared_ptr<TriangleMesh> getLevel(uint32_t uLevel);
+    // Bound on the distance between the surface of a level and this mesh (0 for this mesh)
+    float getLevelError(uint32_t uLevel) const;
+    std::shared_ptr<const MeshHierarchy> getHierarchy() const;
     
-    // Version tracking
+    // Version tracking: getVersion() changes whenever triangles or vertex positions change,
+    // getTopologyVersion() only when triangles or the vertex count change
     uint64_t getVersion() const { return m_version + m_pVertexMesh->getVersion(); }
+    uint64_t getTopologyVersion() const { return m_version + m_pVertexMesh->getTopologyVersion(); }
     
     // Bounding box
     box3 getBox() const;
@@ -73,5 +99,6 @@ protected:
     std::shared_ptr<Vertices> m_pVertexMesh;
     std::vector<uint3> m_triangles;
     mutable std::shared_ptr<Edges> m_pEdges;
-    uint64_t m_version = 0;
+    std::shared_ptr<MeshHierarchy> m_pHierarchy;
+    uint64_t m_version = 0; // triangle list version
 };
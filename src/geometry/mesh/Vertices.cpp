@@ -1,5 +1,7 @@
 #include "Vertices.h"
 #include <algorithm>
+#include <cassert>
+#include <cmath>
 
 // Constructor
 Vertices::Vertices() {
@@ -40,12 +42,14 @@ box3 Vertices::getBox() const {
 void Vertices::clear() {
     m_vertices.clear();
     ++m_version;
+    ++m_topologyVersion;
 }
 
 // Add a vertex to the mesh
 uint32_t Vertices::addVertex(const float3& position) {
     m_vertices.emplace_back(position);
     ++m_version;
+    ++m_topologyVersion;
     return static_cast<uint32_t>(m_vertices.size() - 1);
 }
 
@@ -60,11 +64,100 @@ float3 Vertices::getVertexPosition(uint32_t index) const {
 // Set vertex position
 void Vertices::setVertexPosition(uint32_t index, const float3& position) {
     if (index < m_vertices.size()) {
-        m_vertices[index].position = position;
+        assert(!m_bPositionUpdateOpen && "use the open PositionUpdate to move vertices");
+        resetMovedBits();
+        const float displacementSq = movePosition(index, position);
+        m_lastChange.m_fromVersion = m_version;
         ++m_version;
+        m_lastChange.m_toVersion = m_version;
+        m_lastChange.m_uBegin = index;
+        m_lastChange.m_uEnd = index + 1;
+        m_lastChange.m_fMaxDisplacement = std::sqrt(displacementSq);
     }
 }
 
+void Vertices::resetMovedBits() {
+    const uint32_t firstWord = m_lastChange.m_uBegin / 64;
+    const uint32_t endWord = std::min(static_cast<uint32_t>(m_movedBits.size()), (m_lastChange.m_uEnd + 63) / 64);
+    for (uint32_t w = firstWord; w < endWord; ++w) {
+        m_movedBits[w] = 0;
+    }
+    if (m_movedBits.size() * 64 < m_vertices.size()) {
+        m_movedBits.resize((m_vertices.size() + 63) / 64, 0);
+    }
+}
+
+float Vertices::movePosition(uint32_t index, const float3& position) {
+    float3& current = m_vertices[index].position;
+    const float3 delta = position - current;
+    current = position;
+    m_movedBits[index / 64] |= uint64_t(1) << (index % 64);
+    return dot(delta, delta);
+}
+
+// Bulk position update
+Vertices::PositionUpdate::PositionUpdate(Vertices& vertices)
+    : m_pVertices(&vertices)
+{
+    assert(!vertices.m_bPositionUpdateOpen && "only one PositionUpdate may be open per Vertices");
+    vertices.m_bPositionUpdateOpen = true;
+}
+
+void Vertices::PositionUpdate::set(uint32_t index, const float3& position) {
+    assert(m_pVertices && "PositionUpdate already committed");
+    if (index >= m_pVertices->m_vertices.size()) {
+        return;
+    }
+    const float3& current = m_pVertices->m_vertices[index].position;
+    if (current.x == position.x && current.y == position.y && current.z == position.z) {
+        return;
+    }
+    Vertices& vertices = *m_pVertices;
+    if (m_uBegin > m_uEnd) {
+        // First moved vertex of this scope: the previous write's bits are no longer current
+        vertices.resetMovedBits();
+        if (vertices.m_scopeStartPositions.size() < vertices.m_vertices.size()) {
+            vertices.m_scopeStartPositions.resize(vertices.m_vertices.size());
+        }
+        m_uBegin = index;
+        m_uEnd = index + 1;
+    }
+    m_uBegin = std::min(m_uBegin, index);
+    m_uEnd = std::max(m_uEnd, index + 1);
+    // Displacements are measured from the position before the scope, so a vertex written several
+    // times reports how far it got rather than its largest single write
+    if (!vertices.wasVertexMoved(index)) {
+        vertices.m_scopeStartPositions[index] = current;
+    }
+    const float3 delta = position - vertices.m_scopeStartPositions[index];
+    vertices.movePosition(index, position);
+    m_fMaxDisplacementSq = std::max(m_fMaxDisplacementSq, dot(delta, delta));
+}
+
+void Vertices::PositionUpdate::set(uint32_t uFirst, uint32_t n, const float* pX, const float* pY, const float* pZ) {
+    for (uint32_t i = 0; i < n; ++i) {
+        set(uFirst + i, float3(pX[i], pY[i], pZ[i]));
+    }
+}
+
+void Vertices::PositionUpdate::commit() {
+    if (!m_pVertices) {
+        return;
+    }
+    Vertices& vertices = *m_pVertices;
+    vertices.m_bPositionUpdateOpen = false;
+    m_pVertices = nullptr;
+    if (m_uBegin > m_uEnd) {
+        return;  // nothing moved
+    }
+    vertices.m_lastChange.m_fromVersion = vertices.m_version;
+    ++vertices.m_version;
+    vertices.m_lastChange.m_toVersion = vertices.m_version;
+    vertices.m_lastChange.m_uBegin = m_uBegin;
+    vertices.m_lastChange.m_uEnd = m_uEnd;
+    vertices.m_lastChange.m_fMaxDisplacement = std::sqrt(m_fMaxDisplacementSq);
+}
+
 // Get number of vertices
 uint32_t Vertices::getVertexCount() const {
     return static_cast<uint32_t>(m_vertices.size());
@@ -75,6 +168,32 @@ void Vertices::removeLastVertex() {
     if (!m_vertices.empty()) {
         m_vertices.pop_back();
         ++m_version;
+        ++m_topologyVersion;
     }
 }
 
+// Replace all positions; the vertex count may change
+void Vertices::assignPositions(const std::vector<float3>& positions) {
+    m_vertices.clear();
+    m_vertices.reserve(positions.size());
+    for (const float3& position : positions) {
+        m_vertices.emplace_back(position);
+    }
+    m_lastChange = PositionChange();
+    m_movedBits.clear();
+    ++m_version;
+    ++m_topologyVersion;
+}
+
+void Vertices::permuteVertices(const std::vector<uint32_t>& newIndex) {
+    assert(newIndex.size() == m_vertices.size() && "permutation size must match the vertex count");
+    std::vector<Vertex> permuted(m_vertices);
+    for (size_t i = 0; i < m_vertices.size(); ++i) {
+        permuted[newIndex[i]] = m_vertices[i];
+    }
+    m_vertices = std::move(permuted);
+    m_lastChange = PositionChange();
+    std::fill(m_movedBits.begin(), m_movedBits.end(), 0);
+    ++m_version;
+    ++m_topologyVersion;
+}
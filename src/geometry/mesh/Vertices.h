@@ -28,16 +28,65 @@ public:
     void setVertexPosition(uint32_t index, const float3& position);
     uint32_t getVertexCount() const;
     void removeLastVertex();
+    // Move vertex i to index newIndex[i]; newIndex must be a permutation of [0, getVertexCount()).
+    // Counts as a topology change since every index-keyed cache is invalidated.
+    void permuteVertices(const std::vector<uint32_t>& newIndex);
+    // Replace all vertices at once (the count may change); one topology change
+    void assignPositions(const std::vector<float3>& positions);
     
     // Clear mesh data
     virtual void clear();
     
-    // Version tracking
+    // Version tracking: getVersion() changes on any modification (including positions),
+    // getTopologyVersion() only when vertices are added or removed
     uint64_t getVersion() const { return m_version; }
+    uint64_t getTopologyVersion() const { return m_topologyVersion; }
 
     // Bounding box (cached based on version)
     box3 getBox() const;
 
+    // Summary of the last position write: one PositionUpdate commit or one setVertexPosition() call.
+    // A consumer that saw getVersion() == m_fromVersion can update itself from this summary alone.
+    struct PositionChange
+    {
+        uint64_t m_fromVersion = UINT64_MAX;  // version before the write
+        uint64_t m_toVersion = UINT64_MAX;    // version after the write
+        uint32_t m_uBegin = 0;                // range of moved vertices [m_uBegin, m_uEnd)
+        uint32_t m_uEnd = 0;
+        float m_fMaxDisplacement = 0.0f;      // largest distance of a vertex from its position before the write
+    };
+    const PositionChange& getLastPositionChange() const { return m_lastChange; }
+    // True if vertex index was moved by the last position write
+    bool wasVertexMoved(uint32_t index) const
+    {
+        return index / 64 < m_movedBits.size() && (m_movedBits[index / 64] >> (index % 64)) & 1;
+    }
+
+    // Scope for writing many positions with a single version bump. Positions are stored right away,
+    // but version-keyed caches (getBox(), BVHs, ...) see the change only once the scope commits,
+    // explicitly or on destruction. Writes that do not move a vertex are ignored, and a scope that
+    // moved nothing leaves the version unchanged. Only one scope may be open per Vertices.
+    class PositionUpdate
+    {
+    public:
+        explicit PositionUpdate(Vertices& vertices);
+        ~PositionUpdate() { commit(); }
+        PositionUpdate(const PositionUpdate&) = delete;
+        PositionUpdate& operator=(const PositionUpdate&) = delete;
+
+        void set(uint32_t index, const float3& position);
+        // Positions of vertices [uFirst, uFirst + n) given as separate x, y, z arrays
+        void set(uint32_t uFirst, uint32_t n, const float* pX, const float* pY, const float* pZ);
+        void commit();
+
+    private:
+        Vertices* m_pVertices;
+        uint32_t m_uBegin = UINT32_MAX;
+        uint32_t m_uEnd = 0;
+        float m_fMaxDisplacementSq = 0.0f;
+    };
+    PositionUpdate beginPositionUpdate() { return PositionUpdate(*this); }
+
 protected:
     // Helper for derived classes to notify of changes
     void incrementVersion() { ++m_version; }
@@ -45,7 +94,19 @@ protected:
 private:
     std::vector<Vertex> m_vertices;
     uint64_t m_version = 0;
+    uint64_t m_topologyVersion = 0;
     
+    // Last position write
+    PositionChange m_lastChange;
+    std::vector<uint64_t> m_movedBits;    // one bit per vertex, set for vertices moved by the last write
+    std::vector<float3> m_scopeStartPositions;  // of the vertices moved by the open PositionUpdate, before it
+    bool m_bPositionUpdateOpen = false;
+
+    // Clear moved bits of the previous write before a new one is recorded
+    void resetMovedBits();
+    // Store a position and mark the vertex as moved; returns the squared displacement
+    float movePosition(uint32_t index, const float3& position);
+
     // Cached bounding box
     mutable box3 m_cachedBox = box3::empty();
     mutable uint64_t m_cachedBoxVersion = UINT64_MAX; // Invalid version initially
@@ -99,4 +99,80 @@ inline vector<T, 3> computeBarycentricCoordinates(const vector<T, 3>& point,
     return vector<T, 3>(w, u, v);
 }
 
+// Closest point on triangle (a, b, c) to point p (Ericson, Real-Time Collision Detection 5.1.5).
+// outBary receives its barycentric coordinates; components are exactly zero when the closest point
+// lies on an edge or vertex, which identifies the closest feature.
+template <class T>
+inline vector<T, 3> closestPointOnTriangle(const vector<T, 3>& p,
+                                           const vector<T, 3>& a,
+                                           const vector<T, 3>& b,
+                                           const vector<T, 3>& c,
+                                           vector<T, 3>& outBary)
+{
+    const vector<T, 3> ab = b - a;
+    const vector<T, 3> ac = c - a;
+
+    // Vertex region of a
+    const vector<T, 3> ap = p - a;
+    const T d1 = dot(ab, ap);
+    const T d2 = dot(ac, ap);
+    if (d1 <= T(0) && d2 <= T(0))
+    {
+        outBary = vector<T, 3>(T(1), T(0), T(0));
+        return a;
+    }
+
+    // Vertex region of b
+    const vector<T, 3> bp = p - b;
+    const T d3 = dot(ab, bp);
+    const T d4 = dot(ac, bp);
+    if (d3 >= T(0) && d4 <= d3)
+    {
+        outBary = vector<T, 3>(T(0), T(1), T(0));
+        return b;
+    }
+
+    // Edge region ab
+    const T vc = d1 * d4 - d3 * d2;
+    if (vc <= T(0) && d1 >= T(0) && d3 <= T(0))
+    {
+        const T v = d1 / (d1 - d3);
+        outBary = vector<T, 3>(T(1) - v, v, T(0));
+        return a + ab * v;
+    }
 
+    // Vertex region of c
+    const vector<T, 3> cp = p - c;
+    const T d5 = dot(ab, cp);
+    const T d6 = dot(ac, cp);
+    if (d6 >= T(0) && d5 <= d6)
+    {
+        outBary = vector<T, 3>(T(0), T(0), T(1));
+        return c;
+    }
+
+    // Edge region ac
+    const T vb = d5 * d2 - d1 * d6;
+    if (vb <= T(0) && d2 >= T(0) && d6 <= T(0))
+    {
+        const T w = d2 / (d2 - d6);
+        outBary = vector<T, 3>(T(1) - w, T(0), w);
+        return a + ac * w;
+    }
+
+    // Edge region bc
+    const T va = d3 * d6 - d5 * d4;
+    if (va <= T(0) && (d4 - d3) >= T(0) && (d5 - d6) >= T(0))
+    {
+        const T w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        outBary = vector<T, 3>(T(0), T(1) - w, w);
+        return b + (c - b) * w;
+    }
+
+    // Face region
+    const T denom = T(1) / (va + vb + vc);
+    const T v = vb * denom;
+    const T w = vc * denom;
+    outBary = vector<T, 3>(T(1) - v - w, v, w);
+    return a + ab * v + ac * w;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+// Four float lanes processed together. Maps to SSE registers on x86/x64 and falls back to plain
+// per-lane loops elsewhere. Comparisons return lane masks (all bits set where true) that can be
+// combined with &, | and turned into a 4-bit integer with movemask().
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SIMD4_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define SIMD4_USE_SSE 0
+#endif
+
+struct simd4f
+{
+#if SIMD4_USE_SSE
+    __m128 m_v;
+
+    simd4f() = default;
+    explicit simd4f(__m128 v) : m_v(v) { }
+
+    static simd4f broadcast(float f) { return simd4f(_mm_set1_ps(f)); }
+    static simd4f zero() { return simd4f(_mm_setzero_ps()); }
+    // p must be 16-byte aligned
+    static simd4f load(const float* p) { return simd4f(_mm_load_ps(p)); }
+    static simd4f loadUnaligned(const float* p) { return simd4f(_mm_loadu_ps(p)); }
+    void store(float* p) const { _mm_store_ps(p, m_v); }
+    void storeUnaligned(float* p) const { _mm_storeu_ps(p, m_v); }
+#else
+    float m_v[4];
+
+    static simd4f broadcast(float f) { simd4f r; for (int i = 0; i < 4; ++i) r.m_v[i] = f; return r; }
+    static simd4f zero() { return broadcast(0.0f); }
+    static simd4f load(const float* p) { simd4f r; for (int i = 0; i < 4; ++i) r.m_v[i] = p[i]; return r; }
+    static simd4f loadUnaligned(const float* p) { return load(p); }
+    void store(float* p) const { for (int i = 0; i < 4; ++i) p[i] = m_v[i]; }
+    void storeUnaligned(float* p) const { store(p); }
+#endif
+};
+
+#if SIMD4_USE_SSE
+
+inline simd4f operator+(simd4f a, simd4f b) { return simd4f(_mm_add_ps(a.m_v, b.m_v)); }
+inline simd4f operator-(simd4f a, simd4f b) { return simd4f(_mm_sub_ps(a.m_v, b.m_v)); }
+inline simd4f operator*(simd4f a, simd4f b) { return simd4f(_mm_mul_ps(a.m_v, b.m_v)); }
+inline simd4f operator/(simd4f a, simd4f b) { return simd4f(_mm_div_ps(a.m_v, b.m_v)); }
+inline simd4f operator&(simd4f a, simd4f b) { return simd4f(_mm_and_ps(a.m_v, b.m_v)); }
+inline simd4f operator|(simd4f a, simd4f b) { return simd4f(_mm_or_ps(a.m_v, b.m_v)); }
+inline simd4f operator<(simd4f a, simd4f b) { return simd4f(_mm_cmplt_ps(a.m_v, b.m_v)); }
+inline simd4f operator<=(simd4f a, simd4f b) { return simd4f(_mm_cmple_ps(a.m_v, b.m_v)); }
+inline simd4f operator>(simd4f a, simd4f b) { return simd4f(_mm_cmpgt_ps(a.m_v, b.m_v)); }
+inline simd4f operator>=(simd4f a, simd4f b) { return simd4f(_mm_cmpge_ps(a.m_v, b.m_v)); }
+inline simd4f min(simd4f a, simd4f b) { return simd4f(_mm_min_ps(a.m_v, b.m_v)); }
+inline simd4f max(simd4f a, simd4f b) { return simd4f(_mm_max_ps(a.m_v, b.m_v)); }
+inline simd4f sqrt(simd4f a) { return simd4f(_mm_sqrt_ps(a.m_v)); }
+// Reciprocal square root estimate (about 12 bits); refine with a Newton step where accuracy matters
+inline simd4f rsqrtEstimate(simd4f a) { return simd4f(_mm_rsqrt_ps(a.m_v)); }
+// Bit i is set if lane i of the mask is set
+inline int movemask(simd4f mask) { return _mm_movemask_ps(mask.m_v); }
+
+#else
+
+namespace simd4detail
+{
+    inline float maskLane(bool b) { uint32_t u = b ? 0xffffffffu : 0u; float f; std::memcpy(&f, &u, sizeof(f)); return f; }
+    inline uint32_t laneBits(float f) { uint32_t u; std::memcpy(&u, &f, sizeof(u)); return u; }
+    inline float bitsLane(uint32_t u) { float f; std::memcpy(&f, &u, sizeof(f)); return f; }
+}
+
+#define SIMD4_LANEWISE(expr) simd4f r; for (int i = 0; i < 4; ++i) { r.m_v[i] = (expr); } return r;
+
+inline simd4f operator+(simd4f a, simd4f b) { SIMD4_LANEWISE(a.m_v[i] + b.m_v[i]) }
+inline simd4f operator-(simd4f a, simd4f b) { SIMD4_LANEWISE(a.m_v[i] - b.m_v[i]) }
+inline simd4f operator*(simd4f a, simd4f b) { SIMD4_LANEWISE(a.m_v[i] * b.m_v[i]) }
+inline simd4f operator/(simd4f a, simd4f b) { SIMD4_LANEWISE(a.m_v[i] / b.m_v[i]) }
+inline simd4f operator&(simd4f a, simd4f b) { SIMD4_LANEWISE(simd4detail::bitsLane(simd4detail::laneBits(a.m_v[i]) & simd4detail::laneBits(b.m_v[i]))) }
+inline simd4f operator|(simd4f a, simd4f b) { SIMD4_LANEWISE(simd4detail::bitsLane(simd4detail::laneBits(a.m_v[i]) | simd4detail::laneBits(b.m_v[i]))) }
+inline simd4f operator<(simd4f a, simd4f b) { SIMD4_LANEWISE(simd4detail::maskLane(a.m_v[i] < b.m_v[i])) }
+inline simd4f operator<=(simd4f a, simd4f b) { SIMD4_LANEWISE(simd4detail::maskLane(a.m_v[i] <= b.m_v[i])) }
+inline simd4f operator>(simd4f a, simd4f b) { SIMD4_LANEWISE(simd4detail::maskLane(a.m_v[i] > b.m_v[i])) }
+inline simd4f operator>=(simd4f a, simd4f b) { SIMD4_LANEWISE(simd4detail::maskLane(a.m_v[i] >= b.m_v[i])) }
+// Same operand order as minps/maxps: the second operand is returned when either is NaN
+inline simd4f min(simd4f a, simd4f b) { SIMD4_LANEWISE(a.m_v[i] < b.m_v[i] ? a.m_v[i] : b.m_v[i]) }
+inline simd4f max(simd4f a, simd4f b) { SIMD4_LANEWISE(a.m_v[i] > b.m_v[i] ? a.m_v[i] : b.m_v[i]) }
+inline simd4f sqrt(simd4f a) { SIMD4_LANEWISE(std::sqrt(a.m_v[i])) }
+inline simd4f rsqrtEstimate(simd4f a) { SIMD4_LANEWISE(1.0f / std::sqrt(a.m_v[i])) }
+inline int movemask(simd4f mask)
+{
+    int bits = 0;
+    for (int i = 0; i < 4; ++i)
+        bits |= (simd4detail::laneBits(mask.m_v[i]) >> 31) << i;
+    return bits;
+}
+
+#undef SIMD4_LANEWISE
+
+#endif
+
+// Four double lanes with the same interface (two SSE2 registers, or plain loops)
+struct simd4d
+{
+#if SIMD4_USE_SSE
+    __m128d m_lo, m_hi;
+
+    simd4d() = default;
+    simd4d(__m128d lo, __m128d hi) : m_lo(lo), m_hi(hi) { }
+
+    static simd4d broadcast(double f) { return simd4d(_mm_set1_pd(f), _mm_set1_pd(f)); }
+    static simd4d zero() { return simd4d(_mm_setzero_pd(), _mm_setzero_pd()); }
+    // p must be 16-byte aligned
+    static simd4d load(const double* p) { return simd4d(_mm_load_pd(p), _mm_load_pd(p + 2)); }
+    static simd4d loadUnaligned(const double* p) { return simd4d(_mm_loadu_pd(p), _mm_loadu_pd(p + 2)); }
+    void store(double* p) const { _mm_store_pd(p, m_lo); _mm_store_pd(p + 2, m_hi); }
+    void storeUnaligned(double* p) const { _mm_storeu_pd(p, m_lo); _mm_storeu_pd(p + 2, m_hi); }
+#else
+    double m_v[4];
+
+    static simd4d broadcast(double f) { simd4d r; for (int i = 0; i < 4; ++i) r.m_v[i] = f; return r; }
+    static simd4d zero() { return broadcast(0.0); }
+    static simd4d load(const double* p) { simd4d r; for (int i = 0; i < 4; ++i) r.m_v[i] = p[i]; return r; }
+    static simd4d loadUnaligned(const double* p) { return load(p); }
+    void store(double* p) const { for (int i = 0; i < 4; ++i) p[i] = m_v[i]; }
+    void storeUnaligned(double* p) const { store(p); }
+#endif
+};
+
+#if SIMD4_USE_SSE
+
+#define SIMD4D_BINARY(op, intrinsic) \
+    inline simd4d op(simd4d a, simd4d b) { return simd4d(intrinsic(a.m_lo, b.m_lo), intrinsic(a.m_hi, b.m_hi)); }
+SIMD4D_BINARY(operator+, _mm_add_pd)
+SIMD4D_BINARY(operator-, _mm_sub_pd)
+SIMD4D_BINARY(operator*, _mm_mul_pd)
+SIMD4D_BINARY(operator/, _mm_div_pd)
+SIMD4D_BINARY(min, _mm_min_pd)
+SIMD4D_BINARY(max, _mm_max_pd)
+#undef SIMD4D_BINARY
+inline simd4d sqrt(simd4d a) { return simd4d(_mm_sqrt_pd(a.m_lo), _mm_sqrt_pd(a.m_hi)); }
+
+#else
+
+#define SIMD4_LANEWISE(expr) simd4d r; for (int i = 0; i < 4; ++i) { r.m_v[i] = (expr); } return r;
+inline simd4d operator+(simd4d a, simd4d b) { SIMD4_LANEWISE(a.m_v[i] + b.m_v[i]) }
+inline simd4d operator-(simd4d a, simd4d b) { SIMD4_LANEWISE(a.m_v[i] - b.m_v[i]) }
+inline simd4d operator*(simd4d a, simd4d b) { SIMD4_LANEWISE(a.m_v[i] * b.m_v[i]) }
+inline simd4d operator/(simd4d a, simd4d b) { SIMD4_LANEWISE(a.m_v[i] / b.m_v[i]) }
+inline simd4d min(simd4d a, simd4d b) { SIMD4_LANEWISE(a.m_v[i] < b.m_v[i] ? a.m_v[i] : b.m_v[i]) }
+inline simd4d max(simd4d a, simd4d b) { SIMD4_LANEWISE(a.m_v[i] > b.m_v[i] ? a.m_v[i] : b.m_v[i]) }
+inline simd4d sqrt(simd4d a) { SIMD4_LANEWISE(std::sqrt(a.m_v[i])) }
+#undef SIMD4_LANEWISE
+
+#endif
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include "vector.h"
+#include "matrix.h"
+#include "affine.h"
+#include "simd4.h"
+#include <type_traits>
+
+// Vector math over arrays of 3D points and directions in SoA form (separate x, y, z arrays).
+// Four elements are processed per SIMD step (simd4f for float, simd4d for double) and the tail
+// with the same scalar expressions as vector.h/affine.h. Every kernel evaluates the operations
+// of its scalar counterpart in the same order without fused multiply-add, so with
+// BatchPrecision::STRICT the results are bit-identical, signed zeros included, to looping over
+// transformPoint(), dot(), normalize(), ... (given the scalar code is not compiled with FMA
+// contraction); tests/vectorBatch checks this.
+// Outputs may alias the corresponding inputs.
+
+enum class BatchPrecision
+{
+    STRICT,     // bit-identical to the scalar functions
+    FAST        // may use hardware estimates (reciprocal square root) with ~1e-7 relative error
+};
+
+template <typename T> struct BatchLanes;
+template <> struct BatchLanes<float> { typedef simd4f type; };
+template <> struct BatchLanes<double> { typedef simd4d type; };
+
+// Points: out = p * linear + translation (affine<T, 3>::transformPoint)
+template <typename T>
+void batchTransformPoints(const affine<T, 3>& xf, const T* pX, const T* pY, const T* pZ,
+                          T* pOutX, T* pOutY, T* pOutZ, size_t n)
+{
+    typedef typename BatchLanes<T>::type L;
+    const matrix<T, 3, 3>& m = xf.m_linear;
+    const L m00 = L::broadcast(m.row0.x), m01 = L::broadcast(m.row0.y), m02 = L::broadcast(m.row0.z);
+    const L m10 = L::broadcast(m.row1.x), m11 = L::broadcast(m.row1.y), m12 = L::broadcast(m.row1.z);
+    const L m20 = L::broadcast(m.row2.x), m21 = L::broadcast(m.row2.y), m22 = L::broadcast(m.row2.z);
+    const L tx = L::broadcast(xf.m_translation.x), ty = L::broadcast(xf.m_translation.y), tz = L::broadcast(xf.m_translation.z);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const L x = L::loadUnaligned(pX + i), y = L::loadUnaligned(pY + i), z = L::loadUnaligned(pZ + i);
+        (x * m00 + y * m10 + z * m20 + tx).storeUnaligned(pOutX + i);
+        (x * m01 + y * m11 + z * m21 + ty).storeUnaligned(pOutY + i);
+        (x * m02 + y * m12 + z * m22 + tz).storeUnaligned(pOutZ + i);
+    }
+    for (; i < n; ++i)
+    {
+        const vector<T, 3> r = xf.transformPoint(vector<T, 3>(pX[i], pY[i], pZ[i]));
+        pOutX[i] = r.x; pOutY[i] = r.y; pOutZ[i] = r.z;
+    }
+}
+
+// Directions: out = v * linear (affine<T, 3>::transformVector)
+template <typename T>
+void batchTransformVectors(const affine<T, 3>& xf, const T* pX, const T* pY, const T* pZ,
+                           T* pOutX, T* pOutY, T* pOutZ, size_t n)
+{
+    typedef typename BatchLanes<T>::type L;
+    const matrix<T, 3, 3>& m = xf.m_linear;
+    const L m00 = L::broadcast(m.row0.x), m01 = L::broadcast(m.row0.y), m02 = L::broadcast(m.row0.z);
+    const L m10 = L::broadcast(m.row1.x), m11 = L::broadcast(m.row1.y), m12 = L::broadcast(m.row1.z);
+    const L m20 = L::broadcast(m.row2.x), m21 = L::broadcast(m.row2.y), m22 = L::broadcast(m.row2.z);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const L x = L::loadUnaligned(pX + i), y = L::loadUnaligned(pY + i), z = L::loadUnaligned(pZ + i);
+        (x * m00 + y * m10 + z * m20).storeUnaligned(pOutX + i);
+        (x * m01 + y * m11 + z * m21).storeUnaligned(pOutY + i);
+        (x * m02 + y * m12 + z * m22).storeUnaligned(pOutZ + i);
+    }
+    for (; i < n; ++i)
+    {
+        const vector<T, 3> r = xf.transformVector(vector<T, 3>(pX[i], pY[i], pZ[i]));
+        pOutX[i] = r.x; pOutY[i] = r.y; pOutZ[i] = r.z;
+    }
+}
+
+// Homogeneous points (w = 1) through a 4x4 matrix: out = float4(p, 1) * m, w written to pOutW
+template <typename T>
+void batchTransformPoints(const matrix<T, 4, 4>& m, const T* pX, const T* pY, const T* pZ,
+                          T* pOutX, T* pOutY, T* pOutZ, T* pOutW, size_t n)
+{
+    typedef typename BatchLanes<T>::type L;
+    const L m00 = L::broadcast(m.row0.x), m01 = L::broadcast(m.row0.y), m02 = L::broadcast(m.row0.z), m03 = L::broadcast(m.row0.w);
+    const L m10 = L::broadcast(m.row1.x), m11 = L::broadcast(m.row1.y), m12 = L::broadcast(m.row1.z), m13 = L::broadcast(m.row1.w);
+    const L m20 = L::broadcast(m.row2.x), m21 = L::broadcast(m.row2.y), m22 = L::broadcast(m.row2.z), m23 = L::broadcast(m.row2.w);
+    const L m30 = L::broadcast(m.row3.x), m31 = L::broadcast(m.row3.y), m32 = L::broadcast(m.row3.z), m33 = L::broadcast(m.row3.w);
+    const L one = L::broadcast(T(1));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const L x = L::loadUnaligned(pX + i), y = L::loadUnaligned(pY + i), z = L::loadUnaligned(pZ + i);
+        (x * m00 + y * m10 + z * m20 + one * m30).storeUnaligned(pOutX + i);
+        (x * m01 + y * m11 + z * m21 + one * m31).storeUnaligned(pOutY + i);
+        (x * m02 + y * m12 + z * m22 + one * m32).storeUnaligned(pOutZ + i);
+        (x * m03 + y * m13 + z * m23 + one * m33).storeUnaligned(pOutW + i);
+    }
+    for (; i < n; ++i)
+    {
+        const vector<T, 4> r = vector<T, 4>(pX[i], pY[i], pZ[i], T(1)) * m;
+        pOutX[i] = r.x; pOutY[i] = r.y; pOutZ[i] = r.z; pOutW[i] = r.w;
+    }
+}
+
+// out[i] = dot(a[i], b[i])
+template <typename T>
+void batchDot(const T* pAX, const T* pAY, const T* pAZ, const T* pBX, const T* pBY, const T* pBZ, T* pOut, size_t n)
+{
+    typedef typename BatchLanes<T>::type L;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        (L::loadUnaligned(pAX + i) * L::loadUnaligned(pBX + i) + L::loadUnaligned(pAY + i) * L::loadUnaligned(pBY + i)
+            + L::loadUnaligned(pAZ + i) * L::loadUnaligned(pBZ + i)).storeUnaligned(pOut + i);
+    }
+    for (; i < n; ++i)
+    {
+        pOut[i] = dot(vector<T, 3>(pAX[i], pAY[i], pAZ[i]), vector<T, 3>(pBX[i], pBY[i], pBZ[i]));
+    }
+}
+
+// out[i] = cross(a[i], b[i])
+template <typename T>
+void batchCross(const T* pAX, const T* pAY, const T* pAZ, const T* pBX, const T* pBY, const T* pBZ,
+                T* pOutX, T* pOutY, T* pOutZ, size_t n)
+{
+    typedef typename BatchLanes<T>::type L;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const L ax = L::loadUnaligned(pAX + i), ay = L::loadUnaligned(pAY + i), az = L::loadUnaligned(pAZ + i);
+        const L bx = L::loadUnaligned(pBX + i), by = L::loadUnaligned(pBY + i), bz = L::loadUnaligned(pBZ + i);
+        (ay * bz - az * by).storeUnaligned(pOutX + i);
+        (az * bx - ax * bz).storeUnaligned(pOutY + i);
+        (ax * by - ay * bx).storeUnaligned(pOutZ + i);
+    }
+    for (; i < n; ++i)
+    {
+        const vector<T, 3> r = cross(vector<T, 3>(pAX[i], pAY[i], pAZ[i]), vector<T, 3>(pBX[i], pBY[i], pBZ[i]));
+        pOutX[i] = r.x; pOutY[i] = r.y; pOutZ[i] = r.z;
+    }
+}
+
+// out[i] = length(v[i])
+template <typename T>
+void batchLength(const T* pX, const T* pY, const T* pZ, T* pOut, size_t n)
+{
+    typedef typename BatchLanes<T>::type L;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const L x = L::loadUnaligned(pX + i), y = L::loadUnaligned(pY + i), z = L::loadUnaligned(pZ + i);
+        sqrt(x * x + y * y + z * z).storeUnaligned(pOut + i);
+    }
+    for (; i < n; ++i)
+    {
+        pOut[i] = length(vector<T, 3>(pX[i], pY[i], pZ[i]));
+    }
+}
+
+namespace vectorBatchDetail
+{
+    // Strict: v / sqrt(dot(v, v)) exactly like normalize()
+    template <typename L>
+    inline void normalizeLanes(L& x, L& y, L& z, std::integral_constant<BatchPrecision, BatchPrecision::STRICT>)
+    {
+        const L len = sqrt(x * x + y * y + z * z);
+        x = x / len; y = y / len; z = z / len;
+    }
+    template <typename L>
+    inline void normalizeLanes(L& x, L& y, L& z, std::integral_constant<BatchPrecision, BatchPrecision::FAST>)
+    {
+        normalizeLanes(x, y, z, std::integral_constant<BatchPrecision, BatchPrecision::STRICT>());
+    }
+    // Fast float path: reciprocal square root estimate refined by one Newton-Raphson step
+    inline void normalizeLanes(simd4f& x, simd4f& y, simd4f& z, std::integral_constant<BatchPrecision, BatchPrecision::FAST>)
+    {
+        const simd4f lenSq = x * x + y * y + z * z;
+        const simd4f r = rsqrtEstimate(lenSq);
+        const simd4f inv = r * (simd4f::broadcast(1.5f) - simd4f::broadcast(0.5f) * lenSq * r * r);
+        x = x * inv; y = y * inv; z = z * inv;
+    }
+}
+
+// v[i] = normalize(v[i]) in place; zero vectors produce NaN like normalize()
+template <BatchPrecision precision = BatchPrecision::STRICT, typename T>
+void batchNormalize(T* pX, T* pY, T* pZ, size_t n)
+{
+    typedef typename BatchLanes<T>::type L;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        L x = L::loadUnaligned(pX + i), y = L::loadUnaligned(pY + i), z = L::loadUnaligned(pZ + i);
+        vectorBatchDetail::normalizeLanes(x, y, z, std::integral_constant<BatchPrecision, precision>());
+        x.storeUnaligned(pX + i); y.storeUnaligned(pY + i); z.storeUnaligned(pZ + i);
+    }
+    for (; i < n; ++i)
+    {
+        const vector<T, 3> r = normalize(vector<T, 3>(pX[i], pY[i], pZ[i]));
+        pX[i] = r.x; pY[i] = r.y; pZ[i] = r.z;
+    }
+}
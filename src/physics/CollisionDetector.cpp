@@ -0,0 +1,290 @@
+#include "CollisionDetector.h"
+#include "geometry/geomHelpers/BVHMesh.h"
+#include "geometry/geomHelpers/BVHCache.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include <algorithm>
+#include <cmath>
+
+uint32_t CollisionDetector::addBody(std::shared_ptr<PhysicsMesh> pBody, std::shared_ptr<ContactConstraintXPBD> pContacts,
+                                   const float3& vOffset)
+{
+    const uint32_t uBody = static_cast<uint32_t>(m_bodies.size());
+    m_bodies.push_back(Body{ pBody, pContacts, vOffset, false, nullptr, false, box3(), {} });
+    m_endpoints.push_back(Endpoint{ 0.0f, uBody, true });
+    m_endpoints.push_back(Endpoint{ 0.0f, uBody, false });
+    return uBody;
+}
+
+void CollisionDetector::clearBodies()
+{
+    m_bodies.clear();
+    m_endpoints.clear();
+}
+
+void CollisionDetector::setEggshell(const float3& vCenter, const float3& vSemiAxes)
+{
+    m_bEggshell = true;
+    m_vEggshellCenter = vCenter;
+    m_vEggshellSemiAxes = vSemiAxes;
+}
+
+void CollisionDetector::detect()
+{
+    m_stats = Stats();
+    const float fMargin = m_settings.m_fContactMargin;
+    for (Body& body : m_bodies)
+    {
+        body.m_pContacts->clearContacts();
+        body.m_bBVHCurrent = false;
+        body.m_box = body.m_pBody->m_pMesh->getBox().translate(body.m_vOffset).grow(fMargin);
+        if (body.m_candidateStamps.size() != body.m_pBody->getVertexCount())
+            body.m_candidateStamps.assign(body.m_pBody->getVertexCount(), 0);
+    }
+
+    findBodyPairs();
+    m_stats.m_nBroadphasePairs = static_cast<uint32_t>(m_bodyPairs.size());
+    for (const auto& pair : m_bodyPairs)
+    {
+        if (m_bodies[pair.first].m_bSleeping && m_bodies[pair.second].m_bSleeping)
+        {
+            ++m_stats.m_nSleepingPairs;
+            continue;
+        }
+        collideBodies(pair.first, pair.second);
+    }
+
+    if (m_bEggshell)
+    {
+        for (uint32_t uBody = 0; uBody < m_bodies.size(); ++uBody)
+        {
+            if (!m_bodies[uBody].m_bSleeping)
+                collideEggshell(uBody);
+        }
+    }
+}
+
+void CollisionDetector::findBodyPairs()
+{
+    m_bodyPairs.clear();
+    if (m_bodies.size() < 2)
+        return;
+
+    // Bodies without a valid box (no vertices, or positions that are not numbers) take no part:
+    // their max end could sort before their min end
+    auto hasBox = [](const Body& body) { return all(body.m_box.m_mins <= body.m_box.m_maxs); };
+
+    // Sweep along the axis the body centres spread most on, so that few boxes overlap on it
+    float3 mean(0, 0, 0), meanSq(0, 0, 0);
+    uint32_t nBoxes = 0;
+    for (const Body& body : m_bodies)
+    {
+        if (!hasBox(body))
+            continue;
+        const float3 c = body.m_box.center();
+        mean += c;
+        meanSq += c * c;
+        ++nBoxes;
+    }
+    if (nBoxes < 2)
+        return;
+    const float invCount = 1.0f / float(nBoxes);
+    const float3 variance = meanSq * invCount - (mean * invCount) * (mean * invCount);
+    m_sweepAxis = (variance.x >= variance.y && variance.x >= variance.z) ? 0 : (variance.y >= variance.z ? 1 : 2);
+
+    // Insertion sort of the previous order: nearly linear while bodies move little. Minimum ends go
+    // first among equal values so that touching boxes count as overlapping.
+    for (Endpoint& endpoint : m_endpoints)
+    {
+        const box3& box = m_bodies[endpoint.m_uBody].m_box;
+        endpoint.m_fValue = endpoint.m_bMin ? box.m_mins[m_sweepAxis] : box.m_maxs[m_sweepAxis];
+    }
+    auto before = [](const Endpoint& a, const Endpoint& b)
+    {
+        return a.m_fValue < b.m_fValue || (a.m_fValue == b.m_fValue && a.m_bMin && !b.m_bMin);
+    };
+    for (size_t i = 1; i < m_endpoints.size(); ++i)
+    {
+        const Endpoint endpoint = m_endpoints[i];
+        size_t j = i;
+        for (; j > 0 && before(endpoint, m_endpoints[j - 1]); --j)
+            m_endpoints[j] = m_endpoints[j - 1];
+        m_endpoints[j] = endpoint;
+    }
+
+    // Sweep: every body entering pairs with the bodies whose interval is open, if their boxes also
+    // overlap on the other axes
+    m_activeBodies.clear();
+    for (const Endpoint& endpoint : m_endpoints)
+    {
+        if (!hasBox(m_bodies[endpoint.m_uBody]))
+            continue;
+        if (!endpoint.m_bMin)
+        {
+            m_activeBodies.erase(std::find(m_activeBodies.begin(), m_activeBodies.end(), endpoint.m_uBody));
+            continue;
+        }
+        const box3& box = m_bodies[endpoint.m_uBody].m_box;
+        for (uint32_t uOther : m_activeBodies)
+        {
+            if (box.intersects(m_bodies[uOther].m_box))
+                m_bodyPairs.emplace_back(std::min(uOther, endpoint.m_uBody), std::max(uOther, endpoint.m_uBody));
+        }
+        m_activeBodies.push_back(endpoint.m_uBody);
+    }
+    // Contacts are added in body order whatever the sweep order was
+    std::sort(m_bodyPairs.begin(), m_bodyPairs.end());
+}
+
+void CollisionDetector::collideBodies(uint32_t uA, uint32_t uB)
+{
+    // BVHs are brought up to date only for bodies that have a broadphase pair
+    for (uint32_t uBody : { uA, uB })
+    {
+        Body& body = m_bodies[uBody];
+        if (!body.m_bBVHCurrent)
+        {
+            body.m_pBVH = BVHCache::instance().getOrCreate(body.m_pBody->m_pMesh);
+            body.m_bBVHCurrent = true;
+        }
+    }
+    const Body& a = m_bodies[uA];
+    const Body& b = m_bodies[uB];
+    a.m_pBVH->getBVH().findOverlaps(b.m_pBVH->getBVH(), b.m_vOffset - a.m_vOffset, m_settings.m_fContactMargin,
+                                    m_trianglePairs);
+    if (m_trianglePairs.empty())
+        return;
+
+    // Vertices of the close triangles of each side, once each, in the order first met
+    const TriangleMesh& meshA = *a.m_pBody->m_pMesh;
+    const TriangleMesh& meshB = *b.m_pBody->m_pMesh;
+    for (int side = 0; side < 2; ++side)
+    {
+        Body& body = m_bodies[side == 0 ? uA : uB];
+        const TriangleMesh& mesh = (side == 0) ? meshA : meshB;
+        ++m_uCandidateStamp;
+        m_candidates.clear();
+        for (const BVH::SubObjectPair& pair : m_trianglePairs)
+        {
+            const uint3 triangle = mesh.getTriangleVertices(side == 0 ? pair.m_uSubObj : pair.m_uOtherSubObj);
+            for (uint32_t v : { triangle.x, triangle.y, triangle.z })
+            {
+                if (body.m_candidateStamps[v] != m_uCandidateStamp)
+                {
+                    body.m_candidateStamps[v] = m_uCandidateStamp;
+                    m_candidates.push_back(v);
+                }
+            }
+        }
+        collideVertices(side == 0 ? uA : uB, side == 0 ? uB : uA);
+    }
+}
+
+void CollisionDetector::collideVertices(uint32_t uA, uint32_t uB)
+{
+    const Body& a = m_bodies[uA];
+    const Body& b = m_bodies[uB];
+    const Vertices& verticesA = *a.m_pBody->m_pMesh->getVertices();
+    const TriangleMesh& meshB = *b.m_pBody->m_pMesh;
+    const float3 vAToB = a.m_vOffset - b.m_vOffset;
+    const float fMargin = m_settings.m_fContactMargin;
+    const float fMaxMove = m_settings.m_fMaxDepenetration;
+
+    for (uint32_t v : m_candidates)
+    {
+        const float3 vPosInB = verticesA.getVertexPosition(v) + vAToB;
+        BVHMesh::ClosestPoint closest;
+        const float fDistance = b.m_pBVH->computeSignedDistance(vPosInB, &closest);
+        if (!closest.isValid() || fDistance >= fMargin)
+            continue;
+
+        // Outward normal of B at the closest point: along the offset to the vertex, or the
+        // triangle's normal turned outward where the vertex lies on the surface
+        double3 normal;
+        const double3 offset = double3(vPosInB) - double3(closest.m_vPoint);
+        const double offsetLength = length(offset);
+        if (offsetLength > 1e-6)
+        {
+            normal = offset / (fDistance < 0.0f ? -offsetLength : offsetLength);
+        }
+        else
+        {
+            const double3 triangleNormal = meshB.calculateTriangleNormal(closest.m_uTriangle);
+            const double triangleNormalLength = length(triangleNormal);
+            if (triangleNormalLength <= 0.0)
+                continue;
+            normal = triangleNormal / triangleNormalLength;
+            if (b.m_pBVH->getSide(float3(double3(closest.m_vPoint) + normal), closest) < 0.0f)
+                normal = -normal;
+        }
+
+        // Both sides stop at the midpoint, or move at most the depenetration limit toward it
+        const double move = std::min(-0.5 * double(fDistance), double(fMaxMove));
+        ContactConstraintXPBD::Contact vertexContact;
+        vertexContact.m_vertices = uint3(v, v, v);
+        vertexContact.m_weights = float3(1, 0, 0);
+        vertexContact.m_point = double3(vPosInB) + normal * move - double3(vAToB);
+        vertexContact.m_normal = normal;
+        a.m_pContacts->addContact(vertexContact);
+
+        ContactConstraintXPBD::Contact triangleContact;
+        triangleContact.m_vertices = meshB.getTriangleVertices(closest.m_uTriangle);
+        triangleContact.m_weights = closest.m_vBarycentric;
+        triangleContact.m_point = double3(closest.m_vPoint) - normal * move;
+        triangleContact.m_normal = -normal;
+        b.m_pContacts->addContact(triangleContact);
+        ++m_stats.m_nBodyContacts;
+    }
+}
+
+void CollisionDetector::collideEggshell(uint32_t uBody)
+{
+    const Body& body = m_bodies[uBody];
+    const float fMargin = m_settings.m_fContactMargin;
+    const float fMaxMove = m_settings.m_fMaxDepenetration;
+    const double3 center(m_vEggshellCenter);
+    const double3 semiAxes(m_vEggshellSemiAxes);
+    // Ellipsoid shrunk by the margin, in units of the semi-axes: points inside it need no contact
+    const double3 innerSemiAxes = semiAxes - double3(fMargin, fMargin, fMargin);
+    auto isInside = [&](const double3& vPos)
+    {
+        const double3 u = (vPos - center) / innerSemiAxes;
+        return dot(u, u) < 1.0;
+    };
+
+    // The ellipsoid is convex: a box with all corners inside is inside
+    float3 corners[8];
+    body.m_box.getCorners(corners);
+    bool bAllInside = true;
+    for (const float3& corner : corners)
+        bAllInside = bAllInside && isInside(double3(corner));
+    if (bAllInside)
+        return;
+
+    const Vertices& vertices = *body.m_pBody->m_pMesh->getVertices();
+    const double3 offset(body.m_vOffset);
+    for (uint32_t v = 0; v < vertices.getVertexCount(); ++v)
+    {
+        const double3 vPos = double3(vertices.getVertexPosition(v)) + offset;
+        if (isInside(vPos))
+            continue;
+
+        // Tangent plane at the radial projection onto the shell (which shares the gradient
+        // direction of vPos), facing inward
+        const double3 u = (vPos - center) / semiAxes;
+        const double radius = length(u);
+        if (radius <= 0.0)
+            continue;
+        const double3 surfacePoint = center + (vPos - center) / radius;
+        const double3 gradient = (vPos - center) / (semiAxes * semiAxes);
+        const double3 normal = -gradient / length(gradient);
+        // A vertex beyond the shell moves back by at most the depenetration limit
+        const double depth = -dot(normal, vPos - surfacePoint);
+        ContactConstraintXPBD::Contact contact;
+        contact.m_vertices = uint3(v, v, v);
+        contact.m_weights = float3(1, 0, 0);
+        contact.m_point = surfacePoint - offset - normal * std::max(0.0, depth - double(fMaxMove));
+        contact.m_normal = normal;
+        body.m_pContacts->addContact(contact);
+        ++m_stats.m_nEggshellContacts;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "geometry/vectors/vector.h"
+#include "geometry/vectors/box.h"
+#include "geometry/BVH/BVH.h"
+#include "PhysicsMesh.h"
+#include "ContactConstraint.h"
+
+class BVHMesh;
+
+// Contact between closed surface bodies (the cortices of the cells of an organism) and with an
+// optional rigid eggshell around them. Every body keeps its own coordinates; a translation places
+// it in the frame the bodies share.
+// detect() replaces the contacts of every body's ContactConstraintXPBD:
+// - broadphase: sweep and prune over the body boxes along the axis the bodies are spread most on.
+//   The endpoint order is kept between calls and re-sorted by insertion, which is close to linear
+//   when bodies move little per step, and only bodies overlapping on the sweep axis are paired;
+// - narrowphase: for every overlapping pair both cortex BVHs are descended together to the
+//   triangles that come within the margin of each other, and the vertices of those triangles are
+//   tested against the other surface by signed distance;
+// - a vertex within the margin of (or inside) the other body gets a contact plane through the
+//   midpoint between it and its closest point there, with the other body's surface normal; the
+//   closest point's triangle gets the opposite contact, so each side resolves half of the overlap;
+// - vertices near or beyond the eggshell ellipsoid get its tangent plane and resolve it alone.
+// Contacts within the margin are speculative: they only act once the bodies actually meet during
+// the step, so bodies closing in within a step do not tunnel.
+class CollisionDetector
+{
+public:
+    struct Settings
+    {
+        float m_fContactMargin = 0.1f;      // um
+        // Deepest overlap a contact resolves in one step (um); deeper ones are resolved over several
+        // steps, so that the velocity correction of the constraint does not fling bodies apart
+        float m_fMaxDepenetration = 0.05f;
+    };
+
+    struct Stats
+    {
+        uint32_t m_nBroadphasePairs = 0;    // body pairs with overlapping boxes
+        uint32_t m_nSleepingPairs = 0;      // of those, pairs of sleeping bodies that were skipped
+        uint32_t m_nBodyContacts = 0;       // vertex contacts between bodies (each also acts on a triangle)
+        uint32_t m_nEggshellContacts = 0;
+    };
+
+    CollisionDetector() = default;
+
+    const Settings& getSettings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+
+    // Register a body with the constraint that receives its contacts; returns its index
+    uint32_t addBody(std::shared_ptr<PhysicsMesh> pBody, std::shared_ptr<ContactConstraintXPBD> pContacts,
+                     const float3& vOffset = float3(0, 0, 0));
+    void setBodyOffset(uint32_t uBody, const float3& vOffset) { m_bodies[uBody].m_vOffset = vOffset; }
+    // A sleeping body does not move, so detect() leaves out its contacts with the eggshell and with
+    // other sleeping bodies. It still gets the contacts of awake bodies that move into it.
+    void setBodySleeping(uint32_t uBody, bool bSleeping) { m_bodies[uBody].m_bSleeping = bSleeping; }
+    uint32_t getBodyCount() const { return static_cast<uint32_t>(m_bodies.size()); }
+    const std::shared_ptr<PhysicsMesh>& getBody(uint32_t uBody) const { return m_bodies[uBody].m_pBody; }
+    void clearBodies();
+
+    // Rigid ellipsoid all bodies stay inside, in the shared frame
+    void setEggshell(const float3& vCenter, const float3& vSemiAxes);
+    void removeEggshell() { m_bEggshell = false; }
+    bool hasEggshell() const { return m_bEggshell; }
+
+    // Contacts of all bodies at their current positions
+    void detect();
+    const Stats& getLastStats() const { return m_stats; }
+
+private:
+    struct Body
+    {
+        std::shared_ptr<PhysicsMesh> m_pBody;
+        std::shared_ptr<ContactConstraintXPBD> m_pContacts;
+        float3 m_vOffset;
+        bool m_bSleeping;
+        // Held between calls: BVHCache keeps a BVH only while someone uses it. detect() refreshes it
+        // for bodies in a broadphase pair only.
+        std::shared_ptr<BVHMesh> m_pBVH;
+        bool m_bBVHCurrent;
+        box3 m_box;                         // in the shared frame, grown by the margin
+        // Last m_uCandidateStamp each vertex was collected with
+        std::vector<uint32_t> m_candidateStamps;
+    };
+    std::vector<Body> m_bodies;
+    Settings m_settings;
+    Stats m_stats;
+
+    bool m_bEggshell = false;
+    float3 m_vEggshellCenter = float3(0, 0, 0);
+    float3 m_vEggshellSemiAxes = float3(1, 1, 1);
+
+    // Sweep and prune state: box ends of all bodies along m_sweepAxis, kept sorted
+    struct Endpoint
+    {
+        float m_fValue;
+        uint32_t m_uBody;
+        bool m_bMin;
+    };
+    std::vector<Endpoint> m_endpoints;
+    int m_sweepAxis = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> m_bodyPairs;
+    std::vector<uint32_t> m_activeBodies;
+    std::vector<BVH::SubObjectPair> m_trianglePairs;
+    std::vector<uint32_t> m_candidates;
+    uint32_t m_uCandidateStamp = 0;     // advanced for every side of every body pair
+
+    void findBodyPairs();
+    void collideBodies(uint32_t uA, uint32_t uB);
+    // Contacts of the candidate vertices of body uA (in m_candidates) against the surface of uB
+    void collideVertices(uint32_t uA, uint32_t uB);
+    void collideEggshell(uint32_t uBody);
+};
@@ -0,0 +1,79 @@
+#include "ContactConstraint.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include <algorithm>
+
+namespace
+{
+    inline double3 getContactPoint(const Vertices& vertices, const ContactConstraintXPBD::Contact& contact)
+    {
+        return double3(vertices.getVertexPosition(contact.m_vertices.x)) * double(contact.m_weights.x)
+             + double3(vertices.getVertexPosition(contact.m_vertices.y)) * double(contact.m_weights.y)
+             + double3(vertices.getVertexPosition(contact.m_vertices.z)) * double(contact.m_weights.z);
+    }
+}
+
+double ContactConstraintXPBD::computeMaxPenetration() const
+{
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    double maxPenetration = 0.0;
+    for (const Contact& contact : m_contacts)
+    {
+        const double C = dot(contact.m_normal, getContactPoint(vertices, contact) - contact.m_point);
+        maxPenetration = std::max(maxPenetration, -C);
+    }
+    return maxPenetration;
+}
+
+void ContactConstraintXPBD::beginStep()
+{
+    m_lambdas.assign(m_contacts.size(), 0.0);
+}
+
+void ContactConstraintXPBD::project(double dt)
+{
+    if (dt <= 0.0 || m_contacts.empty()) return;
+    if (m_lambdas.size() != m_contacts.size())
+        beginStep();
+
+    const double alphaTilde = m_compliance / (dt * dt);
+    Vertices& vertices = *m_body.m_pMesh->getVertices();
+    Vertices::PositionUpdate update(vertices);
+    for (size_t c = 0; c < m_contacts.size(); ++c)
+    {
+        const Contact& contact = m_contacts[c];
+        const uint32_t indices[3] = { contact.m_vertices.x, contact.m_vertices.y, contact.m_vertices.z };
+        const double weights[3] = { contact.m_weights.x, contact.m_weights.y, contact.m_weights.z };
+
+        // C = n . (sum w_i x_i - p), grad_i C = w_i n
+        double3 positions[3];
+        double3 point(0, 0, 0);
+        double denominator = alphaTilde;
+        for (int k = 0; k < 3; ++k)
+        {
+            positions[k] = double3(vertices.getVertexPosition(indices[k]));
+            point += positions[k] * weights[k];
+            denominator += weights[k] * weights[k] / std::max(1e-12, m_body.getMass(indices[k]));
+        }
+        if (denominator <= 1e-20) continue;
+        const double C = dot(contact.m_normal, point - contact.m_point);
+
+        // Inequality: only a multiplier >= 0 (pushing along the normal) is kept
+        const double lambda = std::max(0.0, m_lambdas[c] + (-C - alphaTilde * m_lambdas[c]) / denominator);
+        const double deltaLambda = lambda - m_lambdas[c];
+        m_lambdas[c] = lambda;
+        if (deltaLambda == 0.0) continue;
+        for (int k = 0; k < 3; ++k)
+        {
+            if (weights[k] == 0.0) continue;
+            const double wk = 1.0 / std::max(1e-12, m_body.getMass(indices[k]));
+            update.set(indices[k], float3(positions[k] + contact.m_normal * (wk * weights[k] * deltaLambda)));
+        }
+    }
+}
+
+void ContactConstraintXPBD::onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes)
+{
+    if (&body != &m_body || changes.isEmpty()) return;
+    m_contacts.clear();
+    m_lambdas.clear();
+}
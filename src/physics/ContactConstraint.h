@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include "PhysicsMesh.h"
+#include "PhysicsConstraints.h"
+
+// XPBD contact constraints of one body against planes that stay fixed for a step: a point of the
+// body (a vertex, or a point of a triangle given by barycentric weights) must stay on the side of
+// its plane the normal points to, n . (sum w_i x_i - p) >= 0. Contacts only push: a multiplier
+// that would pull is clamped to 0. CollisionDetector fills the contacts before every step, in the
+// coordinates of the body's mesh.
+class ContactConstraintXPBD : public IConstraint
+{
+public:
+    struct Contact
+    {
+        uint3 m_vertices;
+        float3 m_weights;       // a vertex contact has weights (1, 0, 0)
+        double3 m_point;        // on the plane
+        double3 m_normal;       // unit, pointing to the allowed side
+    };
+
+    explicit ContactConstraintXPBD(PhysicsMesh& body, double compliance = 0.0)
+        : m_body(body)
+        , m_compliance(compliance)
+    {
+    }
+
+    void setCompliance(double c) { m_compliance = c; }
+    double getCompliance() const { return m_compliance; }
+
+    void clearContacts() { m_contacts.clear(); }
+    void addContact(const Contact& contact) { m_contacts.push_back(contact); }
+    const std::vector<Contact>& getContacts() const { return m_contacts; }
+
+    // Deepest violation of the contacts at the current positions (0 if all are satisfied)
+    double computeMaxPenetration() const;
+
+    void beginStep() override;
+    void project(double dt) override;
+    // Contacts name vertices of the old mesh; they are dropped until the next detection
+    void onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes) override;
+
+private:
+    PhysicsMesh& m_body;
+    double m_compliance;
+    std::vector<Contact> m_contacts;
+    std::vector<double> m_lambdas;
+};
@@ -75,21 +75,9 @@ void DyneinPullingForce::apply()
                 
                 // Distribute force to triangle vertices using barycentric weights
                 const float3& baryCoords = attachmentLoc.getBarycentric();
-                auto& v0 = m_cortexBody.getVertex(triangle.x);
-                auto& v1 = m_cortexBody.getVertex(triangle.y);
-                auto& v2 = m_cortexBody.getVertex(triangle.z);
-                
-                v0.m_vForce.x += force.x * baryCoords.x;
-                v0.m_vForce.y += force.y * baryCoords.x;
-                v0.m_vForce.z += force.z * baryCoords.x;
-                
-                v1.m_vForce.x += force.x * baryCoords.y;
-                v1.m_vForce.y += force.y * baryCoords.y;
-                v1.m_vForce.z += force.z * baryCoords.y;
-                
-                v2.m_vForce.x += force.x * baryCoords.z;
-                v2.m_vForce.y += force.y * baryCoords.z;
-                v2.m_vForce.z += force.z * baryCoords.z;
+                m_cortexBody.addForce(triangle.x, double3(force * baryCoords.x));
+                m_cortexBody.addForce(triangle.y, double3(force * baryCoords.y));
+                m_cortexBody.addForce(triangle.z, double3(force * baryCoords.z));
 
                 // Newton's third law: apply equal and opposite reaction force to centrosome
                 // Force on centrosome: pulls toward cortex (opposite direction)
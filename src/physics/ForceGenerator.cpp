@@ -1,6 +1,7 @@
 #include "ForceGenerator.h"
 #include "geometry/mesh/TriangleMesh.h"
 #include "geometry/mesh/Edges.h"
+#include "physics/FusedEdgeForces.h"
 
 EdgeSpringForce::EdgeSpringForce(PhysicsMesh& body, double springConstant)
     : m_body(body)
@@ -23,46 +24,88 @@ EdgeSpringForce::EdgeSpringForce(PhysicsMesh& body, double springConstant)
 void EdgeSpringForce::apply()
 {
     auto pEdges = m_body.m_pMesh->getOrCreateEdges();
-    const uint32_t edgeCount = pEdges->getEdgeCount();
-    if (edgeCount == 0) return;
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    m_body.forEachEdgeBatch([&](std::span<const uint32_t> edgeIndices)
+    {
+        for (uint32_t e : edgeIndices)
+        {
+            auto ab = pEdges->getEdge(e);
+            double3 pa = double3(vertices.getVertexPosition(ab.first));
+            double3 pb = double3(vertices.getVertexPosition(ab.second));
+            double3 edgeVec = pb - pa;
+            double L = length(edgeVec);
+            if (L <= 1e-10) continue;
+            double3 n = edgeVec / L;
+            double L0 = m_edgeRestLengths[e];
+            double3 f = -m_springConstant * (L - L0) * n;
+            m_body.addForce(ab.first, -f);
+            m_body.addForce(ab.second, f);
+        }
+    });
+}
+
+bool EdgeSpringForce::fuseInto(FusedEdgeForces& fused)
+{
+    if (&fused.getBody() != &m_body) return false;
+    fused.addSpring(*this);
+    return true;
+}
+
+void EdgeSpringForce::onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes)
+{
+    if (&body != &m_body || changes.isEmpty()) return;
 
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    auto pEdges = m_body.m_pMesh->getOrCreateEdges();
+    const uint32_t edgeCount = pEdges->getEdgeCount();
+    std::vector<double> restLengths(edgeCount);
     for (uint32_t e = 0; e < edgeCount; ++e)
     {
         auto ab = pEdges->getEdge(e);
-        double3 pa = double3(m_body.m_pMesh->getVertices()->getVertexPosition(ab.first));
-        double3 pb = double3(m_body.m_pMesh->getVertices()->getVertexPosition(ab.second));
-        double3 edgeVec = pb - pa;
-        double L = length(edgeVec);
-        if (L <= 1e-10) continue;
-        double3 n = edgeVec / L;
-        double L0 = m_edgeRestLengths[e];
-        double3 f = -m_springConstant * (L - L0) * n;
-        m_body.getVertex(ab.first).m_vForce += (-f);
-        m_body.getVertex(ab.second).m_vForce += f;
+        const double L = length(vertices.getVertexPosition(ab.second) - vertices.getVertexPosition(ab.first));
+        restLengths[e] = L;
+
+        const uint32_t oldEdge = changes.findOldEdge(ab.first, ab.second);
+        if (oldEdge == Edges::INVALID_INDEX) continue;
+        // The endpoints of an old edge that still exists (whole or split) have not moved
+        auto oldAB = changes.m_pOldEdges->getEdge(oldEdge);
+        const double oldL = length(vertices.getVertexPosition(changes.m_newVertexIndex[oldAB.second])
+                                 - vertices.getVertexPosition(changes.m_newVertexIndex[oldAB.first]));
+        if (oldL > 1e-10)
+            restLengths[e] = m_edgeRestLengths[oldEdge] * L / oldL;
     }
+    m_edgeRestLengths = std::move(restLengths);
 }
 
 void EdgeDampingForce::apply()
 {
     auto pEdges = m_body.m_pMesh->getOrCreateEdges();
-    const uint32_t edgeCount = pEdges->getEdgeCount();
-    if (edgeCount == 0) return;
-
-    for (uint32_t e = 0; e < edgeCount; ++e)
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    m_body.forEachEdgeBatch([&](std::span<const uint32_t> edgeIndices)
     {
-        auto ab = pEdges->getEdge(e);
-        double3 pa = double3(m_body.m_pMesh->getVertices()->getVertexPosition(ab.first));
-        double3 pb = double3(m_body.m_pMesh->getVertices()->getVertexPosition(ab.second));
-        double3 edgeVec = pb - pa;
-        double L = length(edgeVec);
-        if (L <= 1e-10) continue;
-        double3 n = edgeVec / L;
-        double3 relV = m_body.getVertex(ab.second).m_vVelocity - m_body.getVertex(ab.first).m_vVelocity;
-        double relAlong = dot(relV, n);
-        double3 f = -m_dampingCoeff * relAlong * n;
-        m_body.getVertex(ab.first).m_vForce += (-f);
-        m_body.getVertex(ab.second).m_vForce += f;
-    }
+        for (uint32_t e : edgeIndices)
+        {
+            auto ab = pEdges->getEdge(e);
+            double3 pa = double3(vertices.getVertexPosition(ab.first));
+            double3 pb = double3(vertices.getVertexPosition(ab.second));
+            double3 edgeVec = pb - pa;
+            double L = length(edgeVec);
+            if (L <= 1e-10) continue;
+            double3 n = edgeVec / L;
+            double3 relV = m_body.getVelocity(ab.second) - m_body.getVelocity(ab.first);
+            double relAlong = dot(relV, n);
+            double3 f = -m_dampingCoeff * relAlong * n;
+            m_body.addForce(ab.first, -f);
+            m_body.addForce(ab.second, f);
+        }
+    });
+}
+
+bool EdgeDampingForce::fuseInto(FusedEdgeForces& fused)
+{
+    if (&fused.getBody() != &m_body) return false;
+    fused.addDamping(*this);
+    return true;
 }
 
 
@@ -5,6 +5,8 @@
 #include "geometry/vectors/vector.h"
 #include "physics/PhysicsMesh.h"
 
+class FusedEdgeForces;
+
 /**
  * Interface for force generators acting on a mesh-based soft body.
  * Each force is bound to specific bodies at construction time.
@@ -14,8 +16,24 @@ class IForceGenerator
 public:
     virtual ~IForceGenerator() = default;
 
+    // Start of a (sub)step of dt, before apply(); generators with dynamic state of their own
+    // advance it here
+    virtual void beginStep(double dt) {}
     // Apply forces to the associated body
     virtual void apply() = 0;
+
+    // The mesh of body was remeshed; generators keeping per-vertex or per-edge data of that body
+    // remap it here
+    virtual void onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes) {}
+
+    // Error control takes a step from the same start more than once; generators whose beginStep()
+    // advances state of their own save it here and put it back on restore
+    virtual void saveState() {}
+    virtual void restoreState() {}
+
+    // Built-in per-edge forces register with the fused edge kernel of their body and return true;
+    // PhysicsIntegrator then evaluates them there instead of calling apply()
+    virtual bool fuseInto(FusedEdgeForces& fused) { return false; }
 };
 
 /** Edge-aligned Hookean springs for each mesh edge */
@@ -25,6 +43,13 @@ public:
     EdgeSpringForce(PhysicsMesh& body, double springConstant);
 
     void apply() override;
+    // Edges that survive or are halves of a split edge keep the strain of their old edge;
+    // edges created by collapses and flips start at rest
+    void onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes) override;
+    bool fuseInto(FusedEdgeForces& fused) override;
+
+    double getSpringConstant() const { return m_springConstant; }
+    const std::vector<double>& getRestLengths() const { return m_edgeRestLengths; }
 
 private:
     PhysicsMesh& m_body;
@@ -42,6 +67,9 @@ public:
     }
 
     void apply() override;
+    bool fuseInto(FusedEdgeForces& fused) override;
+
+    double getDampingCoefficient() const { return m_dampingCoeff; }
 
 private:
     PhysicsMesh& m_body;
@@ -0,0 +1,104 @@
+#include "FusedEdgeForces.h"
+#include "ForceGenerator.h"
+#include "geometry/mesh/Edges.h"
+#include "geometry/vectors/simd4.h"
+
+void FusedEdgeForces::apply()
+{
+    if (isEmpty()) return;
+
+    // Damping is linear in the coefficient, so all damping generators collapse into one
+    double dampingCoeff = 0.0;
+    for (const EdgeDampingForce* pDamping : m_dampings)
+        dampingCoeff += pDamping->getDampingCoefficient();
+
+    auto pEdges = m_body.m_pMesh->getOrCreateEdges();
+    m_body.forEachEdgeBatch([&](std::span<const uint32_t> edgeIndices)
+    {
+        applyBatch<PhysicsPrecision>(*pEdges, edgeIndices, dampingCoeff);
+    });
+}
+
+template <class Precision>
+void FusedEdgeForces::applyBatch(const Edges& edges, std::span<const uint32_t> edgeIndices, double dampingCoeff)
+{
+    using Real = typename Precision::Compute;
+    using Real3 = vector<Real, 3>;
+    using Real4 = typename Precision::Compute4;
+
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    const VectorArray3& velocities = m_body.getVelocities();
+    VectorArray3& forces = m_body.accessForces();
+
+    // Per lane: edge vector, relative velocity of the endpoints, rest lengths of every spring
+    alignas(16) Real dx[4], dy[4], dz[4];
+    alignas(16) Real dvx[4], dvy[4], dvz[4];
+    alignas(16) Real restLengths[4];
+    alignas(16) Real lengths[4], fx[4], fy[4], fz[4];
+    uint32_t endpointsA[4], endpointsB[4];
+
+    const Real4 damping = Real4::broadcast(Real(dampingCoeff));
+    const size_t n = edgeIndices.size();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        // Gather
+        for (uint32_t lane = 0; lane < 4; ++lane)
+        {
+            const auto ab = edges.getEdge(edgeIndices[i + lane]);
+            const Real3 pa = Real3(vertices.getVertexPosition(ab.first));
+            const Real3 pb = Real3(vertices.getVertexPosition(ab.second));
+            endpointsA[lane] = ab.first;
+            endpointsB[lane] = ab.second;
+            dx[lane] = pb.x - pa.x;
+            dy[lane] = pb.y - pa.y;
+            dz[lane] = pb.z - pa.z;
+            dvx[lane] = Real(velocities.m_x[ab.second]) - Real(velocities.m_x[ab.first]);
+            dvy[lane] = Real(velocities.m_y[ab.second]) - Real(velocities.m_y[ab.first]);
+            dvz[lane] = Real(velocities.m_z[ab.second]) - Real(velocities.m_z[ab.first]);
+        }
+
+        const Real4 x = Real4::load(dx), y = Real4::load(dy), z = Real4::load(dz);
+        const Real4 L = sqrt(x * x + y * y + z * z);
+        const Real4 invL = Real4::broadcast(Real(1)) / L;
+        const Real4 nx = x * invL, ny = y * invL, nz = z * invL;
+
+        // Signed magnitude of the force on the second endpoint along -n
+        Real4 magnitude = damping * (Real4::load(dvx) * nx + Real4::load(dvy) * ny + Real4::load(dvz) * nz);
+        for (const EdgeSpringForce* pSpring : m_springs)
+        {
+            const std::vector<double>& rest = pSpring->getRestLengths();
+            for (uint32_t lane = 0; lane < 4; ++lane)
+                restLengths[lane] = Real(rest[edgeIndices[i + lane]]);
+            magnitude = magnitude + Real4::broadcast(Real(pSpring->getSpringConstant())) * (L - Real4::load(restLengths));
+        }
+        L.store(lengths);
+        (Real4::zero() - magnitude * nx).store(fx);
+        (Real4::zero() - magnitude * ny).store(fy);
+        (Real4::zero() - magnitude * nz).store(fz);
+
+        // Scatter lane by lane: the edges of a batch may share vertices
+        for (uint32_t lane = 0; lane < 4; ++lane)
+        {
+            if (lengths[lane] <= Real(1e-10)) continue;
+            const Real3 f(fx[lane], fy[lane], fz[lane]);
+            forces.add(endpointsA[lane], -f);
+            forces.add(endpointsB[lane], f);
+        }
+    }
+    for (; i < n; ++i)
+    {
+        const uint32_t e = edgeIndices[i];
+        const auto ab = edges.getEdge(e);
+        const Real3 edgeVec = Real3(vertices.getVertexPosition(ab.second)) - Real3(vertices.getVertexPosition(ab.first));
+        const Real L = length(edgeVec);
+        if (L <= Real(1e-10)) continue;
+        const Real3 nDir = edgeVec * (Real(1) / L);
+        Real magnitude = Real(dampingCoeff) * dot(velocities.get<Real>(ab.second) - velocities.get<Real>(ab.first), nDir);
+        for (const EdgeSpringForce* pSpring : m_springs)
+            magnitude += Real(pSpring->getSpringConstant()) * (L - Real(pSpring->getRestLengths()[e]));
+        const Real3 f = -magnitude * nDir;
+        forces.add(ab.first, -f);
+        forces.add(ab.second, f);
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include "physics/PhysicsMesh.h"
+
+class Edges;
+class EdgeSpringForce;
+class EdgeDampingForce;
+
+// The built-in per-edge forces of one body (Hookean springs and damping of the relative velocity
+// along the edge) evaluated in a single sweep: every edge reads its endpoint positions and
+// velocities once and adds the combined force to both endpoints. Edges are processed four at a time
+// in the lanes of PhysicsPrecision::Compute4. PhysicsIntegrator evaluates generators that fuse into such a kernel
+// (IForceGenerator::fuseInto) here and applies the others one by one.
+class FusedEdgeForces
+{
+public:
+    explicit FusedEdgeForces(PhysicsMesh& body) : m_body(body) {}
+
+    PhysicsMesh& getBody() const { return m_body; }
+
+    void addSpring(const EdgeSpringForce& spring) { m_springs.push_back(&spring); }
+    void addDamping(const EdgeDampingForce& damping) { m_dampings.push_back(&damping); }
+    bool isEmpty() const { return m_springs.empty() && m_dampings.empty(); }
+    const std::vector<const EdgeSpringForce*>& getSprings() const { return m_springs; }
+    const std::vector<const EdgeDampingForce*>& getDampings() const { return m_dampings; }
+
+    // Add the forces of all registered generators to the body
+    void apply();
+
+private:
+    PhysicsMesh& m_body;
+    std::vector<const EdgeSpringForce*> m_springs;
+    std::vector<const EdgeDampingForce*> m_dampings;
+
+    template <class Precision>
+    void applyBatch(const Edges& edges, std::span<const uint32_t> edgeIndices, double dampingCoeff);
+};
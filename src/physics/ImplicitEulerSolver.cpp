@@ -0,0 +1,178 @@
+#include "ImplicitEulerSolver.h"
+#include "ForceGenerator.h"
+#include "FusedEdgeForces.h"
+#include "geometry/mesh/Edges.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    double dotProduct(const VectorArray3T<double>& a, const VectorArray3T<double>& b)
+    {
+        double sum = 0.0;
+        for (uint32_t i = 0; i < a.size(); ++i)
+            sum += a.m_x[i] * b.m_x[i] + a.m_y[i] * b.m_y[i] + a.m_z[i] * b.m_z[i];
+        return sum;
+    }
+
+    // z = r / diagonal
+    void precondition(const VectorArray3T<double>& r, const VectorArray3T<double>& diagonal, VectorArray3T<double>& z)
+    {
+        for (uint32_t i = 0; i < r.size(); ++i)
+        {
+            z.m_x[i] = r.m_x[i] / diagonal.m_x[i];
+            z.m_y[i] = r.m_y[i] / diagonal.m_y[i];
+            z.m_z[i] = r.m_z[i] / diagonal.m_z[i];
+        }
+    }
+}
+
+void ImplicitEulerSolver::computeEdgeCoefficients(PhysicsMesh& body, const Edges& edges, const FusedEdgeForces& edgeForces, double dt)
+{
+    const uint32_t edgeCount = edges.getEdgeCount();
+    m_nx.resize(edgeCount);
+    m_ny.resize(edgeCount);
+    m_nz.resize(edgeCount);
+    m_axial.resize(edgeCount);
+    m_lateral.resize(edgeCount);
+    m_damping.resize(edgeCount);
+
+    double dampingCoeff = 0.0;
+    for (const EdgeDampingForce* pDamping : edgeForces.getDampings())
+        dampingCoeff += pDamping->getDampingCoefficient();
+
+    const uint32_t n = body.getVertexCount();
+    m_diagonal.assign(n, double3(0, 0, 0));
+    for (uint32_t i = 0; i < n; ++i)
+        m_diagonal.set(i, double3(1, 1, 1) * std::max(1e-12, body.getMass(i)));
+
+    const Vertices& vertices = *body.m_pMesh->getVertices();
+    body.forEachEdgeBatch([&](std::span<const uint32_t> edgeIndices)
+    {
+        for (uint32_t e : edgeIndices)
+        {
+            auto ab = edges.getEdge(e);
+            double3 edgeVec = double3(vertices.getVertexPosition(ab.second)) - double3(vertices.getVertexPosition(ab.first));
+            double L = length(edgeVec);
+            if (L <= 1e-10)
+            {
+                // The explicit forces skip degenerate edges, so does their Jacobian
+                m_nx[e] = m_ny[e] = m_nz[e] = 0.0;
+                m_axial[e] = m_lateral[e] = m_damping[e] = 0.0;
+                continue;
+            }
+            double3 nDir = edgeVec / L;
+            double stiffness = 0.0, lateralStiffness = 0.0;
+            for (const EdgeSpringForce* pSpring : edgeForces.getSprings())
+            {
+                const double k = pSpring->getSpringConstant();
+                stiffness += k;
+                lateralStiffness += k * std::max(0.0, 1.0 - pSpring->getRestLengths()[e] / L);
+            }
+            m_nx[e] = nDir.x;
+            m_ny[e] = nDir.y;
+            m_nz[e] = nDir.z;
+            m_damping[e] = dt * dampingCoeff;
+            m_axial[e] = dt * dampingCoeff + dt * dt * stiffness;
+            m_lateral[e] = dt * dt * lateralStiffness;
+
+            // Diagonal of axial * n n^T + lateral * (I - n n^T), on both ends
+            double3 diag = m_axial[e] * (nDir * nDir) + m_lateral[e] * (double3(1, 1, 1) - nDir * nDir);
+            m_diagonal.add(ab.first, diag);
+            m_diagonal.add(ab.second, diag);
+        }
+    });
+}
+
+void ImplicitEulerSolver::multiply(PhysicsMesh& body, const Edges& edges, const VectorArray3T<double>& x, VectorArray3T<double>& y)
+{
+    for (uint32_t i = 0; i < x.size(); ++i)
+    {
+        const double m = std::max(1e-12, body.getMass(i));
+        y.m_x[i] = m * x.m_x[i];
+        y.m_y[i] = m * x.m_y[i];
+        y.m_z[i] = m * x.m_z[i];
+    }
+    body.forEachEdgeBatch([&](std::span<const uint32_t> edgeIndices)
+    {
+        for (uint32_t e : edgeIndices)
+        {
+            auto ab = edges.getEdge(e);
+            double3 d = x.get(ab.second) - x.get(ab.first);
+            double3 nDir(m_nx[e], m_ny[e], m_nz[e]);
+            double3 w = m_lateral[e] * d + (m_axial[e] - m_lateral[e]) * dot(nDir, d) * nDir;
+            y.add(ab.first, -w);
+            y.add(ab.second, w);
+        }
+    });
+}
+
+void ImplicitEulerSolver::solve(const FusedEdgeForces& edgeForces, double dt)
+{
+    PhysicsMesh& body = edgeForces.getBody();
+    auto pEdges = body.m_pMesh->getOrCreateEdges();
+    const Edges& edges = *pEdges;
+    const uint32_t n = body.getVertexCount();
+    computeEdgeCoefficients(body, edges, edgeForces, dt);
+
+    // Right-hand side M v0 + dt * f0 + dt * D v0
+    VectorArray3T<double>& v = m_v;
+    const VectorArray3& forces = body.getForces();
+    v.assign(n, double3(0, 0, 0));
+    for (uint32_t i = 0; i < n; ++i)
+        v.set(i, body.getVelocity(i));
+    m_rhs.assign(n, double3(0, 0, 0));
+    for (uint32_t i = 0; i < n; ++i)
+        m_rhs.set(i, std::max(1e-12, body.getMass(i)) * v.get(i) + dt * forces.get(i));
+    body.forEachEdgeBatch([&](std::span<const uint32_t> edgeIndices)
+    {
+        for (uint32_t e : edgeIndices)
+        {
+            auto ab = edges.getEdge(e);
+            double3 nDir(m_nx[e], m_ny[e], m_nz[e]);
+            double3 w = m_damping[e] * dot(nDir, v.get(ab.second) - v.get(ab.first)) * nDir;
+            m_rhs.add(ab.first, -w);
+            m_rhs.add(ab.second, w);
+        }
+    });
+
+    // Preconditioned conjugate gradients, warm-started from v0
+    m_r.assign(n, double3(0, 0, 0));
+    m_z.assign(n, double3(0, 0, 0));
+    m_p.assign(n, double3(0, 0, 0));
+    m_Ap.assign(n, double3(0, 0, 0));
+    multiply(body, edges, v, m_Ap);
+    for (uint32_t i = 0; i < n; ++i)
+        m_r.set(i, m_rhs.get(i) - m_Ap.get(i));
+    precondition(m_r, m_diagonal, m_z);
+    m_p = m_z;
+
+    const double rhsNorm = std::sqrt(dotProduct(m_rhs, m_rhs));
+    const double threshold = m_settings.m_fRelativeTolerance * std::max(rhsNorm, 1e-30);
+    double rz = dotProduct(m_r, m_z);
+    double residual = std::sqrt(dotProduct(m_r, m_r));
+    uint32_t iteration = 0;
+    for (; iteration < m_settings.m_nMaxIterations && residual > threshold; ++iteration)
+    {
+        multiply(body, edges, m_p, m_Ap);
+        const double pAp = dotProduct(m_p, m_Ap);
+        if (pAp <= 0.0) break;
+        const double alpha = rz / pAp;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            v.add(i, alpha * m_p.get(i));
+            m_r.add(i, -alpha * m_Ap.get(i));
+        }
+        precondition(m_r, m_diagonal, m_z);
+        const double rzNew = dotProduct(m_r, m_z);
+        const double beta = rzNew / rz;
+        rz = rzNew;
+        for (uint32_t i = 0; i < n; ++i)
+            m_p.set(i, m_z.get(i) + beta * m_p.get(i));
+        residual = std::sqrt(dotProduct(m_r, m_r));
+    }
+    for (uint32_t i = 0; i < n; ++i)
+        body.setVelocity(i, v.get(i));
+    m_nLastIterations = iteration;
+    m_fLastRelativeResidual = residual / std::max(rhsNorm, 1e-30);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "physics/PhysicsMesh.h"
+
+class Edges;
+class FusedEdgeForces;
+
+// Backward Euler velocity update for the edge springs and dampers of one body:
+//   (M + dt * D + dt^2 * K) v1 = M v0 + dt * (f0 + D v0)
+// where f0 are the forces accumulated on the body, K the stiffness of the springs and D the
+// damping matrix, both linearized at the current state. The system is solved matrix-free by
+// conjugate gradients with a diagonal (Jacobi) preconditioner, starting from v0. Compressed springs
+// contribute only their axial stiffness, which keeps the system positive definite.
+// Forces of other generators (e.g. dynein) stay explicit: they only enter through f0.
+class ImplicitEulerSolver
+{
+public:
+    struct Settings
+    {
+        uint32_t m_nMaxIterations = 100;
+        // Stop when |r| <= m_fRelativeTolerance * |right-hand side|
+        double m_fRelativeTolerance = 1e-6;
+    };
+
+    ImplicitEulerSolver() = default;
+    explicit ImplicitEulerSolver(const Settings& settings) : m_settings(settings) {}
+
+    const Settings& getSettings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+
+    // Replace the velocities of edgeForces.getBody() by the backward Euler velocities after dt;
+    // the forces of the body must already include those of edgeForces
+    void solve(const FusedEdgeForces& edgeForces, double dt);
+
+    uint32_t getLastIterationCount() const { return m_nLastIterations; }
+    double getLastRelativeResidual() const { return m_fLastRelativeResidual; }
+
+private:
+    Settings m_settings;
+    uint32_t m_nLastIterations = 0;
+    double m_fLastRelativeResidual = 0.0;
+
+    // Per edge: direction, dt * c + dt^2 * k along it, dt^2 * k * (1 - L0 / L) across it, dt * c
+    std::vector<double> m_nx, m_ny, m_nz;
+    std::vector<double> m_axial, m_lateral, m_damping;
+    // Per vertex, in double whatever the precision of the body state: preconditioner diagonal,
+    // velocities being solved for and CG vectors
+    VectorArray3T<double> m_diagonal, m_v, m_rhs, m_r, m_z, m_p, m_Ap;
+
+    void computeEdgeCoefficients(PhysicsMesh& body, const Edges& edges, const FusedEdgeForces& edgeForces, double dt);
+    // y = (M + dt * D + dt^2 * K) x
+    void multiply(PhysicsMesh& body, const Edges& edges, const VectorArray3T<double>& x, VectorArray3T<double>& y);
+};
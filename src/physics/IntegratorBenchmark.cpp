@@ -0,0 +1,100 @@
+#include "IntegratorBenchmark.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include "geometry/mesh/Edges.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    // Kinetic energy plus the potential energy of the springs
+    double computeEnergy(const PhysicsMesh& body, const EdgeSpringForce& spring)
+    {
+        double energy = 0.0;
+        for (uint32_t i = 0; i < body.getVertexCount(); ++i)
+        {
+            const double3 v = body.getVelocity(i);
+            energy += 0.5 * body.getMass(i) * dot(v, v);
+        }
+        auto pEdges = body.m_pMesh->getOrCreateEdges();
+        const Vertices& vertices = *body.m_pMesh->getVertices();
+        const std::vector<double>& restLengths = spring.getRestLengths();
+        for (uint32_t e = 0; e < pEdges->getEdgeCount(); ++e)
+        {
+            auto ab = pEdges->getEdge(e);
+            const double L = length(double3(vertices.getVertexPosition(ab.second)) - double3(vertices.getVertexPosition(ab.first)));
+            energy += 0.5 * spring.getSpringConstant() * (L - restLengths[e]) * (L - restLengths[e]);
+        }
+        return energy;
+    }
+}
+
+IntegratorBenchmark::Result IntegratorBenchmark::runScheme(PhysicsIntegrator::Scheme scheme, uint32_t sphereSubdivisionLevel,
+                                                           double springConstant, double dampingCoeff, double dt, double fSimulatedTime)
+{
+    using Clock = std::chrono::steady_clock;
+    const double RADIUS = 10.0;
+
+    auto pMesh = TriangleMesh::createSphere(RADIUS, sphereSubdivisionLevel);
+    auto pBody = std::make_shared<PhysicsMesh>(pMesh);
+    PhysicsIntegrator integrator;
+    integrator.setScheme(scheme);
+    integrator.addBody(pBody);
+    // Rest lengths are taken from the unperturbed sphere
+    auto pSpring = std::make_unique<EdgeSpringForce>(*pBody, springConstant);
+    const EdgeSpringForce& spring = *pSpring;
+    integrator.addForceGenerator(std::move(pSpring));
+    integrator.addForceGenerator(std::make_unique<EdgeDampingForce>(*pBody, dampingCoeff));
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+    {
+        Vertices& vertices = *pMesh->getVertices();
+        Vertices::PositionUpdate update(vertices);
+        for (uint32_t i = 0; i < vertices.getVertexCount(); ++i)
+            update.set(i, vertices.getVertexPosition(i) * (1.0f + 0.02f * uni(rng)));
+    }
+
+    Result result;
+    result.m_scheme = scheme;
+    result.m_fDt = dt;
+    result.m_nSteps = static_cast<uint32_t>(std::ceil(fSimulatedTime / dt));
+    const double initialEnergy = computeEnergy(*pBody, spring);
+
+    uint64_t nIterations = 0;
+    double energy = initialEnergy;
+    double stepMs = 0.0;
+    for (uint32_t step = 0; step < result.m_nSteps; ++step)
+    {
+        const Clock::time_point stepStart = Clock::now();
+        integrator.step(dt);
+        stepMs += std::chrono::duration<double, std::milli>(Clock::now() - stepStart).count();
+        nIterations += integrator.getLastSolverIterations();
+        energy = computeEnergy(*pBody, spring);
+        result.m_fMaxEnergyRatio = std::max(result.m_fMaxEnergyRatio, energy / initialEnergy);
+        if (!std::isfinite(energy) || energy > 2.0 * initialEnergy)
+        {
+            result.m_bStable = false;
+            result.m_nSteps = step + 1;
+            break;
+        }
+    }
+    result.m_fMsPerStep = stepMs / result.m_nSteps;
+    result.m_fAverageSolverIterations = double(nIterations) / result.m_nSteps;
+    result.m_fFinalEnergyRatio = energy / initialEnergy;
+    return result;
+}
+
+std::vector<IntegratorBenchmark::Result> IntegratorBenchmark::run(uint32_t sphereSubdivisionLevel, double springConstant, double dampingCoeff,
+                                                                  const std::vector<double>& timeSteps, double fSimulatedTime)
+{
+    std::vector<Result> results;
+    for (double dt : timeSteps)
+    {
+        results.push_back(runScheme(PhysicsIntegrator::Scheme::SEMI_IMPLICIT_EULER, sphereSubdivisionLevel,
+                                    springConstant, dampingCoeff, dt, fSimulatedTime));
+        results.push_back(runScheme(PhysicsIntegrator::Scheme::IMPLICIT_EULER, sphereSubdivisionLevel,
+                                    springConstant, dampingCoeff, dt, fSimulatedTime));
+    }
+    return results;
+}
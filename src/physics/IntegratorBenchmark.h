@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "physics/PhysicsIntegrator.h"
+
+// Stability, energy behaviour and cost of the integration schemes on a sphere of edge springs and
+// dampers released from a random radial perturbation. Used to pick time steps and to compare
+// integrator changes; it is not run as part of the simulation but by tests/integratorBenchmark.
+class IntegratorBenchmark
+{
+public:
+    struct Result
+    {
+        PhysicsIntegrator::Scheme m_scheme = PhysicsIntegrator::Scheme::SEMI_IMPLICIT_EULER;
+        double m_fDt = 0.0;
+        uint32_t m_nSteps = 0;
+        double m_fMsPerStep = 0.0;
+        double m_fAverageSolverIterations = 0.0;   // IMPLICIT_EULER only
+        // Kinetic plus spring energy at the end relative to the start; damping makes it decay
+        double m_fFinalEnergyRatio = 0.0;
+        double m_fMaxEnergyRatio = 0.0;
+        // False if the energy became NaN or more than twice its initial value (the run then stops)
+        bool m_bStable = true;
+    };
+
+    // Both schemes at every time step, each simulating fSimulatedTime from the same initial state
+    static std::vector<Result> run(uint32_t sphereSubdivisionLevel, double springConstant, double dampingCoeff,
+                                   const std::vector<double>& timeSteps, double fSimulatedTime);
+
+    static Result runScheme(PhysicsIntegrator::Scheme scheme, uint32_t sphereSubdivisionLevel, double springConstant,
+                            double dampingCoeff, double dt, double fSimulatedTime);
+};
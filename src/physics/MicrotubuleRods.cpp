@@ -0,0 +1,429 @@
+#include "MicrotubuleRods.h"
+#include "PhysCentrosome.h"
+#include "PhysMicrotubule.h"
+#include "WorkerPool.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include "chemistry/molecules/simConstants.h"
+#include <algorithm>
+#include <cmath>
+
+MicrotubuleRodForce::MicrotubuleRodForce(PhysicsMesh& cortexBody, const std::vector<std::shared_ptr<PhysCentrosome>>& centrosomes)
+    : m_cortexBody(cortexBody)
+    , m_centrosomes(centrosomes)
+{
+}
+
+void MicrotubuleRodForce::beginStep(double dt)
+{
+    // All vertices live in one flat SoA buffer. Rods share no vertices and write only their own Rod
+    // entry, so they are solved in parallel; apply() sums their forces in rod order.
+    gather(dt);
+    WorkerPool::instance().parallelFor(static_cast<uint32_t>(m_rods.size()), 16, [&](uint32_t uBegin, uint32_t uEnd)
+    {
+        for (uint32_t r = uBegin; r < uEnd; ++r)
+            solveRod(m_rods[r]);
+    });
+    scatter();
+}
+
+void MicrotubuleRodForce::gather(double dt)
+{
+    const double segmentLength = MoleculeConstants::MT_SEGMENT_LENGTH_MICROM;
+    const TriangleMesh& cortexMesh = *m_cortexBody.m_pMesh;
+    const Vertices& cortexVertices = *cortexMesh.getVertices();
+
+    m_rods.clear();
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_weights.clear();
+    m_restLengths.clear();
+    for (uint32_t c = 0; c < m_centrosomes.size(); ++c)
+    {
+        if (!m_centrosomes[c]) continue;
+        for (const auto& pMT : m_centrosomes[c]->getMicrotubules())
+        {
+            const uint32_t n = pMT->getVertexCount();
+            if (n < 2) continue;
+
+            Rod rod{};
+            rod.m_pMT = pMT.get();
+            rod.m_centrosomeIndex = c;
+            rod.m_firstVertex = static_cast<uint32_t>(m_x.size());
+            rod.m_vertexCount = n;
+            rod.m_bPinnedTip = (pMT->getState() == PhysMicrotubule::MTState::Bound);
+            rod.m_bContact = false;
+            if (!rod.m_bPinnedTip && pMT->hasTipContact()
+                && pMT->getTipContact().m_triangleIndex < cortexMesh.getTriangleCount())
+            {
+                const MeshLocation& contact = pMT->getTipContact();
+                rod.m_contactVertices = cortexMesh.getTriangleVertices(contact.m_triangleIndex);
+                rod.m_contactBary = contact.getBarycentric();
+                const float3 pointCell = cortexVertices.getVertexPosition(rod.m_contactVertices.x) * rod.m_contactBary.x
+                                       + cortexVertices.getVertexPosition(rod.m_contactVertices.y) * rod.m_contactBary.y
+                                       + cortexVertices.getVertexPosition(rod.m_contactVertices.z) * rod.m_contactBary.z;
+                const double3 normal = cortexMesh.calculateTriangleNormal(contact.m_triangleIndex);
+                const double normalLength = length(normal);
+                if (normalLength > 0.0)
+                {
+                    rod.m_bContact = true;
+                    rod.m_contactPoint = double3(pointCell) - double3(pMT->getTipContactFrameOrigin());
+                    rod.m_contactNormal = normal / normalLength;
+                }
+            }
+            rod.m_fContactLambda = 0.0;
+            rod.m_anchorForce = double3(0, 0, 0);
+
+            // A single segment can still turn freely; from then on it is clamped along its direction
+            PhysMicrotubule::RodState& state = pMT->getRodState();
+            if (state.m_nVertices == 0 || n == 2)
+            {
+                const float3 firstSegment = pMT->getVertexPosition(1) - pMT->getVertexPosition(0);
+                const float firstLength = length(firstSegment);
+                state.m_vClampDirection = (firstLength > 1e-6f) ? firstSegment / firstLength : float3(0, 0, 0);
+            }
+            rod.m_clampDirection = double3(state.m_vClampDirection);
+            rod.m_bClamped = m_settings.m_bClampedMinusEnd && n > 2 && dot(rod.m_clampDirection, rod.m_clampDirection) > 0.5;
+
+            // Full segments have the polymer's segment length, the tip segment the length
+            // polymerization gave it since the last step. A new tip segment starts at rest.
+            const float tipLength = pMT->getLastSegmentLength();
+            const double tipSegmentLength = (state.m_nVertices == n)
+                ? std::max(0.0, double(state.m_fTipRestLength) + double(tipLength) - double(state.m_fTipLength))
+                : double(tipLength);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const float3 p = pMT->getVertexPosition(i);
+                m_x.push_back(p.x);
+                m_y.push_back(p.y);
+                m_z.push_back(p.z);
+                m_restLengths.push_back(i + 2 < n ? segmentLength : (i + 2 == n ? tipSegmentLength : 0.0));
+            }
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const uint32_t v = rod.m_firstVertex + i;
+                const bool bPinned = (i == 0) || (i + 1 == n && rod.m_bPinnedTip);
+                const double contourLength = 0.5 * ((i > 0 ? m_restLengths[v - 1] : 0.0) + m_restLengths[v]);
+                const double drag = m_settings.m_fDragPerLength * std::max(contourLength, 1e-3);
+                m_weights.push_back(bPinned ? 0.0 : dt / drag);
+            }
+            m_rods.push_back(rod);
+        }
+    }
+    m_lambdas.assign(size_t(ROWS_PER_VERTEX) * m_x.size(), 0.0);
+}
+
+namespace
+{
+    // Cholesky factorization and solve of a symmetric positive definite band matrix, in place. band
+    // holds the lower band row by row: band[i * (uBandwidth + 1) + i - j] = A(i, j) for
+    // i - uBandwidth <= j <= i. rhs is overwritten by the solution.
+    void solveBand(std::vector<double>& band, std::vector<double>& rhs, uint32_t nRows, uint32_t uBandwidth)
+    {
+        const uint32_t w = uBandwidth + 1;
+        for (uint32_t i = 0; i < nRows; ++i)
+        {
+            const uint32_t j0 = (i > uBandwidth) ? i - uBandwidth : 0;
+            for (uint32_t j = j0; j <= i; ++j)
+            {
+                double sum = band[i * w + i - j];
+                for (uint32_t k = j0; k < j; ++k)
+                    sum -= band[i * w + i - k] * band[j * w + j - k];
+                if (j < i)
+                    band[i * w + i - j] = sum / band[j * w];
+                else
+                    band[i * w] = std::sqrt(std::max(sum, 1e-30));
+            }
+        }
+        for (uint32_t i = 0; i < nRows; ++i)
+        {
+            const uint32_t j0 = (i > uBandwidth) ? i - uBandwidth : 0;
+            double sum = rhs[i];
+            for (uint32_t k = j0; k < i; ++k)
+                sum -= band[i * w + i - k] * rhs[k];
+            rhs[i] = sum / band[i * w];
+        }
+        for (uint32_t i = nRows; i-- > 0; )
+        {
+            const uint32_t k1 = std::min(nRows, i + w);
+            double sum = rhs[i];
+            for (uint32_t k = i + 1; k < k1; ++k)
+                sum -= band[k * w + k - i] * rhs[k];
+            rhs[i] = sum / band[i * w];
+        }
+    }
+}
+
+uint32_t MicrotubuleRodForce::gatherVertexRows(const Rod& rod, uint32_t i, const std::vector<uint8_t>& active,
+                                               const std::vector<double3>& tangents, RowGradient* pRows) const
+{
+    const uint32_t n = rod.m_vertexCount;
+    const uint32_t first = rod.m_firstVertex;
+    uint32_t nRows = 0;
+    auto addBend = [&](uint32_t k, double g)
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            const uint32_t row = ROWS_PER_VERTEX * k + c;
+            if (!active[row]) continue;
+            double3 gradient(0, 0, 0);
+            gradient[c] = g;
+            pRows[nRows++] = RowGradient{ row, gradient };
+        }
+    };
+
+    // Clamp at the minus end, bending at the interior vertices, contact at the tip
+    for (uint32_t k = (i > 0) ? i - 1 : 0; k <= std::min(i + 1, n - 1); ++k)
+    {
+        if (k == 0)
+        {
+            if (i == 1) addBend(0, 1.0 / m_restLengths[first]);
+            else if (i == 0) addBend(0, -1.0 / m_restLengths[first]);
+        }
+        else if (k + 1 < n)
+        {
+            const double ga = 1.0 / m_restLengths[first + k - 1], gc = 1.0 / m_restLengths[first + k];
+            addBend(k, (i + 1 == k) ? ga : (i == k) ? -(ga + gc) : gc);
+        }
+        else if (i == k && active[ROWS_PER_VERTEX * k])
+        {
+            pRows[nRows++] = RowGradient{ ROWS_PER_VERTEX * k, rod.m_contactNormal };
+        }
+    }
+    // Stretch of the segments on either side
+    if (i > 0 && active[ROWS_PER_VERTEX * (i - 1) + 3])
+        pRows[nRows++] = RowGradient{ ROWS_PER_VERTEX * (i - 1) + 3, tangents[i - 1] };
+    if (i + 1 < n && active[ROWS_PER_VERTEX * i + 3])
+        pRows[nRows++] = RowGradient{ ROWS_PER_VERTEX * i + 3, -tangents[i] };
+    return nRows;
+}
+
+// Every microtubule polyline is an overdamped discrete rod: each step moves its vertices by one
+// implicit step of drag * dx / dt = -grad E in compliant constraint form (XPBD with the drag in
+// place of the mass and compliances not scaled by dt^2, so the multipliers are forces). E has
+// - stretch: |x[i+1] - x[i]| = L[i], nearly rigid. L is the segment length set by polymerization:
+//   MT_SEGMENT_LENGTH for full segments; the tip segment keeps its rest length across steps and
+//   polymerization changes it (PhysMicrotubule::RodState);
+// - bending: (x[i+1] - x[i]) / L[i] - (x[i] - x[i-1]) / L[i-1] = 0 with compliance l / EI at every
+//   interior vertex (l the mean length of its segments), the discrete curvature of a rod that is
+//   straight at rest;
+// - contact: the tip of a microtubule with a tip contact stays on the inner side of the plane of
+//   the cortex triangle it touches.
+// The minus end is pinned to the centrosome and clamped in the pericentriolar material: the first
+// segment bends against the nucleation direction as if that continued the rod (compliance L / 2EI,
+// the half segment on the rod side of the hinge). The tip of a cortex-bound microtubule is pinned
+// to its attachment (DyneinPullingForce pulls there). Twist is not modelled: polylines carry no
+// material frame and microtubules hardly resist or store torsion.
+// The rod is solved directly rather than by Gauss-Seidel sweeps, which leave the multipliers of a
+// long rod far from the forces after any affordable number of iterations: every Gauss-Newton
+// iteration solves the linearized system of all its constraints at once. Ordered along the rod,
+// ROWS_PER_VERTEX rows per vertex, constraints sharing a vertex are at most BANDWIDTH rows apart,
+// so solveBand() factorizes it in time linear in the rod length.
+void MicrotubuleRodForce::solveRod(Rod& rod)
+{
+    const uint32_t n = rod.m_vertexCount;
+    const uint32_t first = rod.m_firstVertex;
+    const uint32_t nRows = ROWS_PER_VERTEX * n;
+    const uint32_t w = BANDWIDTH + 1;
+    const double invBendingStiffness = 1.0 / std::max(m_settings.m_fBendingStiffness, 1e-12);
+    double* pLambdas = m_lambdas.data() + size_t(ROWS_PER_VERTEX) * first;
+
+    // Per-thread scratch, grown to the longest rod once
+    static thread_local std::vector<double> band, rhs, compliances;
+    static thread_local std::vector<uint8_t> active;
+    static thread_local std::vector<double3> tangents;
+    band.resize(size_t(nRows) * w);
+    rhs.resize(nRows);
+    compliances.resize(nRows);
+    active.resize(nRows);
+    tangents.resize(n);
+
+    auto position = [&](uint32_t i) { return double3(m_x[first + i], m_y[first + i], m_z[first + i]); };
+    RowGradient rows[MAX_VERTEX_ROWS];
+
+    for (uint32_t iteration = 0; iteration < m_settings.m_nIterations; ++iteration)
+    {
+        // Constraint values and compliances at the current positions; inactive rows stay identity rows
+        std::fill(band.begin(), band.end(), 0.0);
+        std::fill(active.begin(), active.end(), uint8_t(0));
+        for (uint32_t k = 0; k + 1 < n; ++k)
+        {
+            const double3 d = position(k + 1) - position(k);
+            const double L = length(d);
+            tangents[k] = (L >= 1e-12) ? d / L : double3(0, 0, 0);
+            const uint32_t row = ROWS_PER_VERTEX * k + 3;
+            if (L < 1e-12 || m_weights[first + k] + m_weights[first + k + 1] <= 0.0) continue;
+            active[row] = 1;
+            compliances[row] = m_settings.m_fStretchCompliance;
+            rhs[row] = -(L - m_restLengths[first + k]);
+        }
+        if (rod.m_bClamped && m_restLengths[first] >= 1e-6)
+        {
+            const double L = m_restLengths[first];
+            const double3 C = (position(1) - position(0)) / L - rod.m_clampDirection;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                active[c] = 1;
+                compliances[c] = 0.5 * L * invBendingStiffness;
+                rhs[c] = -C[c];
+            }
+        }
+        for (uint32_t k = 1; k + 1 < n; ++k)
+        {
+            const double La = m_restLengths[first + k - 1], Lc = m_restLengths[first + k];
+            if (La < 1e-6 || Lc < 1e-6) continue;
+            const double3 C = (position(k + 1) - position(k)) / Lc - (position(k) - position(k - 1)) / La;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                const uint32_t row = ROWS_PER_VERTEX * k + c;
+                active[row] = 1;
+                compliances[row] = 0.5 * (La + Lc) * invBendingStiffness;
+                rhs[row] = -C[c];
+            }
+        }
+        // Contact: C = n . (x[tip] - p) <= 0, rigid; active while the tip is outside the plane or
+        // the contact is still pushing
+        const uint32_t contactRow = ROWS_PER_VERTEX * (n - 1);
+        if (rod.m_bContact && m_weights[first + n - 1] > 0.0)
+        {
+            const double C = dot(rod.m_contactNormal, position(n - 1) - rod.m_contactPoint);
+            if (C > 0.0 || pLambdas[contactRow] < 0.0)
+            {
+                active[contactRow] = 1;
+                compliances[contactRow] = 0.0;
+                rhs[contactRow] = -C;
+            }
+        }
+
+        // (J W J^T + compliance) dLambda = -C - compliance * lambda
+        for (uint32_t row = 0; row < nRows; ++row)
+        {
+            if (active[row])
+            {
+                band[size_t(row) * w] = compliances[row];
+                rhs[row] -= compliances[row] * pLambdas[row];
+            }
+            else
+            {
+                band[size_t(row) * w] = 1.0;
+                rhs[row] = 0.0;
+            }
+        }
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const double weight = m_weights[first + i];
+            if (weight <= 0.0) continue;
+            const uint32_t nVertexRows = gatherVertexRows(rod, i, active, tangents, rows);
+            for (uint32_t a = 0; a < nVertexRows; ++a)
+                for (uint32_t b = 0; b <= a; ++b)
+                {
+                    const uint32_t hi = std::max(rows[a].m_row, rows[b].m_row), lo = std::min(rows[a].m_row, rows[b].m_row);
+                    band[size_t(hi) * w + hi - lo] += weight * dot(rows[a].m_gradient, rows[b].m_gradient);
+                }
+        }
+        solveBand(band, rhs, nRows, BANDWIDTH);
+
+        // A contact that would pull the tip lets go
+        if (active[contactRow] && pLambdas[contactRow] + rhs[contactRow] > 0.0)
+            rhs[contactRow] = -pLambdas[contactRow];
+
+        for (uint32_t row = 0; row < nRows; ++row)
+            pLambdas[row] += rhs[row];
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const double weight = m_weights[first + i];
+            if (weight <= 0.0) continue;
+            const uint32_t nVertexRows = gatherVertexRows(rod, i, active, tangents, rows);
+            double3 dx(0, 0, 0);
+            for (uint32_t a = 0; a < nVertexRows; ++a)
+                dx += rows[a].m_gradient * rhs[rows[a].m_row];
+            m_x[first + i] += weight * dx.x;
+            m_y[first + i] += weight * dx.y;
+            m_z[first + i] += weight * dx.z;
+        }
+    }
+
+    // The multipliers are the constraint forces at the new positions. The minus end takes those of
+    // the first segment, the first bend and the clamp (whose torque the centrosome, having no
+    // orientation, does not take up).
+    double3 anchorForce(0, 0, 0);
+    if (m_settings.m_nIterations > 0)
+    {
+        const uint32_t nVertexRows = gatherVertexRows(rod, 0, active, tangents, rows);
+        for (uint32_t a = 0; a < nVertexRows; ++a)
+            anchorForce += rows[a].m_gradient * pLambdas[rows[a].m_row];
+    }
+    rod.m_anchorForce = anchorForce;
+    rod.m_fContactLambda = rod.m_bContact ? std::min(0.0, pLambdas[ROWS_PER_VERTEX * (n - 1)]) : 0.0;
+}
+
+void MicrotubuleRodForce::scatter()
+{
+    for (const Rod& rod : m_rods)
+    {
+        {
+            Vertices::PositionUpdate update(*rod.m_pMT);
+            for (uint32_t i = 1; i < rod.m_vertexCount; ++i)
+            {
+                const uint32_t v = rod.m_firstVertex + i;
+                update.set(i, float3(double3(m_x[v], m_y[v], m_z[v])));
+            }
+        }
+        PhysMicrotubule::RodState& state = rod.m_pMT->getRodState();
+        state.m_nVertices = rod.m_vertexCount;
+        state.m_fTipRestLength = static_cast<float>(m_restLengths[rod.m_firstVertex + rod.m_vertexCount - 2]);
+        state.m_fTipLength = rod.m_pMT->getLastSegmentLength();
+    }
+}
+
+void MicrotubuleRodForce::saveState()
+{
+    m_savedVertices.clear();
+    m_savedRodStates.clear();
+    for (const auto& pCentrosome : m_centrosomes)
+    {
+        if (!pCentrosome) continue;
+        for (const auto& pMT : pCentrosome->getMicrotubules())
+        {
+            for (uint32_t i = 0; i < pMT->getVertexCount(); ++i)
+                m_savedVertices.push_back(pMT->getVertexPosition(i));
+            m_savedRodStates.push_back(pMT->getRodState());
+        }
+    }
+}
+
+void MicrotubuleRodForce::restoreState()
+{
+    // Microtubules grow and shrink only between physics steps, so they are the ones saved
+    uint32_t uVertex = 0, uRod = 0;
+    for (const auto& pCentrosome : m_centrosomes)
+    {
+        if (!pCentrosome) continue;
+        for (const auto& pMT : pCentrosome->getMicrotubules())
+        {
+            {
+                Vertices::PositionUpdate update(*pMT);
+                for (uint32_t i = 0; i < pMT->getVertexCount(); ++i)
+                    update.set(i, m_savedVertices[uVertex++]);
+            }
+            pMT->getRodState() = m_savedRodStates[uRod++];
+        }
+    }
+}
+
+void MicrotubuleRodForce::apply()
+{
+    m_fMaxContactForce = 0.0;
+    for (const Rod& rod : m_rods)
+    {
+        m_centrosomes[rod.m_centrosomeIndex]->getPhysVertex().m_vForce += rod.m_anchorForce;
+        if (!rod.m_bContact || rod.m_fContactLambda == 0.0) continue;
+
+        // The tip pushes the cortex outward at the contact point
+        const double3 force = rod.m_contactNormal * -rod.m_fContactLambda;
+        m_cortexBody.addForce(rod.m_contactVertices.x, force * double(rod.m_contactBary.x));
+        m_cortexBody.addForce(rod.m_contactVertices.y, force * double(rod.m_contactBary.y));
+        m_cortexBody.addForce(rod.m_contactVertices.z, force * double(rod.m_contactBary.z));
+        m_fMaxContactForce = std::max(m_fMaxContactForce, -rod.m_fContactLambda);
+    }
+}
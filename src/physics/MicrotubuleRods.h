@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "ForceGenerator.h"
+#include "PhysMicrotubule.h"
+
+class PhysCentrosome;
+
+// Elastic rod mechanics of the microtubules of all centrosomes, coupled to the cortex: every
+// microtubule is an overdamped discrete rod, relaxed by one implicit step per physics step. The
+// model and the direct band solver are described at MicrotubuleRodForce::solveRod().
+class MicrotubuleRodForce : public IForceGenerator
+{
+public:
+    struct Settings
+    {
+        double m_fBendingStiffness = 20.0;     // flexural rigidity EI (pN um^2)
+        double m_fStretchCompliance = 1e-4;    // um / pN
+        double m_fDragPerLength = 1.0;         // pN s / um^2, spread over the vertices by contour length
+        uint32_t m_nIterations = 4;            // Gauss-Newton iterations per step
+        bool m_bClampedMinusEnd = true;
+    };
+
+    MicrotubuleRodForce(PhysicsMesh& cortexBody, const std::vector<std::shared_ptr<PhysCentrosome>>& centrosomes);
+
+    const Settings& getSettings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+
+    // Relax all rods over dt; apply() then adds the contact forces to the cortex and the force every
+    // rod exerts on its minus end to the centrosome
+    void beginStep(double dt) override;
+    void apply() override;
+    // The polylines and rod states of all microtubules
+    void saveState() override;
+    void restoreState() override;
+
+    // Largest contact force of the last step (pN)
+    double getMaxContactForce() const { return m_fMaxContactForce; }
+
+private:
+    // Rows of the rod system per vertex k: bending (x, y, z) at k, whose slots hold the clamp at the
+    // minus end and the contact at the tip, and stretch of the segment starting at k
+    static const uint32_t ROWS_PER_VERTEX = 4;
+    static const uint32_t BANDWIDTH = 10;
+    // Rows one vertex takes part in: 3 bends of 3 rows, 2 stretches and the contact
+    static const uint32_t MAX_VERTEX_ROWS = 12;
+
+    PhysicsMesh& m_cortexBody;
+    const std::vector<std::shared_ptr<PhysCentrosome>>& m_centrosomes;
+    Settings m_settings;
+    double m_fMaxContactForce = 0.0;
+
+    struct Rod
+    {
+        PhysMicrotubule* m_pMT;
+        uint32_t m_centrosomeIndex;
+        uint32_t m_firstVertex;
+        uint32_t m_vertexCount;
+        bool m_bPinnedTip;
+        bool m_bClamped;
+        double3 m_clampDirection;
+        bool m_bContact;
+        // Contact plane in microtubule coordinates, the cortex vertices and weights of the contact
+        // point, and the contact multiplier (the force on the tip is m_contactNormal * lambda <= 0)
+        double3 m_contactPoint;
+        double3 m_contactNormal;
+        uint3 m_contactVertices;
+        float3 m_contactBary;
+        double m_fContactLambda;
+        // Force of the rod on its minus end
+        double3 m_anchorForce;
+    };
+    std::vector<Rod> m_rods;
+
+    // Per vertex of all rods, in microtubule coordinates. m_weights: dt / drag (0 for pinned
+    // vertices); m_restLengths: of the segment starting at the vertex. m_lambdas: ROWS_PER_VERTEX
+    // constraint multipliers per vertex.
+    std::vector<double> m_x, m_y, m_z;
+    std::vector<double> m_weights;
+    std::vector<double> m_restLengths;
+    std::vector<double> m_lambdas;
+
+    // saveState(): the vertices of all microtubules in centrosome and microtubule order, and the
+    // rod state of each
+    std::vector<float3> m_savedVertices;
+    std::vector<PhysMicrotubule::RodState> m_savedRodStates;
+
+    struct RowGradient
+    {
+        uint32_t m_row;
+        double3 m_gradient;
+    };
+
+    void gather(double dt);
+    // Active rows of the rod system that vertex i of rod takes part in, with their gradients with
+    // respect to it; returns how many were written to pRows (at most MAX_VERTEX_ROWS)
+    uint32_t gatherVertexRows(const Rod& rod, uint32_t i, const std::vector<uint8_t>& active,
+                              const std::vector<double3>& tangents, RowGradient* pRows) const;
+    void solveRod(Rod& rod);
+    void scatter();
+};
@@ -46,11 +46,55 @@ public:
         m_attachmentLocation = location; 
     }
 
+    // Cortex location a growing tip pushes against (polymerization stalled at the cortex); the
+    // elastic rod model keeps the tip on the inner side of it and pushes the cortex outward.
+    // vFrameOrigin is the cell-space point microtubule coordinates were relative to when the contact
+    // was found (the centrosome position), so cortex points minus it are in microtubule coordinates.
+    bool hasTipContact() const { return m_bTipContact; }
+    const MeshLocation& getTipContact() const
+    {
+        assert(m_bTipContact && "Tip contact only valid while the tip touches the cortex");
+        return m_tipContact;
+    }
+    MeshLocation& getTipContact()
+    {
+        assert(m_bTipContact && "Tip contact only valid while the tip touches the cortex");
+        return m_tipContact;
+    }
+    const float3& getTipContactFrameOrigin() const { return m_vTipContactFrameOrigin; }
+    void setTipContact(const MeshLocation& location, const float3& vFrameOrigin)
+    {
+        m_tipContact = location;
+        m_vTipContactFrameOrigin = vFrameOrigin;
+        m_bTipContact = true;
+    }
+    void clearTipContact() { m_bTipContact = false; }
+
+    // Bookkeeping of MicrotubuleRodForce between steps: the rest length of the tip segment and the
+    // vertex count and tip segment length the mechanics left. Polymerization in between changes the
+    // rest length by as much as it changes the tip segment; compression by the mechanics does not.
+    // The minus end is clamped along the direction the microtubule had while it was a single segment.
+    struct RodState
+    {
+        uint32_t m_nVertices = 0;
+        float m_fTipRestLength = 0.0f;
+        float m_fTipLength = 0.0f;
+        float3 m_vClampDirection = float3(0, 0, 0);
+    };
+    RodState& getRodState() { return m_rodState; }
+
 private:
     // Current state (relevant for physics: Bound state enables cortical forces)
     MTState m_mtState = MTState::Growing;
 
     // Cortical attachment location (valid only when m_mtState == Bound)
     MeshLocation m_attachmentLocation;
+
+    // Cortical contact of the tip (valid only when m_bTipContact)
+    bool m_bTipContact = false;
+    MeshLocation m_tipContact;
+    float3 m_vTipContactFrameOrigin = float3(0, 0, 0);
+
+    RodState m_rodState;
 };
 
@@ -8,7 +8,12 @@
 struct IConstraint : public std::enable_shared_from_this<IConstraint>
 {
     virtual ~IConstraint() = default;
-    virtual void project(double dt) = 0;
-};
 
+    // Start of a (sub)step: Lagrange multipliers accumulate over the iterations of one step only
+    virtual void beginStep() {}
+    virtual void project(double dt) = 0;
 
+    // The mesh of body was remeshed; constraints keeping per-edge or per-triangle data of that body
+    // remap it here
+    virtual void onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes) {}
+};
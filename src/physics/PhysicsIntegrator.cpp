@@ -1,6 +1,7 @@
 #include "PhysicsIntegrator.h"
 #include "geometry/mesh/TriangleMesh.h"
 #include <algorithm>
+#include <cmath>
 
 namespace {
     // Semi-implicit Euler integration for a single physics vertex
@@ -21,6 +22,7 @@ namespace {
 void PhysicsIntegrator::addBody(std::shared_ptr<PhysicsMesh> body)
 {
     m_bodies.push_back(body);
+    m_bFusionDirty = true;
 }
 
 void PhysicsIntegrator::addCentrosome(std::shared_ptr<PhysCentrosome> centrosome)
@@ -31,6 +33,7 @@ void PhysicsIntegrator::addCentrosome(std::shared_ptr<PhysCentrosome> centrosome
 void PhysicsIntegrator::addForceGenerator(std::unique_ptr<IForceGenerator> generator)
 {
     m_forceGenerators.push_back(std::move(generator));
+    m_bFusionDirty = true;
 }
 
 void PhysicsIntegrator::addConstraint(std::shared_ptr<IConstraint> constraint)
@@ -38,13 +41,227 @@ void PhysicsIntegrator::addConstraint(std::shared_ptr<IConstraint> constraint)
     m_constraints.push_back(constraint);
 }
 
+void PhysicsIntegrator::applyMeshChanges(PhysicsMesh& body, const MeshRemesher::Changes& changes)
+{
+    body.applyMeshChanges(changes);
+    for (auto& gen : m_forceGenerators)
+        gen->onMeshChanged(body, changes);
+    for (auto& c : m_constraints)
+        c->onMeshChanged(body, changes);
+}
+
+void PhysicsIntegrator::setImplicitSolverSettings(const ImplicitEulerSolver::Settings& settings)
+{
+    m_implicitSettings = settings;
+    for (auto& pSolver : m_implicitSolvers)
+        pSolver->setSettings(settings);
+}
+
+uint32_t PhysicsIntegrator::getLastSolverIterations() const
+{
+    uint32_t nIterations = 0;
+    for (auto& pSolver : m_implicitSolvers)
+        nIterations += pSolver->getLastIterationCount();
+    return nIterations;
+}
+
+void PhysicsIntegrator::updateFusion()
+{
+    m_fusedEdgeForces.clear();
+    m_separateGenerators.clear();
+    m_implicitSolvers.clear();
+    for (auto& pBody : m_bodies)
+    {
+        m_fusedEdgeForces.push_back(std::make_unique<FusedEdgeForces>(*pBody));
+        m_implicitSolvers.push_back(std::make_unique<ImplicitEulerSolver>(m_implicitSettings));
+    }
+    for (auto& gen : m_forceGenerators)
+    {
+        bool bFused = false;
+        for (auto& pFused : m_fusedEdgeForces)
+        {
+            if (gen->fuseInto(*pFused))
+            {
+                bFused = true;
+                break;
+            }
+        }
+        if (!bFused)
+            m_separateGenerators.push_back(gen.get());
+    }
+    m_bFusionDirty = false;
+}
+
+void PhysicsIntegrator::setErrorControl(double fTolerance, const StepSizeController::Settings& settings)
+{
+    m_fErrorTolerance = fTolerance;
+    m_stepController.setSettings(settings);
+}
+
 void PhysicsIntegrator::step(double dt)
 {
     if (dt <= 0.0) return;
 
-    // Step 1: Apply all force generators
-    for (auto& gen : m_forceGenerators)
-        gen->apply();
+    if (m_fErrorTolerance > 0.0)
+    {
+        stepWithErrorControl(dt);
+        return;
+    }
+    m_lastStepStats = StepStats();
+    m_lastStepStats.m_nAccepted = 1;
+    advance(dt);
+}
+
+double PhysicsIntegrator::computeKineticEnergy() const
+{
+    double fEnergy = 0.0;
+    for (auto& pBody : m_bodies)
+    {
+        const VectorArray3& velocities = pBody->getVelocities();
+        const auto& masses = pBody->getMasses();
+        for (uint32_t i = 0; i < pBody->getVertexCount(); ++i)
+            fEnergy += 0.5 * double(masses[i]) * lengthSquared(velocities.get(i));
+    }
+    for (auto& pCentrosome : m_centrosomes)
+    {
+        const PhysVertex& physVertex = pCentrosome->getPhysVertex();
+        fEnergy += 0.5 * physVertex.m_fMass * lengthSquared(physVertex.m_vVelocity);
+    }
+    return fEnergy;
+}
+
+void PhysicsIntegrator::clearVelocities()
+{
+    for (auto& pBody : m_bodies)
+        pBody->accessVelocities().assign(pBody->getVertexCount(), double3(0, 0, 0));
+    for (auto& pCentrosome : m_centrosomes)
+        pCentrosome->getPhysVertex().m_vVelocity = double3(0, 0, 0);
+}
+
+void PhysicsIntegrator::advance(double dt)
+{
+    const double substepDt = dt / m_nSubsteps;
+    for (uint32_t s = 0; s < m_nSubsteps; ++s)
+        substep(substepDt);
+}
+
+void PhysicsIntegrator::stepWithErrorControl(double dt)
+{
+    m_lastStepStats = StepStats();
+    double remaining = dt;
+    while (remaining > 1e-12 * dt)
+    {
+        const double h = m_stepController.proposeDt(remaining);
+        saveState();
+        advance(h);
+        saveWholeStepPositions();
+        restoreState();
+        advance(0.5 * h);
+        advance(0.5 * h);
+
+        // Semi-implicit and backward Euler both have local error O(h^2)
+        const double errorRatio = computeStepDoublingError() / m_fErrorTolerance;
+        if (!m_stepController.update(h, errorRatio, 1))
+        {
+            restoreState();
+            ++m_lastStepStats.m_nRejected;
+            continue;
+        }
+        ++m_lastStepStats.m_nAccepted;
+        m_lastStepStats.m_fMaxErrorRatio = std::max(m_lastStepStats.m_fMaxErrorRatio, errorRatio);
+        remaining -= h;
+    }
+}
+
+void PhysicsIntegrator::saveState()
+{
+    m_savedBodies.resize(m_bodies.size());
+    for (size_t bodyIdx = 0; bodyIdx < m_bodies.size(); ++bodyIdx)
+    {
+        const Vertices& vertices = *m_bodies[bodyIdx]->m_pMesh->getVertices();
+        SavedBody& saved = m_savedBodies[bodyIdx];
+        saved.m_positions.resize(vertices.getVertexCount());
+        for (uint32_t i = 0; i < vertices.getVertexCount(); ++i)
+            saved.m_positions[i] = vertices.getVertexPosition(i);
+        saved.m_velocities = m_bodies[bodyIdx]->getVelocities();
+    }
+    m_savedCentrosomes.resize(m_centrosomes.size());
+    for (size_t c = 0; c < m_centrosomes.size(); ++c)
+    {
+        m_savedCentrosomes[c].m_physVertex = m_centrosomes[c]->getPhysVertex();
+        m_savedCentrosomes[c].m_position = m_centrosomes[c]->getToNormalizedCell().m_translation;
+    }
+    for (auto& pGen : m_forceGenerators)
+        pGen->saveState();
+}
+
+void PhysicsIntegrator::restoreState()
+{
+    for (size_t bodyIdx = 0; bodyIdx < m_bodies.size(); ++bodyIdx)
+    {
+        Vertices& vertices = *m_bodies[bodyIdx]->m_pMesh->getVertices();
+        const SavedBody& saved = m_savedBodies[bodyIdx];
+        Vertices::PositionUpdate update(vertices);
+        for (uint32_t i = 0; i < saved.m_positions.size(); ++i)
+            update.set(i, saved.m_positions[i]);
+        m_bodies[bodyIdx]->accessVelocities() = saved.m_velocities;
+    }
+    for (size_t c = 0; c < m_centrosomes.size(); ++c)
+    {
+        m_centrosomes[c]->getPhysVertex() = m_savedCentrosomes[c].m_physVertex;
+        m_centrosomes[c]->getToNormalizedCell().m_translation = m_savedCentrosomes[c].m_position;
+    }
+    for (auto& pGen : m_forceGenerators)
+        pGen->restoreState();
+}
+
+void PhysicsIntegrator::saveWholeStepPositions()
+{
+    for (size_t bodyIdx = 0; bodyIdx < m_bodies.size(); ++bodyIdx)
+    {
+        const Vertices& vertices = *m_bodies[bodyIdx]->m_pMesh->getVertices();
+        std::vector<float3>& positions = m_savedBodies[bodyIdx].m_wholeStepPositions;
+        positions.resize(vertices.getVertexCount());
+        for (uint32_t i = 0; i < vertices.getVertexCount(); ++i)
+            positions[i] = vertices.getVertexPosition(i);
+    }
+    for (size_t c = 0; c < m_centrosomes.size(); ++c)
+        m_savedCentrosomes[c].m_wholeStepPosition = m_centrosomes[c]->getToNormalizedCell().m_translation;
+}
+
+double PhysicsIntegrator::computeStepDoublingError() const
+{
+    double maxErrorSq = 0.0;
+    for (size_t bodyIdx = 0; bodyIdx < m_bodies.size(); ++bodyIdx)
+    {
+        const Vertices& vertices = *m_bodies[bodyIdx]->m_pMesh->getVertices();
+        const std::vector<float3>& wholeStep = m_savedBodies[bodyIdx].m_wholeStepPositions;
+        for (uint32_t i = 0; i < wholeStep.size(); ++i)
+        {
+            const double3 d = double3(vertices.getVertexPosition(i)) - double3(wholeStep[i]);
+            maxErrorSq = std::max(maxErrorSq, dot(d, d));
+        }
+    }
+    for (size_t c = 0; c < m_centrosomes.size(); ++c)
+    {
+        const double3 d = double3(m_centrosomes[c]->getToNormalizedCell().m_translation)
+                        - double3(m_savedCentrosomes[c].m_wholeStepPosition);
+        maxErrorSq = std::max(maxErrorSq, dot(d, d));
+    }
+    return std::sqrt(maxErrorSq);
+}
+
+void PhysicsIntegrator::substep(double dt)
+{
+    // Step 1: Apply all force generators, the per-edge ones of each body in one fused sweep
+    if (m_bFusionDirty)
+        updateFusion();
+    for (auto& pGen : m_forceGenerators)
+        pGen->beginStep(dt);
+    for (auto& pFused : m_fusedEdgeForces)
+        pFused->apply();
+    for (IForceGenerator* pGen : m_separateGenerators)
+        pGen->apply();
 
     // Step 2: Semi-implicit Euler integration for centrosomes
     for (auto& pCentrosome : m_centrosomes)
@@ -54,50 +271,75 @@ void PhysicsIntegrator::step(double dt)
         updatePosition(pCentrosome->getToNormalizedCell().m_translation, physVertex.m_vVelocity, dt);
     }
 
-    // Step 3: Semi-implicit Euler integration for mesh bodies
-    for (auto& pBody : m_bodies)
+    // Step 3: Semi-implicit or backward Euler integration for mesh bodies
+    for (size_t bodyIdx = 0; bodyIdx < m_bodies.size(); ++bodyIdx)
     {
-        const uint32_t n = pBody->m_pMesh->getVertices()->getVertexCount();
+        auto& pBody = m_bodies[bodyIdx];
+        Vertices& vertices = *pBody->m_pMesh->getVertices();
+        const uint32_t n = vertices.getVertexCount();
+        const VectorArray3& forces = pBody->getForces();
+        const std::vector<PhysicsPrecision::State>& masses = pBody->getMasses();
+        VectorArray3& velocities = pBody->accessVelocities();
 
+        const FusedEdgeForces& edgeForces = *m_fusedEdgeForces[bodyIdx];
+        const bool bImplicit = (m_scheme == Scheme::IMPLICIT_EULER) && !edgeForces.isEmpty();
+        if (bImplicit)
+            m_implicitSolvers[bodyIdx]->solve(edgeForces, dt);
+
+        // One version bump for the whole body
+        using Real = PhysicsPrecision::Compute;
+        using Real3 = vector<Real, 3>;
+        const Real fDt = Real(dt);
+        Vertices::PositionUpdate update(vertices);
         for (uint32_t i = 0; i < n; ++i)
         {
-            auto& vertex = pBody->getVertex(i);
-            integratePhysVertex(vertex, dt);
-            
+            if (!bImplicit)
+            {
+                const Real m = std::max(Real(1e-12), Real(masses[i]));
+                velocities.add(i, forces.get<Real>(i) / m * fDt);
+            }
+
             // Update position in mesh geometry
-            float3 pos = pBody->m_pMesh->getVertices()->getVertexPosition(i);
-            updatePosition(pos, vertex.m_vVelocity, dt);
-            pBody->m_pMesh->getVertices()->setVertexPosition(i, pos);
+            const Real3 pos = Real3(vertices.getVertexPosition(i)) + velocities.get<Real>(i) * fDt;
+            update.set(i, float3(pos));
         }
     }
 
-    // Step 4: Save pre-constraint positions for velocity correction
-    std::vector<std::vector<double3>> preProjectPositions;
-    preProjectPositions.reserve(m_bodies.size());
-    for (auto& pBody : m_bodies)
+    // Step 4: Save pre-constraint positions for velocity correction (buffers only grow when bodies
+    // are added or remeshed)
+    m_preProjectPositions.resize(m_bodies.size());
+    for (size_t bodyIdx = 0; bodyIdx < m_bodies.size(); ++bodyIdx)
     {
-        const uint32_t n = pBody->m_pMesh->getVertices()->getVertexCount();
-        std::vector<double3> positions(n);
+        const Vertices& vertices = *m_bodies[bodyIdx]->m_pMesh->getVertices();
+        const uint32_t n = vertices.getVertexCount();
+        std::vector<double3>& positions = m_preProjectPositions[bodyIdx];
+        positions.resize(n);
         for (uint32_t i = 0; i < n; ++i)
-            positions[i] = double3(pBody->m_pMesh->getVertices()->getVertexPosition(i));
-        preProjectPositions.push_back(std::move(positions));
+            positions[i] = double3(vertices.getVertexPosition(i));
     }
 
-    // Step 5: Apply all constraints (XPBD position corrections)
+    // Step 5: Apply all constraints (XPBD position corrections); multipliers restart every substep
     for (auto& c : m_constraints)
-        c->project(dt);
+        c->beginStep();
+    for (uint32_t iteration = 0; iteration < m_nConstraintIterations; ++iteration)
+    {
+        for (auto& c : m_constraints)
+            c->project(dt);
+    }
 
     // Step 6: Update velocities based on constraint-induced position changes
     for (size_t bodyIdx = 0; bodyIdx < m_bodies.size(); ++bodyIdx)
     {
         auto& pBody = m_bodies[bodyIdx];
-        const uint32_t n = pBody->m_pMesh->getVertices()->getVertexCount();
-        const auto& prePos = preProjectPositions[bodyIdx];
+        const Vertices& vertices = *pBody->m_pMesh->getVertices();
+        const uint32_t n = vertices.getVertexCount();
+        const auto& prePos = m_preProjectPositions[bodyIdx];
+        VectorArray3& velocities = pBody->accessVelocities();
 
         for (uint32_t i = 0; i < n; ++i)
         {
-            double3 xProj = double3(pBody->m_pMesh->getVertices()->getVertexPosition(i));
-            pBody->getVertex(i).m_vVelocity += (xProj - prePos[i]) / dt;
+            double3 xProj = double3(vertices.getVertexPosition(i));
+            velocities.add(i, (xProj - prePos[i]) / dt);
         }
     }
 
@@ -108,10 +350,6 @@ void PhysicsIntegrator::step(double dt)
     }
     
     for (auto& pBody : m_bodies)
-    {
-        const uint32_t n = pBody->m_pMesh->getVertices()->getVertexCount();
-        for (uint32_t i = 0; i < n; ++i)
-            pBody->getVertex(i).m_vForce = double3(0, 0, 0);
-    }
+        pBody->clearForces();
 }
 
@@ -2,18 +2,60 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include "PhysicsMesh.h"
 #include "PhysCentrosome.h"
 #include "ForceGenerator.h"
+#include "FusedEdgeForces.h"
+#include "ImplicitEulerSolver.h"
 #include "PhysicsConstraints.h"
+#include "StepSizeController.h"
 
 // Physics integrator managing the complete simulation pipeline:
 // force application, integration, constraint projection, and velocity correction
 class PhysicsIntegrator
 {
 public:
+    enum class Scheme
+    {
+        SEMI_IMPLICIT_EULER,    // all forces explicit; dt is limited by the stiffest spring
+        IMPLICIT_EULER          // backward Euler for the edge springs and dampers of each body
+    };
+
     PhysicsIntegrator() = default;
 
+    void setScheme(Scheme scheme) { m_scheme = scheme; }
+    Scheme getScheme() const { return m_scheme; }
+    void setImplicitSolverSettings(const ImplicitEulerSolver::Settings& settings);
+    // Conjugate gradient iterations of the last step, summed over bodies (IMPLICIT_EULER)
+    uint32_t getLastSolverIterations() const;
+
+    // step(dt) runs nSubsteps substeps of dt / nSubsteps, each with the whole pipeline and
+    // nIterations rounds over all constraints. Small substeps converge constraints better than more
+    // iterations at the same cost.
+    void setSubsteps(uint32_t nSubsteps) { m_nSubsteps = std::max(1u, nSubsteps); }
+    uint32_t getSubsteps() const { return m_nSubsteps; }
+    void setConstraintIterations(uint32_t nIterations) { m_nConstraintIterations = std::max(1u, nIterations); }
+    uint32_t getConstraintIterations() const { return m_nConstraintIterations; }
+
+    // Error control (fTolerance > 0; 0 disables it): step(dt) covers dt with steps sized by step
+    // doubling. Every step is taken once whole and once as two halves; the largest distance between
+    // the two results over all vertices and centrosomes is its error. The two-halves result is kept
+    // if the error is within fTolerance, otherwise the step is undone and retried smaller.
+    void setErrorControl(double fTolerance, const StepSizeController::Settings& settings = StepSizeController::Settings());
+    double getErrorTolerance() const { return m_fErrorTolerance; }
+    // Size error control would try next (0 before the first controlled step)
+    double getSuggestedDt() const { return m_stepController.getDt(); }
+
+    // Steps the last step(dt) was covered with
+    struct StepStats
+    {
+        uint32_t m_nAccepted = 0;
+        uint32_t m_nRejected = 0;
+        double m_fMaxErrorRatio = 0.0;     // largest error / tolerance of an accepted step
+    };
+    const StepStats& getLastStepStats() const { return m_lastStepStats; }
+
     // Add a body to be integrated
     void addBody(std::shared_ptr<PhysicsMesh> body);
 
@@ -26,14 +68,69 @@ public:
     // Add a constraint to the simulation
     void addConstraint(std::shared_ptr<IConstraint> constraint);
 
-    // Execute complete physics pipeline: forces -> integration -> constraints
+    // Bring the state of body and of the force generators up to date after its mesh was remeshed
+    void applyMeshChanges(PhysicsMesh& body, const MeshRemesher::Changes& changes);
+
+    // Execute complete physics pipeline: forces -> integration -> constraints, per substep.
+    // Does not allocate unless bodies, generators or mesh topology changed since the last step
+    // (tests/physicsAllocations).
     void step(double dt);
 
+    // Kinetic energy of all bodies and centrosomes, sum of m |v|^2 / 2
+    double computeKineticEnergy() const;
+    // Bring all bodies and centrosomes to rest
+    void clearVelocities();
+
 private:
     std::vector<std::shared_ptr<PhysicsMesh>> m_bodies;
     std::vector<std::shared_ptr<PhysCentrosome>> m_centrosomes;
     std::vector<std::unique_ptr<IForceGenerator>> m_forceGenerators;
     std::vector<std::shared_ptr<IConstraint>> m_constraints;
+
+    // Generators that fuse into the edge kernel of their body, and the ones applied one by one;
+    // rebuilt when bodies or generators are added
+    std::vector<std::unique_ptr<FusedEdgeForces>> m_fusedEdgeForces;
+    std::vector<IForceGenerator*> m_separateGenerators;
+    bool m_bFusionDirty = true;
+
+    uint32_t m_nSubsteps = 1;
+    uint32_t m_nConstraintIterations = 1;
+
+    Scheme m_scheme = Scheme::SEMI_IMPLICIT_EULER;
+    ImplicitEulerSolver::Settings m_implicitSettings;
+    // One per body, parallel to m_fusedEdgeForces
+    std::vector<std::unique_ptr<ImplicitEulerSolver>> m_implicitSolvers;
+
+    // Per-body scratch of step(), kept between steps so that steady-state steps do not allocate
+    std::vector<std::vector<double3>> m_preProjectPositions;
+
+    // Error control; the state before a step and the positions after it taken whole
+    double m_fErrorTolerance = 0.0;
+    StepSizeController m_stepController;
+    StepStats m_lastStepStats;
+    struct SavedBody
+    {
+        std::vector<float3> m_positions;
+        VectorArray3 m_velocities;
+        std::vector<float3> m_wholeStepPositions;
+    };
+    struct SavedCentrosome
+    {
+        PhysVertex m_physVertex;
+        float3 m_position;
+        float3 m_wholeStepPosition;
+    };
+    std::vector<SavedBody> m_savedBodies;
+    std::vector<SavedCentrosome> m_savedCentrosomes;
+
+    void updateFusion();
+    void advance(double dt);
+    void substep(double dt);
+    void stepWithErrorControl(double dt);
+    void saveState();
+    void restoreState();
+    void saveWholeStepPositions();
+    double computeStepDoublingError() const;
 };
 
 
@@ -1,16 +1,73 @@
 #include "PhysicsMesh.h"
 #include "geometry/mesh/TriangleMesh.h"
+#include "geometry/mesh/Edges.h"
 
 PhysicsMesh::PhysicsMesh(std::shared_ptr<TriangleMesh> mesh)
     : m_pMesh(std::move(mesh))
 {
     const uint32_t vertexCount = m_pMesh->getVertices()->getVertexCount();
-    m_nodeData.resize(vertexCount);
-    for (uint32_t i = 0; i < vertexCount; ++i)
+    m_velocities.assign(vertexCount, double3(0, 0, 0));
+    m_forces.assign(vertexCount, double3(0, 0, 0));
+    m_masses.assign(vertexCount, PhysicsPrecision::State(1));
+}
+
+void PhysicsMesh::clearForces()
+{
+    m_forces.assign(getVertexCount(), double3(0, 0, 0));
+}
+
+void PhysicsMesh::applyMeshChanges(const MeshRemesher::Changes& changes)
+{
+    if (changes.isEmpty())
+        return;
+
+    const uint32_t n = static_cast<uint32_t>(changes.m_vertexSources.size());
+    VectorArray3 velocities, forces;
+    velocities.assign(n, double3(0, 0, 0));
+    forces.assign(n, double3(0, 0, 0));
+    for (uint32_t i = 0; i < n; ++i)
     {
-        m_nodeData[i].m_vVelocity = double3(0, 0, 0);
-        m_nodeData[i].m_vForce = double3(0, 0, 0);
-        m_nodeData[i].m_fMass = 1.0;
+        const MeshRemesher::Changes::VertexSource& source = changes.m_vertexSources[i];
+        const double t = source.m_fT;
+        velocities.set(i, m_velocities.get(source.m_uA) * (1.0 - t) + m_velocities.get(source.m_uB) * t);
+        forces.set(i, m_forces.get(source.m_uA) * (1.0 - t) + m_forces.get(source.m_uB) * t);
     }
+    m_velocities = std::move(velocities);
+    m_forces = std::move(forces);
+
+    // Interpolated masses would add the mass of every split vertex and drop that of every collapsed
+    // one; instead the total mass is spread over the new mesh by lumped area (a third of each
+    // adjacent triangle). Vertices without triangles get the mean share.
+    double fTotalMass = 0.0;
+    for (PhysicsPrecision::State fMass : m_masses)
+        fTotalMass += double(fMass);
+    std::vector<double> areas(n, 0.0);
+    double fTotalArea = 0.0;
+    for (uint32_t t = 0; t < m_pMesh->getTriangleCount(); ++t)
+    {
+        const double fArea = m_pMesh->calculateTriangleArea(t) / 3.0;
+        const uint3 triangle = m_pMesh->getTriangleVertices(t);
+        areas[triangle.x] += fArea;
+        areas[triangle.y] += fArea;
+        areas[triangle.z] += fArea;
+        fTotalArea += 3.0 * fArea;
+    }
+    const double fMeanArea = (fTotalArea > 0.0) ? fTotalArea / n : 1.0;
+    double fTotalWeight = 0.0;
+    for (double& fArea : areas)
+    {
+        if (fArea <= 0.0) fArea = fMeanArea;
+        fTotalWeight += fArea;
+    }
+    m_masses.resize(n);
+    for (uint32_t i = 0; i < n; ++i)
+        m_masses[i] = PhysicsPrecision::State(fTotalMass * areas[i] / fTotalWeight);
 }
 
+std::shared_ptr<const EdgeColoring> PhysicsMesh::getOrCreateEdgeColoring()
+{
+    auto pEdges = m_pMesh->getOrCreateEdges();
+    if (!m_pEdgeColoring || m_pEdgeColoring->getTopologyVersion() != pEdges->getTopologyVersion())
+        m_pEdgeColoring = EdgeColoring::computeColoring(*pEdges);
+    return m_pEdgeColoring;
+}
@@ -2,8 +2,13 @@
 
 #include <memory>
 #include <vector>
+#include <span>
 #include "geometry/vectors/vector.h"
 #include "geometry/mesh/TriangleMesh.h"
+#include "geometry/mesh/MeshRemesher.h"
+#include "geometry/mesh/EdgeColoring.h"
+#include "physics/WorkerPool.h"
+#include "physics/PhysicsPrecision.h"
 
 // Per-vertex dynamic state (velocity, force, mass)
 // Position is stored in the mesh geometry
@@ -14,7 +19,29 @@ struct PhysVertex
     double m_fMass;
 };
 
-// Physics mesh combining edge-based geometry with per-vertex dynamic state
+// Per-vertex 3D vectors with the x, y and z components in separate arrays of T. Elements are read
+// and written as vectors of any scalar (double unless asked otherwise) and converted on access.
+template <class T>
+struct VectorArray3T
+{
+    std::vector<T> m_x, m_y, m_z;
+
+    uint32_t size() const { return static_cast<uint32_t>(m_x.size()); }
+    void assign(uint32_t n, const double3& v) { m_x.assign(n, T(v.x)); m_y.assign(n, T(v.y)); m_z.assign(n, T(v.z)); }
+    template <class R = double>
+    vector<R, 3> get(uint32_t i) const { return vector<R, 3>(R(m_x[i]), R(m_y[i]), R(m_z[i])); }
+    template <class R>
+    void set(uint32_t i, const vector<R, 3>& v) { m_x[i] = T(v.x); m_y[i] = T(v.y); m_z[i] = T(v.z); }
+    template <class R>
+    void add(uint32_t i, const vector<R, 3>& v) { m_x[i] = T(m_x[i] + v.x); m_y[i] = T(m_y[i] + v.y); m_z[i] = T(m_z[i] + v.z); }
+};
+
+// State arrays of PhysicsMesh, in the precision of the build (see PhysicsPrecision.h)
+using VectorArray3 = VectorArray3T<PhysicsPrecision::State>;
+
+// Physics mesh combining edge-based geometry with per-vertex dynamic state. The state is kept in
+// SoA form (one array per component) so force kernels stream only the components they use, in the
+// scalar of PhysicsPrecision::State; the single-vertex accessors convert to and from double.
 class PhysicsMesh : public std::enable_shared_from_this<PhysicsMesh>
 {
 public:
@@ -22,10 +49,77 @@ public:
 
     explicit PhysicsMesh(std::shared_ptr<TriangleMesh> mesh);
 
-    const PhysVertex& getVertex(uint32_t index) const { return m_nodeData[index]; }
-    PhysVertex& getVertex(uint32_t index) { return m_nodeData[index]; }
+    uint32_t getVertexCount() const { return static_cast<uint32_t>(m_masses.size()); }
+
+    double3 getVelocity(uint32_t index) const { return m_velocities.get(index); }
+    void setVelocity(uint32_t index, const double3& velocity) { m_velocities.set(index, velocity); }
+    double3 getForce(uint32_t index) const { return m_forces.get(index); }
+    void addForce(uint32_t index, const double3& force) { m_forces.add(index, force); }
+    double getMass(uint32_t index) const { return m_masses[index]; }
+    void setMass(uint32_t index, double fMass) { m_masses[index] = PhysicsPrecision::State(fMass); }
+
+    // Whole arrays for vectorized kernels
+    const VectorArray3& getVelocities() const { return m_velocities; }
+    VectorArray3& accessVelocities() { return m_velocities; }
+    const VectorArray3& getForces() const { return m_forces; }
+    VectorArray3& accessForces() { return m_forces; }
+    const std::vector<PhysicsPrecision::State>& getMasses() const { return m_masses; }
+
+    void clearForces();
+
+    // Follow a remeshing of the mesh: every new vertex interpolates the velocity and force of its
+    // source vertices; the total mass is kept and redistributed by lumped vertex area
+    void applyMeshChanges(const MeshRemesher::Changes& changes);
+
+    // Edge coloring of the current mesh topology, for per-edge force kernels run in parallel
+    std::shared_ptr<const EdgeColoring> getOrCreateEdgeColoring();
+    // Per-edge force kernels run by edge color on all cores from this many edges on (0: never) and
+    // serially in edge order below it. Either way the result does not depend on the thread count.
+    void setParallelEdgeThreshold(uint32_t nEdges) { m_nParallelEdgeThreshold = nEdges; }
+    uint32_t getParallelEdgeThreshold() const { return m_nParallelEdgeThreshold; }
+
+    // Call kernel(edgeIndices) for batches of edges covering every edge of the mesh once. Large meshes
+    // are processed color by color, the batches of a color split between threads: no two edges of a
+    // color share a vertex, so kernels may add to both endpoints, and every vertex sums its
+    // contributions in color order.
+    template <class Kernel>
+    void forEachEdgeBatch(const Kernel& kernel);
 
 private:
-    std::vector<PhysVertex> m_nodeData;
+    static const uint32_t EDGE_BATCH_SIZE = 1024;
+
+    VectorArray3 m_velocities;
+    VectorArray3 m_forces;
+    std::vector<PhysicsPrecision::State> m_masses;
+    std::shared_ptr<EdgeColoring> m_pEdgeColoring;
+    uint32_t m_nParallelEdgeThreshold = 8192;
+    std::vector<uint32_t> m_edgeOrder;  // 0, 1, 2, ... for the serial path
 };
 
+template <class Kernel>
+void PhysicsMesh::forEachEdgeBatch(const Kernel& kernel)
+{
+    auto pColoring = getOrCreateEdgeColoring();
+    const uint32_t edgeCount = pColoring->getEdgeCount();
+    if (m_nParallelEdgeThreshold == 0 || edgeCount < m_nParallelEdgeThreshold)
+    {
+        if (m_edgeOrder.size() != edgeCount)
+        {
+            m_edgeOrder.resize(edgeCount);
+            for (uint32_t e = 0; e < edgeCount; ++e)
+                m_edgeOrder[e] = e;
+        }
+        kernel(std::span<const uint32_t>(m_edgeOrder));
+        return;
+    }
+
+    WorkerPool& pool = WorkerPool::instance();
+    for (uint32_t color = 0; color < pColoring->getColorCount(); ++color)
+    {
+        const std::span<const uint32_t> colorEdges = pColoring->getColorEdges(color);
+        pool.parallelFor(static_cast<uint32_t>(colorEdges.size()), EDGE_BATCH_SIZE, [&](uint32_t uBegin, uint32_t uEnd)
+        {
+            kernel(colorEdges.subspan(uBegin, uEnd - uBegin));
+        });
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "geometry/vectors/simd4.h"
+
+// Precision policies of the physics state. A policy names the scalar the per-vertex velocities,
+// forces and masses of PhysicsMesh are stored in (State) and the scalar the edge force and
+// integration kernels compute in (Compute, with Compute4 four lanes of it). Positions stay float3
+// in Vertices under every policy; the centrosomes and the implicit solver always use double.
+struct DoublePrecision
+{
+    using State = double;
+    using Compute = double;
+    using Compute4 = simd4d;
+};
+
+// Half the memory traffic of the state arrays, arithmetic in double
+struct MixedPrecision
+{
+    using State = float;
+    using Compute = double;
+    using Compute4 = simd4d;
+};
+
+// float throughout: also twice the lanes per register in the edge force kernel
+struct FloatPrecision
+{
+    using State = float;
+    using Compute = float;
+    using Compute4 = simd4f;
+};
+
+// Build option: define PHYSICS_PRECISION_MIXED or PHYSICS_PRECISION_FLOAT for the whole build to
+// trade accuracy for bandwidth; the default is double. tests/physicsPrecision compares the
+// trajectories of the build against double.
+#if defined(PHYSICS_PRECISION_FLOAT)
+using PhysicsPrecision = FloatPrecision;
+#elif defined(PHYSICS_PRECISION_MIXED)
+using PhysicsPrecision = MixedPrecision;
+#else
+using PhysicsPrecision = DoublePrecision;
+#endif
@@ -0,0 +1,321 @@
+#include "ShapeConstraints.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include "geometry/mesh/Edges.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+    const uint32_t INVALID = Edges::INVALID_INDEX;
+
+    inline double inverseMass(const PhysicsMesh& body, uint32_t i)
+    {
+        return 1.0 / std::max(1e-12, body.getMass(i));
+    }
+
+    inline double3 getPosition(const Vertices& vertices, uint32_t i)
+    {
+        return double3(vertices.getVertexPosition(i));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Edge length
+
+EdgeLengthConstraintXPBD::EdgeLengthConstraintXPBD(PhysicsMesh& body, double compliance)
+    : m_body(body)
+    , m_compliance(compliance)
+{
+    auto pEdges = m_body.m_pMesh->getOrCreateEdges();
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    m_restLengths.resize(pEdges->getEdgeCount());
+    for (uint32_t e = 0; e < pEdges->getEdgeCount(); ++e)
+    {
+        auto ab = pEdges->getEdge(e);
+        m_restLengths[e] = length(getPosition(vertices, ab.second) - getPosition(vertices, ab.first));
+    }
+}
+
+void EdgeLengthConstraintXPBD::beginStep()
+{
+    m_lambdas.assign(m_restLengths.size(), 0.0);
+}
+
+void EdgeLengthConstraintXPBD::project(double dt)
+{
+    if (dt <= 0.0) return;
+    auto pEdges = m_body.m_pMesh->getOrCreateEdges();
+    if (m_lambdas.size() != m_restLengths.size())
+        beginStep();
+
+    const double alphaTilde = m_compliance / (dt * dt);
+    Vertices& vertices = *m_body.m_pMesh->getVertices();
+    Vertices::PositionUpdate update(vertices);
+    for (uint32_t e = 0; e < pEdges->getEdgeCount(); ++e)
+    {
+        auto ab = pEdges->getEdge(e);
+        const double3 pa = getPosition(vertices, ab.first);
+        const double3 pb = getPosition(vertices, ab.second);
+        const double3 edgeVec = pb - pa;
+        const double L = length(edgeVec);
+        if (L <= 1e-10) continue;
+        const double3 n = edgeVec / L;
+
+        // C = L - L0, grad_a C = -n, grad_b C = n
+        const double wa = inverseMass(m_body, ab.first), wb = inverseMass(m_body, ab.second);
+        const double C = L - m_restLengths[e];
+        const double deltaLambda = (C - alphaTilde * m_lambdas[e]) / (wa + wb + alphaTilde);
+        m_lambdas[e] += deltaLambda;
+        update.set(ab.first, float3(pa + wa * deltaLambda * n));
+        update.set(ab.second, float3(pb - wb * deltaLambda * n));
+    }
+}
+
+void EdgeLengthConstraintXPBD::onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes)
+{
+    if (&body != &m_body || changes.isEmpty()) return;
+
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    auto pEdges = m_body.m_pMesh->getOrCreateEdges();
+    std::vector<double> restLengths(pEdges->getEdgeCount());
+    for (uint32_t e = 0; e < pEdges->getEdgeCount(); ++e)
+    {
+        auto ab = pEdges->getEdge(e);
+        const double L = length(getPosition(vertices, ab.second) - getPosition(vertices, ab.first));
+        restLengths[e] = L;
+
+        const uint32_t oldEdge = changes.findOldEdge(ab.first, ab.second);
+        if (oldEdge == INVALID) continue;
+        auto oldAB = changes.m_pOldEdges->getEdge(oldEdge);
+        const double oldL = length(getPosition(vertices, changes.m_newVertexIndex[oldAB.second])
+                                 - getPosition(vertices, changes.m_newVertexIndex[oldAB.first]));
+        if (oldL > 1e-10)
+            restLengths[e] = m_restLengths[oldEdge] * L / oldL;
+    }
+    m_restLengths = std::move(restLengths);
+    m_lambdas.clear();
+}
+
+// ---------------------------------------------------------------------------------------------
+// Bending
+
+BendingConstraintXPBD::BendingConstraintXPBD(PhysicsMesh& body, double compliance)
+    : m_body(body)
+    , m_compliance(compliance)
+{
+    buildWings();
+    m_restAngles.resize(m_wingA.size());
+    for (uint32_t e = 0; e < m_wingA.size(); ++e)
+        m_restAngles[e] = computeAngle(e);
+}
+
+double BendingConstraintXPBD::computeDihedralAngle(const double3& p0, const double3& p1, const double3& p2, const double3& p3,
+                                                   double3* pGradients)
+{
+    const double3 e = p1 - p0;
+    const double L = length(e);
+    const double3 n1 = cross(e, p2 - p0);
+    const double3 n2 = cross(p3 - p0, e);
+    const double n1Sq = dot(n1, n1), n2Sq = dot(n2, n2);
+    if (L <= 1e-10 || n1Sq <= 1e-20 || n2Sq <= 1e-20)
+    {
+        if (pGradients)
+            pGradients[0] = pGradients[1] = pGradients[2] = pGradients[3] = double3(0, 0, 0);
+        return 0.0;
+    }
+    const double angle = std::atan2(dot(cross(n2, n1), e) / L, dot(n1, n2));
+    if (pGradients)
+    {
+        // Wings move the angle along their triangle normals; the hinge vertices take the opposite
+        // of that, split by where the wings project onto the hinge
+        const double3 g2 = (L / n1Sq) * n1;
+        const double3 g3 = (L / n2Sq) * n2;
+        const double t2 = dot(p2 - p0, e) / (L * L);
+        const double t3 = dot(p3 - p0, e) / (L * L);
+        pGradients[0] = -(1.0 - t2) * g2 - (1.0 - t3) * g3;
+        pGradients[1] = -t2 * g2 - t3 * g3;
+        pGradients[2] = g2;
+        pGradients[3] = g3;
+    }
+    return angle;
+}
+
+void BendingConstraintXPBD::buildWings()
+{
+    const TriangleMesh& mesh = *m_body.m_pMesh;
+    auto pEdges = mesh.getOrCreateEdges();
+    const uint32_t edgeCount = pEdges->getEdgeCount();
+    m_wingA.assign(edgeCount, INVALID);
+    m_wingB.assign(edgeCount, INVALID);
+    for (uint32_t e = 0; e < edgeCount; ++e)
+    {
+        const std::span<const uint32_t> triangles = pEdges->getEdgeTriangles(e);
+        if (triangles.size() != 2) continue;
+        auto ab = pEdges->getEdge(e);
+        uint32_t wings[2];
+        for (uint32_t k = 0; k < 2; ++k)
+        {
+            const uint3 tri = mesh.getTriangleVertices(triangles[k]);
+            wings[k] = (tri.x != ab.first && tri.x != ab.second) ? tri.x
+                     : (tri.y != ab.first && tri.y != ab.second) ? tri.y : tri.z;
+        }
+        m_wingA[e] = wings[0];
+        m_wingB[e] = wings[1];
+    }
+}
+
+double BendingConstraintXPBD::computeAngle(uint32_t e) const
+{
+    if (m_wingA[e] == INVALID) return 0.0;
+    auto pEdges = m_body.m_pMesh->getOrCreateEdges();
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    auto ab = pEdges->getEdge(e);
+    return computeDihedralAngle(getPosition(vertices, ab.first), getPosition(vertices, ab.second),
+                                getPosition(vertices, m_wingA[e]), getPosition(vertices, m_wingB[e]));
+}
+
+void BendingConstraintXPBD::beginStep()
+{
+    m_lambdas.assign(m_restAngles.size(), 0.0);
+}
+
+void BendingConstraintXPBD::project(double dt)
+{
+    if (dt <= 0.0) return;
+    auto pEdges = m_body.m_pMesh->getOrCreateEdges();
+    if (m_lambdas.size() != m_restAngles.size())
+        beginStep();
+
+    const double alphaTilde = m_compliance / (dt * dt);
+    Vertices& vertices = *m_body.m_pMesh->getVertices();
+    Vertices::PositionUpdate update(vertices);
+    for (uint32_t e = 0; e < m_restAngles.size(); ++e)
+    {
+        if (m_wingA[e] == INVALID) continue;
+        auto ab = pEdges->getEdge(e);
+        const uint32_t indices[4] = { ab.first, ab.second, m_wingA[e], m_wingB[e] };
+        double3 p[4], gradients[4];
+        for (uint32_t k = 0; k < 4; ++k)
+            p[k] = getPosition(vertices, indices[k]);
+        const double angle = computeDihedralAngle(p[0], p[1], p[2], p[3], gradients);
+
+        double C = angle - m_restAngles[e];
+        if (C > PI) C -= 2.0 * PI;
+        if (C < -PI) C += 2.0 * PI;
+        double denom = alphaTilde;
+        for (uint32_t k = 0; k < 4; ++k)
+            denom += inverseMass(m_body, indices[k]) * dot(gradients[k], gradients[k]);
+        if (denom <= 1e-20) continue;
+
+        const double deltaLambda = (C - alphaTilde * m_lambdas[e]) / denom;
+        m_lambdas[e] += deltaLambda;
+        for (uint32_t k = 0; k < 4; ++k)
+            update.set(indices[k], float3(p[k] - inverseMass(m_body, indices[k]) * deltaLambda * gradients[k]));
+    }
+}
+
+void BendingConstraintXPBD::onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes)
+{
+    if (&body != &m_body || changes.isEmpty()) return;
+
+    const std::vector<double> oldRestAngles = std::move(m_restAngles);
+    buildWings();
+    auto pEdges = m_body.m_pMesh->getOrCreateEdges();
+    m_restAngles.resize(m_wingA.size());
+    for (uint32_t e = 0; e < m_wingA.size(); ++e)
+    {
+        m_restAngles[e] = computeAngle(e);
+        auto ab = pEdges->getEdge(e);
+        const uint32_t oldEdge = changes.findOldEdge(ab.first, ab.second);
+        if (oldEdge == INVALID) continue;
+        // Only a whole old edge still has the same hinge
+        auto oldAB = changes.m_pOldEdges->getEdge(oldEdge);
+        const uint32_t newA = changes.m_newVertexIndex[oldAB.first], newB = changes.m_newVertexIndex[oldAB.second];
+        if (std::min(newA, newB) == ab.first && std::max(newA, newB) == ab.second)
+            m_restAngles[e] = oldRestAngles[oldEdge];
+    }
+    m_lambdas.clear();
+}
+
+// ---------------------------------------------------------------------------------------------
+// Triangle area
+
+TriangleAreaConstraintXPBD::TriangleAreaConstraintXPBD(PhysicsMesh& body, double compliance)
+    : m_body(body)
+    , m_compliance(compliance)
+{
+    m_restAreas.resize(m_body.m_pMesh->getTriangleCount());
+    for (uint32_t t = 0; t < m_restAreas.size(); ++t)
+        m_restAreas[t] = computeArea(t);
+}
+
+double TriangleAreaConstraintXPBD::computeArea(uint32_t t) const
+{
+    const Vertices& vertices = *m_body.m_pMesh->getVertices();
+    const uint3 tri = m_body.m_pMesh->getTriangleVertices(t);
+    const double3 a = getPosition(vertices, tri.x);
+    return 0.5 * length(cross(getPosition(vertices, tri.y) - a, getPosition(vertices, tri.z) - a));
+}
+
+void TriangleAreaConstraintXPBD::beginStep()
+{
+    m_lambdas.assign(m_restAreas.size(), 0.0);
+}
+
+void TriangleAreaConstraintXPBD::project(double dt)
+{
+    if (dt <= 0.0) return;
+    if (m_lambdas.size() != m_restAreas.size())
+        beginStep();
+
+    const double alphaTilde = m_compliance / (dt * dt);
+    Vertices& vertices = *m_body.m_pMesh->getVertices();
+    Vertices::PositionUpdate update(vertices);
+    for (uint32_t t = 0; t < m_restAreas.size(); ++t)
+    {
+        const uint3 tri = m_body.m_pMesh->getTriangleVertices(t);
+        const double3 a = getPosition(vertices, tri.x);
+        const double3 b = getPosition(vertices, tri.y);
+        const double3 c = getPosition(vertices, tri.z);
+        const double3 normal = cross(b - a, c - a);
+        const double twiceArea = length(normal);
+        if (twiceArea <= 1e-20) continue;
+        const double3 n = normal / twiceArea;
+
+        // dA/da = (b - c) x n / 2, and cyclically
+        const double3 ga = 0.5 * cross(b - c, n);
+        const double3 gb = 0.5 * cross(c - a, n);
+        const double3 gc = 0.5 * cross(a - b, n);
+        const double wa = inverseMass(m_body, tri.x), wb = inverseMass(m_body, tri.y), wc = inverseMass(m_body, tri.z);
+        const double denom = wa * dot(ga, ga) + wb * dot(gb, gb) + wc * dot(gc, gc) + alphaTilde;
+        if (denom <= 1e-20) continue;
+
+        const double C = 0.5 * twiceArea - m_restAreas[t];
+        const double deltaLambda = (C - alphaTilde * m_lambdas[t]) / denom;
+        m_lambdas[t] += deltaLambda;
+        update.set(tri.x, float3(a - wa * deltaLambda * ga));
+        update.set(tri.y, float3(b - wb * deltaLambda * gb));
+        update.set(tri.z, float3(c - wc * deltaLambda * gc));
+    }
+}
+
+void TriangleAreaConstraintXPBD::onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes)
+{
+    if (&body != &m_body || changes.isEmpty()) return;
+
+    std::vector<double> restAreas(m_body.m_pMesh->getTriangleCount(), -1.0);
+    for (uint32_t t = 0; t < changes.m_newTriangleIndex.size(); ++t)
+    {
+        const uint32_t newTriangle = changes.m_newTriangleIndex[t];
+        if (newTriangle != TriangleMesh::INVALID_INDEX && t < m_restAreas.size())
+            restAreas[newTriangle] = m_restAreas[t];
+    }
+    for (uint32_t t = 0; t < restAreas.size(); ++t)
+    {
+        if (restAreas[t] < 0.0)
+            restAreas[t] = computeArea(t);
+    }
+    m_restAreas = std::move(restAreas);
+    m_lambdas.clear();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include "PhysicsMesh.h"
+#include "PhysicsConstraints.h"
+
+// XPBD constraints holding the shape of a surface mesh at its state at construction: edge lengths,
+// dihedral angles across edges and triangle areas. Every constraint has its own multiplier, and
+// the constraints of one object are projected one after the other (Gauss-Seidel) in index order.
+// Compliance is in units of 1/stiffness; 0 makes a constraint hard.
+
+class EdgeLengthConstraintXPBD : public IConstraint
+{
+public:
+    EdgeLengthConstraintXPBD(PhysicsMesh& body, double compliance = 0.0);
+
+    void setCompliance(double c) { m_compliance = c; }
+    double getCompliance() const { return m_compliance; }
+    const std::vector<double>& getRestLengths() const { return m_restLengths; }
+
+    void beginStep() override;
+    void project(double dt) override;
+    // Surviving and split edges keep the strain of their old edge, other new edges start at rest
+    void onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes) override;
+
+private:
+    PhysicsMesh& m_body;
+    double m_compliance;
+    std::vector<double> m_restLengths;
+    std::vector<double> m_lambdas;
+};
+
+// Signed dihedral angle across every edge with two adjacent triangles
+class BendingConstraintXPBD : public IConstraint
+{
+public:
+    BendingConstraintXPBD(PhysicsMesh& body, double compliance = 0.0);
+
+    void setCompliance(double c) { m_compliance = c; }
+    double getCompliance() const { return m_compliance; }
+
+    void beginStep() override;
+    void project(double dt) override;
+    // Edges that survive unsplit keep their rest angle, all others start at rest
+    void onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes) override;
+
+    // Dihedral angle across edge (p0, p1) between the triangles (p0, p1, p2) and (p1, p0, p3); 0 when
+    // flat, positive when p3 lies on the side the normal of the first triangle points to. The gradients
+    // with respect to p0..p3 are written to pGradients if it is not null.
+    static double computeDihedralAngle(const double3& p0, const double3& p1, const double3& p2, const double3& p3,
+                                       double3* pGradients = nullptr);
+
+private:
+    PhysicsMesh& m_body;
+    double m_compliance;
+    // Per edge: vertices opposite to it in its two triangles (INVALID_INDEX on open edges)
+    std::vector<uint32_t> m_wingA, m_wingB;
+    std::vector<double> m_restAngles;
+    std::vector<double> m_lambdas;
+
+    void buildWings();
+    double computeAngle(uint32_t e) const;
+};
+
+class TriangleAreaConstraintXPBD : public IConstraint
+{
+public:
+    TriangleAreaConstraintXPBD(PhysicsMesh& body, double compliance = 0.0);
+
+    void setCompliance(double c) { m_compliance = c; }
+    double getCompliance() const { return m_compliance; }
+    const std::vector<double>& getRestAreas() const { return m_restAreas; }
+
+    void beginStep() override;
+    void project(double dt) override;
+    // Unchanged triangles keep their rest area, new ones start at rest
+    void onMeshChanged(const PhysicsMesh& body, const MeshRemesher::Changes& changes) override;
+
+private:
+    PhysicsMesh& m_body;
+    double m_compliance;
+    std::vector<double> m_restAreas;
+    std::vector<double> m_lambdas;
+
+    double computeArea(uint32_t t) const;
+};
@@ -0,0 +1,30 @@
+#include "StepSizeController.h"
+#include <algorithm>
+#include <cmath>
+
+void StepSizeController::setDt(double fDt)
+{
+    m_fDt = std::clamp(fDt, m_settings.m_fMinDt, m_settings.m_fMaxDt);
+}
+
+double StepSizeController::proposeDt(double fRemaining) const
+{
+    if (m_fDt <= 0.0)
+        return std::min(fRemaining, m_settings.m_fMaxDt);
+    // Stretch the step over a leftover that would be much shorter than the step itself
+    return (fRemaining < 1.25 * m_fDt) ? fRemaining : m_fDt;
+}
+
+bool StepSizeController::update(double fDt, double fErrorRatio, uint32_t order)
+{
+    const bool bAccepted = (fErrorRatio <= 1.0) || (fDt <= m_settings.m_fMinDt);
+    double fFactor = m_settings.m_fMaxGrowth;
+    if (fErrorRatio > 0.0)
+        fFactor = m_settings.m_fSafety * std::pow(fErrorRatio, -1.0 / (order + 1));
+    fFactor = std::clamp(fFactor, m_settings.m_fMaxShrink, m_settings.m_fMaxGrowth);
+    // A rejected step must get smaller even if the estimate says otherwise
+    if (!bAccepted)
+        fFactor = std::min(fFactor, 0.5);
+    setDt(fDt * fFactor);
+    return bAccepted;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Step size control from local error estimates. The caller takes a step of size fDt, estimates its
+// error and reports the ratio error / tolerance: the step is accepted if the ratio is at most 1, and
+// either way the next size becomes fDt * safety * ratio^(-1 / (order + 1)) for a method whose local
+// error grows as fDt^(order + 1), limited in growth and shrinkage and clamped to [min, max].
+class StepSizeController
+{
+public:
+    struct Settings
+    {
+        double m_fMinDt = 1e-6;
+        double m_fMaxDt = 1.0;
+        double m_fSafety = 0.9;
+        double m_fMaxGrowth = 2.0;      // largest factor between consecutive sizes
+        double m_fMaxShrink = 0.2;      // smallest factor between consecutive sizes
+    };
+
+    StepSizeController() = default;
+    explicit StepSizeController(const Settings& settings) : m_settings(settings) {}
+
+    const Settings& getSettings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+
+    // Size for the next step; 0 until the first update() or setDt()
+    double getDt() const { return m_fDt; }
+    void setDt(double fDt);
+
+    // Next size no longer than fRemaining, the first one fRemaining itself
+    double proposeDt(double fRemaining) const;
+
+    // Report a step of size fDt with the given error ratio. Returns false if it has to be redone
+    // (with getDt()); steps at the minimum size are always accepted.
+    bool update(double fDt, double fErrorRatio, uint32_t order);
+
+private:
+    Settings m_settings;
+    double m_fDt = 0.0;
+};
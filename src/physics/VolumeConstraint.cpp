@@ -17,39 +17,50 @@ double VolumeConstraintXPBD::computeSignedVolume() const
     return V;
 }
 
-void VolumeConstraintXPBD::project(double dt)
+void VolumeConstraintXPBD::updateVolumeAndGradient()
 {
-    const uint32_t faceCount = m_body.m_pMesh->getTriangleCount();
-    if (faceCount == 0 || dt <= 0.0)
+    const TriangleMesh& mesh = *m_body.m_pMesh;
+    const Vertices& vertices = *mesh.getVertices();
+    if (m_gradientVersion == mesh.getVersion() && m_gradient.size() == vertices.getVertexCount())
         return;
 
-    // Accumulate per-vertex gradients dV/dx
-    const uint32_t n = m_body.m_pMesh->getVertices()->getVertexCount();
-    std::vector<double3> grad(n, double3(0,0,0));
-
-    for (uint32_t f = 0; f < faceCount; ++f)
+    m_gradient.assign(vertices.getVertexCount(), double3(0, 0, 0));
+    double V = 0.0;
+    for (uint32_t f = 0; f < mesh.getTriangleCount(); ++f)
     {
-        uint3 tri = m_body.m_pMesh->getTriangleVertices(f);
-        uint32_t ia = tri.x, ib = tri.y, ic = tri.z;
-        double3 a = double3(m_body.m_pMesh->getVertices()->getVertexPosition(ia));
-        double3 b = double3(m_body.m_pMesh->getVertices()->getVertexPosition(ib));
-        double3 c = double3(m_body.m_pMesh->getVertices()->getVertexPosition(ic));
+        uint3 tri = mesh.getTriangleVertices(f);
+        double3 a = double3(vertices.getVertexPosition(tri.x));
+        double3 b = double3(vertices.getVertexPosition(tri.y));
+        double3 c = double3(vertices.getVertexPosition(tri.z));
         // dV/da = (1/6) (b x c), etc.
-        grad[ia] += (1.0/6.0) * cross(b, c);
-        grad[ib] += (1.0/6.0) * cross(c, a);
-        grad[ic] += (1.0/6.0) * cross(a, b);
+        const double3 bc = cross(b, c);
+        V += (1.0/6.0) * dot(a, bc);
+        m_gradient[tri.x] += (1.0/6.0) * bc;
+        m_gradient[tri.y] += (1.0/6.0) * cross(c, a);
+        m_gradient[tri.z] += (1.0/6.0) * cross(a, b);
     }
+    m_volume = V;
+    m_gradientVersion = mesh.getVersion();
+}
+
+void VolumeConstraintXPBD::project(double dt)
+{
+    const uint32_t faceCount = m_body.m_pMesh->getTriangleCount();
+    if (faceCount == 0 || dt <= 0.0)
+        return;
+
+    updateVolumeAndGradient();
+    const uint32_t n = static_cast<uint32_t>(m_gradient.size());
 
     // Compute constraint value C(x) = V(x) - V_target
-    const double V = computeSignedVolume();
-    const double C = V - m_targetVolume;
+    const double C = m_volume - m_targetVolume;
 
     // Compute denominator sum w_i |grad_i|^2
     double denom = 0.0;
     for (uint32_t i = 0; i < n; ++i)
     {
-        const double wi = 1.0 / std::max(1e-12, m_body.getVertex(i).m_fMass);
-        denom += wi * dot(grad[i], grad[i]);
+        const double wi = 1.0 / std::max(1e-12, m_body.getMass(i));
+        denom += wi * dot(m_gradient[i], m_gradient[i]);
     }
     if (denom <= 1e-20)
         return;
@@ -60,15 +71,15 @@ void VolumeConstraintXPBD::project(double dt)
     const double deltaLambda = (C - alphaTilde * m_lambda) / (denom + alphaTilde);
     m_lambda += deltaLambda;
 
-    // Apply position corrections and velocity update
+    // Apply position corrections as one bulk update
+    Vertices& vertices = *m_body.m_pMesh->getVertices();
+    Vertices::PositionUpdate update(vertices);
     for (uint32_t i = 0; i < n; ++i)
     {
-        const double wi = 1.0 / std::max(1e-12, m_body.getVertex(i).m_fMass);
-        const double3 dx = -wi * deltaLambda * grad[i];
-        const double3 xOld = double3(m_body.m_pMesh->getVertices()->getVertexPosition(i));
+        const double wi = 1.0 / std::max(1e-12, m_body.getMass(i));
+        const double3 dx = -wi * deltaLambda * m_gradient[i];
+        const double3 xOld = double3(vertices.getVertexPosition(i));
         const double3 xNew = xOld + dx;
-        m_body.m_pMesh->getVertices()->setVertexPosition(i, float3(xNew));
+        update.set(i, float3(xNew));
     }
 }
-
-
@@ -22,6 +22,7 @@ public:
     void setCompliance(double c) { m_compliance = c; }
     double getCompliance() const { return m_compliance; }
 
+    void beginStep() override { m_lambda = 0.0; }
     // Project positions to satisfy volume constraint (soft if compliance > 0)
     void project(double dt) override;
 
@@ -33,6 +34,14 @@ private:
     double m_targetVolume;
     double m_compliance;      // XPBD compliance (0 for hard), in units of 1/stiffness
     double m_lambda;          // XPBD Lagrange multiplier accumulator
+
+    // Volume and per-vertex gradient dV/dx, computed together in one pass over the faces and
+    // reused until the positions change
+    double m_volume = 0.0;
+    std::vector<double3> m_gradient;
+    uint64_t m_gradientVersion = UINT64_MAX;
+
+    void updateVolumeAndGradient();
 };
 
 
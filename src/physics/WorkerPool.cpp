@@ -0,0 +1,92 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool& WorkerPool::instance()
+{
+    static WorkerPool s_pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return s_pool;
+}
+
+WorkerPool::WorkerPool(uint32_t nWorkers)
+{
+    m_workers.reserve(nWorkers);
+    for (uint32_t i = 0; i < nWorkers; ++i)
+    {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkerPool::parallelFor(uint32_t n, uint32_t nChunkSize, const std::function<void(uint32_t, uint32_t)>& body)
+{
+    if (n == 0)
+        return;
+    nChunkSize = std::max(1u, nChunkSize);
+    const uint32_t nChunks = (n - 1) / nChunkSize + 1;
+    if (m_workers.empty() || nChunks == 1)
+    {
+        Job job{ &body, n, nChunkSize, nChunks };
+        runChunks(job);
+        return;
+    }
+
+    std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+    Job job{ &body, n, nChunkSize, nChunks };
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pJob = &job;
+        ++m_generation;
+        m_nBusyWorkers = static_cast<uint32_t>(m_workers.size());
+    }
+    m_wake.notify_all();
+    runChunks(job);
+
+    // Every worker must have let go of the job before it leaves this stack frame
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_nBusyWorkers == 0; });
+    m_pJob = nullptr;
+}
+
+void WorkerPool::workerLoop()
+{
+    uint64_t seenGeneration = 0;
+    for (;;)
+    {
+        Job* pJob = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_bStop || m_generation != seenGeneration; });
+            if (m_bStop)
+                return;
+            seenGeneration = m_generation;
+            pJob = m_pJob;
+        }
+        runChunks(*pJob);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_nBusyWorkers == 0)
+                m_done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runChunks(Job& job)
+{
+    for (uint32_t chunk = job.m_nextChunk.fetch_add(1); chunk < job.m_nChunks; chunk = job.m_nextChunk.fetch_add(1))
+    {
+        const uint32_t uBegin = chunk * job.m_nChunkSize;
+        (*job.m_pBody)(uBegin, std::min(job.m_n, uBegin + job.m_nChunkSize));
+    }
+}
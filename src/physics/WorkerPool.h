@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// Persistent worker threads for data-parallel loops of the physics step. parallelFor() splits a
+// range into fixed-size chunks that the calling thread and the workers take in turn, and returns
+// once every chunk is done. Chunks may run on any thread in any order, so loop bodies must write
+// disjoint data. Calls from several threads are serialized; a loop body must not call parallelFor().
+class WorkerPool
+{
+public:
+    // Shared pool with one worker less than the hardware threads (the caller is the remaining one)
+    static WorkerPool& instance();
+
+    explicit WorkerPool(uint32_t nWorkers);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+    // Call body(uBegin, uEnd) for the chunks [k * nChunkSize, min(n, (k + 1) * nChunkSize)) of [0, n)
+    void parallelFor(uint32_t n, uint32_t nChunkSize, const std::function<void(uint32_t, uint32_t)>& body);
+
+private:
+    struct Job
+    {
+        const std::function<void(uint32_t, uint32_t)>* m_pBody;
+        uint32_t m_n;
+        uint32_t m_nChunkSize;
+        uint32_t m_nChunks;
+        std::atomic<uint32_t> m_nextChunk{ 0 };
+    };
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_dispatchMutex;          // one parallelFor() at a time
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    Job* m_pJob = nullptr;
+    uint64_t m_generation = 0;
+    uint32_t m_nBusyWorkers = 0;         // workers that have not finished the current job yet
+    bool m_bStop = false;
+
+    void workerLoop();
+    static void runChunks(Job& job);
+};
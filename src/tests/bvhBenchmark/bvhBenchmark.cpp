@@ -0,0 +1,82 @@
+#include "geometry/geomHelpers/BVHBenchmark.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+// Runs the BVHBenchmark suites and prints their tables: builder configurations, BVHCache lookup
+// contention and the query cost per level of detail. Timings are for reading, not checked; the
+// run fails only if a result is inconsistent (a parallel build that differs from the serial one,
+// or coarser levels that approximate the surface better than finer ones).
+
+namespace
+{
+    const uint32_t BUILD_SUBDIVISION_LEVEL = 6;
+    const uint32_t LOD_SUBDIVISION_LEVEL = 5;
+
+    const char* getStrategyName(BVH::BuildStrategy strategy)
+    {
+        return strategy == BVH::BuildStrategy::BINNED_SAH ? "binned SAH" : "median";
+    }
+
+    bool runBuilds()
+    {
+        printf("Builds over a deformed sphere of subdivision level %u\n", BUILD_SUBDIVISION_LEVEL);
+        printf("%-12s %-10s %10s %12s %14s %10s\n", "strategy", "build", "triangles", "build (ms)", "trace (ns/ray)", "SAH cost");
+        bool bPassed = true;
+        for (BVH::BuildStrategy strategy : { BVH::BuildStrategy::BINNED_SAH, BVH::BuildStrategy::MEDIAN })
+        {
+            float fSerialCost = 0.0f;
+            for (uint32_t nThreshold : { 0u, 4096u })
+            {
+                const BVHBenchmark::Result result = BVHBenchmark::run(BUILD_SUBDIVISION_LEVEL, strategy, nThreshold);
+                printf("%-12s %-10s %10u %12.2f %14.1f %10.2f\n", getStrategyName(strategy), nThreshold ? "parallel" : "serial",
+                       result.m_nTriangles, result.m_fBuildMs, result.m_fTraceNsPerRay, result.m_fSAHCost);
+                if (nThreshold == 0)
+                    fSerialCost = result.m_fSAHCost;
+                else if (result.m_fSAHCost != fSerialCost)
+                {
+                    printf("FAILED: the parallel %s build differs from the serial one\n", getStrategyName(strategy));
+                    bPassed = false;
+                }
+            }
+        }
+        return bPassed;
+    }
+
+    void runCacheContention()
+    {
+        printf("\nBVHCache::getOrCreate() of an unchanged mesh\n");
+        printf("%-8s %14s\n", "threads", "ns per lookup");
+        const uint32_t nMaxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t nThreads = 1; nThreads <= nMaxThreads; nThreads *= 2)
+            printf("%-8u %14.1f\n", nThreads, BVHBenchmark::runCacheContention(nThreads));
+    }
+
+    bool runLevelOfDetail()
+    {
+        printf("\nLevels of a deformed sphere of subdivision level %u, coarsest first\n", LOD_SUBDIVISION_LEVEL);
+        printf("%-6s %10s %10s %14s %18s\n", "level", "triangles", "error", "trace (ns/ray)", "distance (ns/query)");
+        bool bPassed = true;
+        const std::vector<BVHBenchmark::LevelResult> results = BVHBenchmark::runLevelOfDetail(LOD_SUBDIVISION_LEVEL);
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BVHBenchmark::LevelResult& result = results[i];
+            printf("%-6u %10u %10.4f %14.1f %18.1f\n", result.m_uLevel, result.m_nTriangles, result.m_fApproximationError,
+                   result.m_fTraceNsPerRay, result.m_fSignedDistanceNsPerQuery);
+            if (i > 0 && result.m_fApproximationError > results[i - 1].m_fApproximationError)
+            {
+                printf("FAILED: level %u approximates the surface worse than the coarser level before it\n", result.m_uLevel);
+                bPassed = false;
+            }
+        }
+        return bPassed;
+    }
+}
+
+int main()
+{
+    bool bPassed = runBuilds();
+    runCacheContention();
+    bPassed = runLevelOfDetail() && bPassed;
+    return bPassed ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#include "physics/IntegratorBenchmark.h"
+#include <cstdio>
+
+// Runs IntegratorBenchmark over a range of time steps and prints stability, energy and cost of
+// both schemes. Timings are for reading, not checked. The run fails if implicit Euler goes
+// unstable or gains energy at any of the time steps, or if semi-implicit Euler does so at the
+// smallest one, which is well inside its stability limit for these springs.
+
+namespace
+{
+    const uint32_t SPHERE_SUBDIVISION_LEVEL = 3;
+    const double SPRING_CONSTANT = 100.0;
+    const double DAMPING_COEFF = 1.0;
+    const double SIMULATED_TIME = 1.0;
+
+    const char* getSchemeName(PhysicsIntegrator::Scheme scheme)
+    {
+        return scheme == PhysicsIntegrator::Scheme::IMPLICIT_EULER ? "implicit" : "semi-implicit";
+    }
+}
+
+int main()
+{
+    const std::vector<double> timeSteps = { 0.001, 0.01, 0.05, 0.1 };
+    const std::vector<IntegratorBenchmark::Result> results = IntegratorBenchmark::run(SPHERE_SUBDIVISION_LEVEL,
+        SPRING_CONSTANT, DAMPING_COEFF, timeSteps, SIMULATED_TIME);
+
+    printf("Sphere of subdivision level %u, k = %g, damping %g, %g s simulated\n", SPHERE_SUBDIVISION_LEVEL,
+           SPRING_CONSTANT, DAMPING_COEFF, SIMULATED_TIME);
+    printf("%-14s %8s %7s %12s %11s %13s %11s\n", "scheme", "dt", "steps", "ms per step", "iterations",
+           "final energy", "max energy");
+    bool bPassed = true;
+    for (const IntegratorBenchmark::Result& result : results)
+    {
+        printf("%-14s %8g %7u %12.3f %11.2f %13.4f %11.4f %s\n", getSchemeName(result.m_scheme), result.m_fDt,
+               result.m_nSteps, result.m_fMsPerStep, result.m_fAverageSolverIterations, result.m_fFinalEnergyRatio,
+               result.m_fMaxEnergyRatio, result.m_bStable ? "" : "UNSTABLE");
+
+        const bool bMustBeStable = result.m_scheme == PhysicsIntegrator::Scheme::IMPLICIT_EULER
+                                || result.m_fDt == timeSteps.front();
+        if (bMustBeStable && (!result.m_bStable || result.m_fFinalEnergyRatio > 1.0))
+        {
+            printf("FAILED: %s Euler at dt = %g must be stable and dissipate energy\n", getSchemeName(result.m_scheme),
+                   result.m_fDt);
+            bPassed = false;
+        }
+    }
+    return bPassed ? 0 : 1;
+}
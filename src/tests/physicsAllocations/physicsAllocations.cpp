@@ -0,0 +1,207 @@
+#include "physics/PhysicsIntegrator.h"
+#include "physics/CollisionDetector.h"
+#include "physics/MicrotubuleRods.h"
+#include "physics/PhysMicrotubule.h"
+#include "physics/ShapeConstraints.h"
+#include "physics/VolumeConstraint.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+// PhysicsIntegrator::step() must not allocate once bodies, generators and mesh topology are set up.
+// Every heap allocation of the process goes through the replaced operator new below; each
+// configuration takes a few warm-up steps and then checks that further steps allocate nothing.
+// With collisions, the contact detection before every step (and the BVH refits it brings along)
+// is checked as well.
+
+namespace
+{
+    std::atomic<uint64_t> g_nAllocations{ 0 };
+
+    void* allocate(std::size_t size)
+    {
+        g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t uAlignment = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+        void* p = _aligned_malloc(size ? size : 1, uAlignment);
+#else
+        void* p = std::aligned_alloc(uAlignment, (size + uAlignment - 1) / uAlignment * uAlignment);
+#endif
+        if (p)
+            return p;
+        throw std::bad_alloc();
+    }
+
+    void freeAligned(void* p)
+    {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+
+namespace
+{
+    struct Configuration
+    {
+        const char* m_pName;
+        PhysicsIntegrator::Scheme m_scheme;
+        bool m_bParallelEdges;      // edge forces by color on all cores instead of serially
+        bool m_bErrorControl;       // step doubling
+        bool m_bRods;               // microtubule rods pushing on the cortex and the centrosome
+        bool m_bCollision;          // a second sphere pressed against the first, contacts detected every step
+    };
+
+    // Steps a perturbed sphere with edge springs and dampers, shape constraints and a volume
+    // constraint; returns the allocations of the steps after the warm-up
+    uint64_t countStepAllocations(const Configuration& config)
+    {
+        const uint32_t WARMUP_STEPS = 5;
+        const uint32_t CHECKED_STEPS = 20;
+        const double DT = 0.01;
+
+        auto pMesh = TriangleMesh::createSphere(10.0, 3);
+        auto pBody = std::make_shared<PhysicsMesh>(pMesh);
+        pBody->setParallelEdgeThreshold(config.m_bParallelEdges ? 1 : 0);
+
+        PhysicsIntegrator integrator;
+        integrator.setScheme(config.m_scheme);
+        integrator.setSubsteps(2);
+        integrator.setConstraintIterations(2);
+        integrator.addBody(pBody);
+        integrator.addForceGenerator(std::make_unique<EdgeSpringForce>(*pBody, 50.0));
+        integrator.addForceGenerator(std::make_unique<EdgeDampingForce>(*pBody, 0.5));
+        integrator.addConstraint(std::make_shared<EdgeLengthConstraintXPBD>(*pBody, 1e-3));
+        integrator.addConstraint(std::make_shared<BendingConstraintXPBD>(*pBody, 1e-2));
+        auto pVolume = std::make_shared<VolumeConstraintXPBD>(*pBody, 0.0, 1e-4);
+        pVolume->setTargetVolume(pVolume->computeSignedVolume());
+        integrator.addConstraint(pVolume);
+        if (config.m_bErrorControl)
+            integrator.setErrorControl(1e-3);
+
+        std::vector<std::shared_ptr<PhysCentrosome>> centrosomes;
+        if (config.m_bRods)
+        {
+            auto pCentrosome = std::make_shared<PhysCentrosome>();
+            pCentrosome->setToNormalizedCell(affine3::identity());
+            pCentrosome->getPhysVertex() = PhysVertex{ double3(0, 0, 0), double3(0, 0, 0), 10.0 };
+            for (uint32_t m = 0; m < 8; ++m)
+            {
+                auto pMT = std::make_shared<PhysMicrotubule>();
+                const float angle = 0.785f * m;
+                const float3 direction(std::cos(angle), std::sin(angle), 0.1f);
+                for (uint32_t i = 0; i <= 12; ++i)
+                    pMT->addVertex(direction * (0.25f * i) + float3(0, 0, (i % 2) ? 0.01f : 0.0f));
+                pCentrosome->getMicrotubules().push_back(pMT);
+            }
+            centrosomes.push_back(pCentrosome);
+            integrator.addCentrosome(pCentrosome);
+            integrator.addForceGenerator(std::make_unique<MicrotubuleRodForce>(*pBody, centrosomes));
+        }
+
+        CollisionDetector detector;
+        if (config.m_bCollision)
+        {
+            // Spheres of radius 10 whose centers are 19.8 apart overlap slightly; an eggshell just
+            // around them keeps them pressed together
+            auto pOtherBody = std::make_shared<PhysicsMesh>(TriangleMesh::createSphere(10.0, 3));
+            integrator.addBody(pOtherBody);
+            integrator.addForceGenerator(std::make_unique<EdgeSpringForce>(*pOtherBody, 50.0));
+            integrator.addForceGenerator(std::make_unique<EdgeDampingForce>(*pOtherBody, 0.5));
+            const float3 offsets[2] = { float3(0, 0, 0), float3(19.8f, 0, 0) };
+            const std::shared_ptr<PhysicsMesh> bodies[2] = { pBody, pOtherBody };
+            for (uint32_t u = 0; u < 2; ++u)
+            {
+                auto pContacts = std::make_shared<ContactConstraintXPBD>(*bodies[u]);
+                integrator.addConstraint(pContacts);
+                detector.addBody(bodies[u], pContacts, offsets[u]);
+            }
+            detector.setEggshell(float3(9.9f, 0, 0), float3(19.95f, 11.0f, 11.0f));
+        }
+        auto step = [&]()
+        {
+            if (config.m_bCollision)
+                detector.detect();
+            integrator.step(DT);
+        };
+
+        std::mt19937 rng(12345);
+        std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+        {
+            Vertices& vertices = *pMesh->getVertices();
+            Vertices::PositionUpdate update(vertices);
+            for (uint32_t i = 0; i < vertices.getVertexCount(); ++i)
+                update.set(i, vertices.getVertexPosition(i) * (1.0f + 0.02f * uni(rng)));
+        }
+
+        for (uint32_t s = 0; s < WARMUP_STEPS; ++s)
+            step();
+        const uint64_t nBefore = g_nAllocations.load();
+        for (uint32_t s = 0; s < CHECKED_STEPS; ++s)
+            step();
+        if (config.m_bCollision && detector.getLastStats().m_nBodyContacts == 0)
+            printf("WARNING: the spheres are not in contact\n");
+        return g_nAllocations.load() - nBefore;
+    }
+}
+
+int main()
+{
+    const PhysicsIntegrator::Scheme SEMI_IMPLICIT = PhysicsIntegrator::Scheme::SEMI_IMPLICIT_EULER;
+    const PhysicsIntegrator::Scheme IMPLICIT = PhysicsIntegrator::Scheme::IMPLICIT_EULER;
+    const Configuration configurations[] =
+    {
+        { "semi-implicit",                          SEMI_IMPLICIT, false, false, false, false },
+        { "implicit",                               IMPLICIT,      false, false, false, false },
+        { "semi-implicit, parallel edges",          SEMI_IMPLICIT, true,  false, false, false },
+        { "implicit, parallel edges",               IMPLICIT,      true,  false, false, false },
+        { "semi-implicit, error control",           SEMI_IMPLICIT, false, true,  false, false },
+        { "implicit, error control",                IMPLICIT,      false, true,  false, false },
+        { "semi-implicit, rods",                    SEMI_IMPLICIT, false, false, true,  false },
+        { "implicit, parallel edges, rods, error control", IMPLICIT, true, true, true, false },
+        { "semi-implicit, collision",               SEMI_IMPLICIT, false, false, false, true  },
+        { "implicit, collision",                    IMPLICIT,      false, false, false, true  },
+    };
+
+    bool bPassed = true;
+    for (const Configuration& config : configurations)
+    {
+        const uint64_t nAllocations = countStepAllocations(config);
+        printf("%-48s %llu allocations\n", config.m_pName, static_cast<unsigned long long>(nAllocations));
+        bPassed = bPassed && nAllocations == 0;
+    }
+
+    if (!bPassed)
+    {
+        printf("FAILED: PhysicsIntegrator::step() or CollisionDetector::detect() allocated after the warm-up\n");
+        return 1;
+    }
+    printf("No allocations in steady-state steps\n");
+    return 0;
+}
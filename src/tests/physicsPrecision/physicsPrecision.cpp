@@ -0,0 +1,209 @@
+#include "physics/PhysicsIntegrator.h"
+#include "geometry/mesh/TriangleMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Trajectory regression for the precision policy (PhysicsPrecision.h), which is chosen for the
+// whole build: a perturbed sphere of edge springs and dampers is stepped under the policy of this
+// build and sampled vertices are compared with their positions under DoublePrecision. Mixed and
+// float must stay within 5e-6 of double with semi-implicit steps and within 1e-5 with implicit
+// ones. After changing the scenario, run a double build with --print-reference and paste its output
+// into REFERENCE_POSITIONS.
+
+namespace
+{
+    const uint32_t SPHERE_SUBDIVISION_LEVEL = 3;
+    const uint32_t STEP_COUNT = 100;
+    const double DT = 0.01;
+    const uint32_t SAMPLE_STRIDE = 16;      // every 16th vertex is compared
+
+    struct SchemeCase
+    {
+        const char* m_pName;
+        PhysicsIntegrator::Scheme m_scheme;
+        double m_fTolerance;
+    };
+    const SchemeCase SCHEME_CASES[] =
+    {
+        { "semi-implicit", PhysicsIntegrator::Scheme::SEMI_IMPLICIT_EULER, 5e-6 },
+        { "implicit",      PhysicsIntegrator::Scheme::IMPLICIT_EULER,      1e-5 },
+    };
+
+    // Positions of vertices 0, SAMPLE_STRIDE, 2 * SAMPLE_STRIDE, ... after STEP_COUNT steps under
+    // DoublePrecision, per scheme in SCHEME_CASES order
+    const float REFERENCE_POSITIONS[][3] =
+    {
+        // semi-implicit
+        { 0.00459295232f, 5.19184017f, 8.39546585f },
+        { -3.11097074f, 8.1162672f, 5.00876331f },
+        { -0.00684102764f, -9.9425745f, -0.00143274316f },
+        { 5.8648181f, 6.86901188f, 4.24111128f },
+        { -7.0646348f, 1.62530625f, 6.96772861f },
+        { -4.32850647f, 8.57877731f, -2.57500768f },
+        { 2.6134522f, -4.36623669f, -8.66846848f },
+        { 1.60054338f, -6.88260126f, 6.98085642f },
+        { -6.96714735f, -7.0443387f, 1.60859799f },
+        { 5.86690998f, -6.87741852f, -4.24315786f },
+        { -9.56334972f, -2.63113737f, 1.62481022f },
+        { 7.66911077f, 2.06729221f, 5.5431242f },
+        { -0.0022179503f, 6.96328163f, 7.03706121f },
+        { -3.7457509f, 8.41712761f, 3.82190704f },
+        { -3.84639072f, 3.75130725f, 8.44188499f },
+        { -7.82163525f, 0.819705725f, 6.13142395f },
+        { -6.01411057f, -2.34954667f, 7.53317499f },
+        { 1.33130383f, 2.20388174f, 9.71477413f },
+        { 7.69252729f, -0.79338181f, 6.05584335f },
+        { -4.84495068f, 8.62344742f, -1.29294145f },
+        { 3.68526411f, 7.04772282f, -5.9866724f },
+        { 8.45449638f, 3.8477478f, -3.75232506f },
+        { 5.16881132f, 1.55783403f, -8.37214375f },
+        { 4.00789452f, -0.823512375f, -9.14204693f },
+        { -5.21235609f, 1.57699263f, -8.42612648f },
+        { -3.75136161f, 7.1054287f, -6.04189777f },
+        { -6.48374081f, 5.63278866f, -5.11401653f },
+        { -3.59774184f, -9.28558064f, 1.32193744f },
+        { 2.13891888f, -5.70646286f, 7.93546057f },
+        { 7.85681295f, -3.46895146f, 5.17118168f },
+        { -8.44219971f, -3.82761621f, 3.74587107f },
+        { 1.5807904f, -8.38990784f, -5.19012547f },
+        { -2.18380094f, -9.55321884f, -1.31242108f },
+        { -7.57073927f, -6.04864979f, -2.36433268f },
+        { 3.7473731f, -7.10488749f, -6.05471516f },
+        { 6.45194912f, -5.63881588f, -5.12957668f },
+        { 9.89254189f, 1.33824754f, -0.815110564f },
+        { -9.28854656f, 1.33751202f, -3.59016585f },
+        { 7.75124311f, -6.17229605f, -0.799712002f },
+        { -6.97179365f, -7.05148363f, 0.00237379968f },
+        { -9.67791176f, -2.66465545f, -0.00670825131f },
+        // implicit
+        { 0.00426987978f, 5.19099903f, 8.39236069f },
+        { -3.10772991f, 8.11335659f, 5.00715685f },
+        { -0.00371409627f, -9.94764519f, -0.000411798537f },
+        { 5.8642149f, 6.8664999f, 4.24107647f },
+        { -7.06148672f, 1.62410903f, 6.9653101f },
+        { -4.32939768f, 8.58244705f, -2.57836032f },
+        { 2.61047363f, -4.3653779f, -8.67103672f },
+        { 1.59907496f, -6.88753605f, 6.98221111f },
+        { -6.96575737f, -7.04416704f, 1.60957348f },
+        { 5.8619957f, -6.87199879f, -4.24267006f },
+        { -9.56276417f, -2.63258934f, 1.62570274f },
+        { 7.6845417f, 2.06910944f, 5.55218172f },
+        { -0.00220758142f, 6.96165848f, 7.03666449f },
+        { -3.74678516f, 8.41910172f, 3.82519078f },
+        { -3.84709096f, 3.75158286f, 8.44380093f },
+        { -7.82413197f, 0.820179701f, 6.13401365f },
+        { -6.01200724f, -2.34609675f, 7.52882099f },
+        { 1.33080828f, 2.20395875f, 9.70596027f },
+        { 7.68956995f, -0.79079932f, 6.0537014f },
+        { -4.84300375f, 8.62636948f, -1.29803014f },
+        { 3.68783832f, 7.04952574f, -5.99014616f },
+        { 8.45408535f, 3.84750509f, -3.75457549f },
+        { 5.16672039f, 1.55688429f, -8.36767197f },
+        { 4.00551319f, -0.824138701f, -9.14386559f },
+        { -5.20841122f, 1.57637775f, -8.41963387f },
+        { -3.74814582f, 7.10514975f, -6.0403657f },
+        { -6.48074055f, 5.63659048f, -5.11662912f },
+        { -3.59792709f, -9.28446293f, 1.32217491f },
+        { 2.13746905f, -5.7068491f, 7.93401623f },
+        { 7.85514402f, -3.47035289f, 5.17308235f },
+        { -8.44447231f, -3.82933855f, 3.74689293f },
+        { 1.57764232f, -8.38969803f, -5.18892241f },
+        { -2.18279147f, -9.55095196f, -1.31025946f },
+        { -7.56974125f, -6.04877663f, -2.36367631f },
+        { 3.74360061f, -7.10252523f, -6.05118656f },
+        { 6.45406675f, -5.63975096f, -5.12859631f },
+        { 9.88781929f, 1.33594131f, -0.814498484f },
+        { -9.28624821f, 1.33485007f, -3.59235668f },
+        { 7.75598478f, -6.1724596f, -0.799895525f },
+        { -6.97487068f, -7.05621815f, 0.00271027721f },
+        { -9.67267799f, -2.66393757f, -0.00559358764f },
+    };
+
+    const char* getPolicyName()
+    {
+        if (std::is_same_v<PhysicsPrecision, FloatPrecision>) return "float";
+        if (std::is_same_v<PhysicsPrecision, MixedPrecision>) return "mixed";
+        return "double";
+    }
+
+    std::vector<float3> runScenario(PhysicsIntegrator::Scheme scheme)
+    {
+        auto pMesh = TriangleMesh::createSphere(10.0, SPHERE_SUBDIVISION_LEVEL);
+        auto pBody = std::make_shared<PhysicsMesh>(pMesh);
+        PhysicsIntegrator integrator;
+        integrator.setScheme(scheme);
+        integrator.addBody(pBody);
+        integrator.addForceGenerator(std::make_unique<EdgeSpringForce>(*pBody, 100.0));
+        integrator.addForceGenerator(std::make_unique<EdgeDampingForce>(*pBody, 1.0));
+
+        // Radial perturbation of up to 2% from an integer hash, the same with every standard library
+        {
+            Vertices& vertices = *pMesh->getVertices();
+            Vertices::PositionUpdate update(vertices);
+            for (uint32_t i = 0; i < vertices.getVertexCount(); ++i)
+            {
+                uint32_t uHash = i * 2654435761u;
+                uHash ^= uHash >> 16;
+                const float fRandom = float(uHash % 2001) / 1000.0f - 1.0f;
+                update.set(i, vertices.getVertexPosition(i) * (1.0f + 0.02f * fRandom));
+            }
+        }
+
+        for (uint32_t s = 0; s < STEP_COUNT; ++s)
+            integrator.step(DT);
+
+        const Vertices& vertices = *pMesh->getVertices();
+        std::vector<float3> samples;
+        for (uint32_t i = 0; i < vertices.getVertexCount(); i += SAMPLE_STRIDE)
+            samples.push_back(vertices.getVertexPosition(i));
+        return samples;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::strcmp(argv[1], "--print-reference") == 0)
+    {
+        for (const SchemeCase& schemeCase : SCHEME_CASES)
+        {
+            printf("        // %s\n", schemeCase.m_pName);
+            for (const float3& p : runScenario(schemeCase.m_scheme))
+                printf("        { %.9gf, %.9gf, %.9gf },\n", p.x, p.y, p.z);
+        }
+        return 0;
+    }
+
+    bool bPassed = true;
+    uint32_t uReference = 0;
+    const uint32_t nReferences = sizeof(REFERENCE_POSITIONS) / sizeof(REFERENCE_POSITIONS[0]);
+    for (const SchemeCase& schemeCase : SCHEME_CASES)
+    {
+        const std::vector<float3> samples = runScenario(schemeCase.m_scheme);
+        if (uReference + samples.size() > nReferences)
+        {
+            printf("FAILED: the reference has fewer samples than the scenario; regenerate it\n");
+            return 1;
+        }
+        double fMaxDeviation = 0.0;
+        for (const float3& p : samples)
+        {
+            const float* pRef = REFERENCE_POSITIONS[uReference++];
+            const double3 d = double3(p) - double3(pRef[0], pRef[1], pRef[2]);
+            fMaxDeviation = std::max(fMaxDeviation, std::sqrt(dot(d, d)));
+        }
+        const bool bWithin = fMaxDeviation <= schemeCase.m_fTolerance;
+        printf("%s precision, %s: largest deviation from double %.3g (tolerance %.0e) %s\n", getPolicyName(),
+               schemeCase.m_pName, fMaxDeviation, schemeCase.m_fTolerance, bWithin ? "PASS" : "FAIL");
+        bPassed = bPassed && bWithin;
+    }
+    if (uReference != nReferences)
+    {
+        printf("FAILED: the reference has more samples than the scenario; regenerate it\n");
+        return 1;
+    }
+    return bPassed ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#include "geometry/mesh/Vertices.h"
+#include <cmath>
+#include <cstdio>
+
+// Vertices::PositionChange::m_fMaxDisplacement bounds how far vertices moved in one write, and
+// consumers such as SignedDistanceField accumulate it to decide when their data is stale. A vertex
+// written several times in one PositionUpdate must report its distance from where it was before
+// the scope, not its largest single write.
+
+namespace
+{
+    bool check(const char* pName, float fActual, float fExpected)
+    {
+        const bool bPassed = std::abs(fActual - fExpected) <= 1e-6f;
+        printf("%-52s %g (expected %g) %s\n", pName, fActual, fExpected, bPassed ? "PASS" : "FAIL");
+        return bPassed;
+    }
+}
+
+int main()
+{
+    Vertices vertices;
+    vertices.addVertex(float3(0, 0, 0));
+    vertices.addVertex(float3(5, 0, 0));
+
+    bool bPassed = true;
+    {
+        // Two writes of 1 in the same direction: the vertex moved 2
+        Vertices::PositionUpdate update(vertices);
+        update.set(0, float3(1, 0, 0));
+        update.set(0, float3(2, 0, 0));
+    }
+    bPassed &= check("same vertex written twice", vertices.getLastPositionChange().m_fMaxDisplacement, 2.0f);
+
+    {
+        // The next scope measures from where the previous one left the vertex
+        Vertices::PositionUpdate update(vertices);
+        update.set(0, float3(2, 1, 0));
+        update.set(1, float3(5, 0, 0.5f));
+    }
+    bPassed &= check("next scope starts from the committed positions", vertices.getLastPositionChange().m_fMaxDisplacement, 1.0f);
+
+    {
+        // Out and back: the bound covers the farthest point reached
+        Vertices::PositionUpdate update(vertices);
+        update.set(1, float3(5, 0, 3.5f));
+        update.set(1, float3(5, 0, 0.5f));
+    }
+    bPassed &= check("vertex moved out and back", vertices.getLastPositionChange().m_fMaxDisplacement, 3.0f);
+
+    vertices.setVertexPosition(0, float3(2, 1, 4));
+    bPassed &= check("single setVertexPosition()", vertices.getLastPositionChange().m_fMaxDisplacement, 4.0f);
+
+    return bPassed ? 0 : 1;
+}
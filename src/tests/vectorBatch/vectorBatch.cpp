@@ -0,0 +1,167 @@
+#include "geometry/vectors/vectorBatch.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// BatchPrecision::STRICT kernels must give the same bits as the scalar functions they batch,
+// signed zeros included. Inputs mix signed zeros and ones with general values so that products and
+// sums of zeros of either sign occur in every lane position and in the scalar tail.
+
+namespace
+{
+    template <typename T>
+    struct Points
+    {
+        std::vector<T> m_x, m_y, m_z;
+
+        explicit Points(size_t n) : m_x(n), m_y(n), m_z(n) {}
+        vector<T, 3> get(size_t i) const { return vector<T, 3>(m_x[i], m_y[i], m_z[i]); }
+    };
+
+    template <typename T>
+    T randomValue(std::mt19937& rng)
+    {
+        static const T special[] = { T(0), T(-0.0), T(1), T(-1) };
+        const uint32_t u = rng() % 8;
+        if (u < 4)
+            return special[u];
+        return std::uniform_real_distribution<T>(T(-10), T(10))(rng);
+    }
+
+    template <typename T>
+    Points<T> randomPoints(std::mt19937& rng, size_t n)
+    {
+        Points<T> points(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            points.m_x[i] = randomValue<T>(rng);
+            points.m_y[i] = randomValue<T>(rng);
+            points.m_z[i] = randomValue<T>(rng);
+        }
+        return points;
+    }
+
+    // Counts the elements whose bits differ; NaN matches NaN of any payload
+    template <typename T>
+    uint32_t countMismatches(const char* pName, const T* pBatch, const T* pScalar, size_t n)
+    {
+        uint32_t nMismatches = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (std::isnan(pBatch[i]) && std::isnan(pScalar[i]))
+                continue;
+            if (std::memcmp(&pBatch[i], &pScalar[i], sizeof(T)) != 0)
+            {
+                if (nMismatches == 0)
+                    printf("%s<%s>: element %zu is %.17g, scalar %.17g\n", pName, sizeof(T) == 4 ? "float" : "double",
+                           i, double(pBatch[i]), double(pScalar[i]));
+                ++nMismatches;
+            }
+        }
+        return nMismatches;
+    }
+
+    template <typename T>
+    uint32_t countMismatches(const char* pName, const Points<T>& batch, const Points<T>& scalar)
+    {
+        const size_t n = batch.m_x.size();
+        return countMismatches(pName, batch.m_x.data(), scalar.m_x.data(), n)
+             + countMismatches(pName, batch.m_y.data(), scalar.m_y.data(), n)
+             + countMismatches(pName, batch.m_z.data(), scalar.m_z.data(), n);
+    }
+
+    template <typename T>
+    uint32_t testStrictKernels(std::mt19937& rng, size_t n)
+    {
+        uint32_t nMismatches = 0;
+        const Points<T> a = randomPoints<T>(rng, n), b = randomPoints<T>(rng, n);
+        Points<T> batch(n), scalar(n);
+        std::vector<T> batchW(n), scalarW(n);
+
+        affine<T, 3> xf = affine<T, 3>::identity();
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                xf.m_linear[r][c] = randomValue<T>(rng);
+        xf.m_translation = vector<T, 3>(randomValue<T>(rng), randomValue<T>(rng), randomValue<T>(rng));
+
+        batchTransformPoints(xf, a.m_x.data(), a.m_y.data(), a.m_z.data(), batch.m_x.data(), batch.m_y.data(), batch.m_z.data(), n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const vector<T, 3> r = xf.transformPoint(a.get(i));
+            scalar.m_x[i] = r.x; scalar.m_y[i] = r.y; scalar.m_z[i] = r.z;
+        }
+        nMismatches += countMismatches("batchTransformPoints", batch, scalar);
+
+        batchTransformVectors(xf, a.m_x.data(), a.m_y.data(), a.m_z.data(), batch.m_x.data(), batch.m_y.data(), batch.m_z.data(), n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const vector<T, 3> r = xf.transformVector(a.get(i));
+            scalar.m_x[i] = r.x; scalar.m_y[i] = r.y; scalar.m_z[i] = r.z;
+        }
+        nMismatches += countMismatches("batchTransformVectors", batch, scalar);
+
+        matrix<T, 4, 4> m;
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                m[r][c] = randomValue<T>(rng);
+        batchTransformPoints(m, a.m_x.data(), a.m_y.data(), a.m_z.data(), batch.m_x.data(), batch.m_y.data(), batch.m_z.data(), batchW.data(), n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const vector<T, 4> r = vector<T, 4>(a.m_x[i], a.m_y[i], a.m_z[i], T(1)) * m;
+            scalar.m_x[i] = r.x; scalar.m_y[i] = r.y; scalar.m_z[i] = r.z; scalarW[i] = r.w;
+        }
+        nMismatches += countMismatches("batchTransformPoints (4x4)", batch, scalar);
+        nMismatches += countMismatches("batchTransformPoints (4x4)", batchW.data(), scalarW.data(), n);
+
+        batchDot(a.m_x.data(), a.m_y.data(), a.m_z.data(), b.m_x.data(), b.m_y.data(), b.m_z.data(), batchW.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            scalarW[i] = dot(a.get(i), b.get(i));
+        nMismatches += countMismatches("batchDot", batchW.data(), scalarW.data(), n);
+
+        batchCross(a.m_x.data(), a.m_y.data(), a.m_z.data(), b.m_x.data(), b.m_y.data(), b.m_z.data(), batch.m_x.data(), batch.m_y.data(), batch.m_z.data(), n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const vector<T, 3> r = cross(a.get(i), b.get(i));
+            scalar.m_x[i] = r.x; scalar.m_y[i] = r.y; scalar.m_z[i] = r.z;
+        }
+        nMismatches += countMismatches("batchCross", batch, scalar);
+
+        batchLength(a.m_x.data(), a.m_y.data(), a.m_z.data(), batchW.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            scalarW[i] = length(a.get(i));
+        nMismatches += countMismatches("batchLength", batchW.data(), scalarW.data(), n);
+
+        batch = a;
+        batchNormalize<BatchPrecision::STRICT>(batch.m_x.data(), batch.m_y.data(), batch.m_z.data(), n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const vector<T, 3> r = normalize(a.get(i));
+            scalar.m_x[i] = r.x; scalar.m_y[i] = r.y; scalar.m_z[i] = r.z;
+        }
+        nMismatches += countMismatches("batchNormalize", batch, scalar);
+
+        return nMismatches;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(12345);
+    uint32_t nMismatches = 0;
+    // Lengths with every tail size after the 4-wide steps
+    for (size_t n : { size_t(1), size_t(3), size_t(4), size_t(7), size_t(4096), size_t(4099) })
+    {
+        nMismatches += testStrictKernels<float>(rng, n);
+        nMismatches += testStrictKernels<double>(rng, n);
+    }
+
+    if (nMismatches != 0)
+    {
+        printf("FAILED: %u elements differ from the scalar functions\n", nMismatches);
+        return 1;
+    }
+    printf("All strict batch kernels match the scalar functions bit for bit\n");
+    return 0;
+}